@@ -0,0 +1,165 @@
+#include <bit>
+#include "CommandCache.hpp"
+#include "CommandsListener.hpp"
+
+namespace {
+
+// Les réels sont hachés et comparés par leur représentation : NaN == NaN, 0.0 != -0.0
+size_t valueHash(const VariantType& value) noexcept {
+	if (const float* real = std::get_if<float>(&value)) {
+		return std::hash<uint32_t>{}(std::bit_cast<uint32_t>(*real));
+	}
+	if (const double* real = std::get_if<double>(&value)) {
+		return std::hash<uint64_t>{}(std::bit_cast<uint64_t>(*real));
+	}
+	return std::hash<VariantType>{}(value);
+}
+
+bool sameValue(const VariantType& a, const VariantType& b) noexcept {
+	if (a.index() != b.index()) {
+		return false;
+	}
+	if (const float* real = std::get_if<float>(&a)) {
+		return std::bit_cast<uint32_t>(*real) == std::bit_cast<uint32_t>(std::get<float>(b));
+	}
+	if (const double* real = std::get_if<double>(&a)) {
+		return std::bit_cast<uint64_t>(*real) == std::bit_cast<uint64_t>(std::get<double>(b));
+	}
+	return a == b;
+}
+
+size_t valueBytes(const VariantType& value) {
+	const std::string* str = std::get_if<std::string>(&value);
+	return sizeof(VariantType) + (str ? str->capacity() : 0);
+}
+
+} // namespace
+
+size_t CommandCache::hash(const CommandInfo* command, const CommandArgs& args) noexcept {
+	size_t seed = std::hash<const CommandInfo*>{}(command);
+	for (size_t i = 0; i < args.size(); ++i) {
+		seed ^= valueHash(args[i]) + 0x9e3779b97f4a7c15ULL + (seed << 6) + (seed >> 2);
+	}
+	return seed;
+}
+
+CommandCache::Lru::iterator CommandCache::lookup(const CommandInfo* command, const CommandArgs& args, size_t hash) {
+	auto [first, last] = _index.equal_range(hash);
+	for (auto it = first; it != last; ++it) {
+		const Entry& entry = *it->second;
+		if (entry.command != command || entry.args.size() != args.size()) {
+			continue;
+		}
+		bool equal = true;
+		for (size_t i = 0; i < args.size() && equal; ++i) {
+			equal = sameValue(entry.args[i], args[i]);
+		}
+		if (equal) {
+			return it->second;
+		}
+	}
+	return _entries.end();
+}
+
+bool CommandCache::checkVersion(uint64_t version) {
+	if (version == _version) {
+		return true;
+	}
+	if (version < _version) {
+		return false;	// Calculé avant la dernière modification de variable
+	}
+	_stats.invalidations += _entries.size();
+	_entries.clear();
+	_index.clear();
+	_bytes = 0;
+	_version = version;
+	return true;
+}
+
+bool CommandCache::find(const CommandInfo* command, const CommandArgs& args, uint64_t version, std::vector<VariantType>& results) {
+	size_t key = hash(command, args);
+	std::lock_guard<std::mutex> lock(_mutex);
+	if (checkVersion(version)) {
+		auto entry = lookup(command, args, key);
+		if (entry != _entries.end()) {
+			_entries.splice(_entries.begin(), _entries, entry);
+			results.assign(entry->results.begin(), entry->results.end());
+			_stats.hits++;
+			return true;
+		}
+	}
+	_stats.misses++;
+	return false;
+}
+
+void CommandCache::insert(const CommandInfo* command, const CommandArgs& args, uint64_t version, const std::vector<VariantType>& results) {
+	size_t key = hash(command, args);
+	Entry entry{ command, key, sizeof(Entry) + 4 * sizeof(void*), args.toVector(), results };
+	for (const VariantType& value : entry.args) {
+		entry.bytes += valueBytes(value);
+	}
+	for (const VariantType& value : entry.results) {
+		entry.bytes += valueBytes(value);
+	}
+
+	std::lock_guard<std::mutex> lock(_mutex);
+	if (entry.bytes > _capacity || !checkVersion(version) || lookup(command, args, key) != _entries.end()) {
+		return;
+	}
+	evict(_capacity - entry.bytes);
+	_bytes += entry.bytes;
+	_entries.push_front(std::move(entry));
+	_index.emplace(key, _entries.begin());
+}
+
+void CommandCache::eraseEntry(Lru::iterator entry) {
+	auto [first, last] = _index.equal_range(entry->hash);
+	for (auto it = first; it != last; ++it) {
+		if (it->second == entry) {
+			_index.erase(it);
+			break;
+		}
+	}
+	_bytes -= entry->bytes;
+	_entries.erase(entry);
+}
+
+void CommandCache::evict(size_t capacity) {
+	while (_bytes > capacity && !_entries.empty()) {
+		eraseEntry(std::prev(_entries.end()));
+		_stats.evictions++;
+	}
+}
+
+void CommandCache::erase(const CommandInfo* command) {
+	std::lock_guard<std::mutex> lock(_mutex);
+	for (auto it = _entries.begin(); it != _entries.end(); ) {
+		auto next = std::next(it);
+		if (it->command == command) {
+			eraseEntry(it);
+		}
+		it = next;
+	}
+}
+
+void CommandCache::clear() {
+	std::lock_guard<std::mutex> lock(_mutex);
+	_entries.clear();
+	_index.clear();
+	_bytes = 0;
+}
+
+void CommandCache::setCapacity(size_t capacity) {
+	std::lock_guard<std::mutex> lock(_mutex);
+	_capacity = capacity;
+	evict(capacity);
+}
+
+CommandCacheStats CommandCache::getStats() const {
+	std::lock_guard<std::mutex> lock(_mutex);
+	CommandCacheStats stats = _stats;
+	stats.entries = _entries.size();
+	stats.bytes = _bytes;
+	stats.capacity = _capacity;
+	return stats;
+}
@@ -0,0 +1,123 @@
+/**
+ * @file CommandCache.hpp
+ * @author ClemtoClem
+ * @date 17/10/2026
+ */
+
+#ifndef COMMAND_CACHE_HPP
+#define COMMAND_CACHE_HPP
+
+#include <atomic>
+#include <cstdint>
+#include <list>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+#include "VariantType.hpp"
+
+struct CommandInfo;
+class CommandArgs;
+
+/**
+ * @brief Compteurs du cache des commandes pures
+ */
+struct CommandCacheStats {
+	uint64_t hits = 0;			///< Résultats trouvés dans le cache
+	uint64_t misses = 0;		///< Résultats absents, la commande a été exécutée
+	uint64_t evictions = 0;		///< Entrées retirées pour respecter la taille maximale
+	uint64_t invalidations = 0;	///< Entrées retirées parce qu'une variable du plugin a changé
+	size_t entries = 0;			///< Nombre d'entrées
+	size_t bytes = 0;			///< Mémoire estimée des entrées
+	size_t capacity = 0;		///< Mémoire maximale
+};
+
+/**
+ * @brief Cache LRU des résultats des commandes pures d'un CommandsListener
+ * Une entrée est identifiée par la commande et ses arguments complets (valeurs par défaut comprises).
+ * Les réels sont comparés bit à bit : un appel avec NaN retrouve son entrée, 0.0 et -0.0 sont deux entrées.
+ * Chaque entrée est associée à la version des variables du plugin au moment du calcul : dès qu'une version
+ * plus récente est vue, tout le cache est vidé, quelle que soit la variable modifiée. Les commandes ne
+ * déclarent pas les variables qu'elles lisent : un plugin dont les variables changent souvent doit limiter
+ * les commandes pures à celles qui n'en lisent aucune, ou désactiver le cache. Un résultat calculé pendant
+ * une modification de variable (version devenue ancienne) n'est pas conservé.
+ */
+class CommandCache {
+public:
+	static constexpr size_t DEFAULT_CAPACITY = 1 << 20;
+
+	/**
+	 * @brief Constructeur de CommandCache
+	 * @param[in] capacity Mémoire maximale des entrées, en octets
+	 */
+	explicit CommandCache(size_t capacity = DEFAULT_CAPACITY) : _capacity(capacity) {}
+
+	/**
+	 * @brief Savoir si le cache peut conserver des résultats (capacité non nulle), sans prendre le verrou
+	 */
+	bool enabled() const noexcept { return _capacity.load(std::memory_order_relaxed) != 0; }
+
+	/**
+	 * @brief Chercher le résultat d'un appel
+	 * @param[in] command Commande appelée
+	 * @param[in] args Arguments complets
+	 * @param[in] version Version actuelle des variables du plugin
+	 * @param[out] results Valeurs retournées, si elles sont dans le cache
+	 * @return true si le résultat était dans le cache
+	 */
+	bool find(const CommandInfo* command, const CommandArgs& args, uint64_t version, std::vector<VariantType>& results);
+
+	/**
+	 * @brief Conserver le résultat d'un appel
+	 * @param[in] command Commande appelée
+	 * @param[in] args Arguments complets
+	 * @param[in] version Version des variables lue avant l'exécution de la commande
+	 * @param[in] results Valeurs retournées
+	 */
+	void insert(const CommandInfo* command, const CommandArgs& args, uint64_t version, const std::vector<VariantType>& results);
+
+	/**
+	 * @brief Retirer les entrées d'une commande (supprimée)
+	 * @param[in] command Commande
+	 */
+	void erase(const CommandInfo* command);
+
+	/**
+	 * @brief Vider le cache
+	 */
+	void clear();
+
+	/**
+	 * @brief Modifier la mémoire maximale des entrées, en retirant les plus anciennes si besoin
+	 * @param[in] capacity Mémoire maximale, en octets (0 désactive le cache)
+	 */
+	void setCapacity(size_t capacity);
+
+	CommandCacheStats getStats() const;
+
+private:
+	struct Entry {
+		const CommandInfo* command;
+		size_t hash;
+		size_t bytes;
+		std::vector<VariantType> args;
+		std::vector<VariantType> results;
+	};
+
+	using Lru = std::list<Entry>;	///< Entrée la plus récente en tête
+
+	mutable std::mutex _mutex;
+	Lru _entries;
+	std::unordered_multimap<size_t, Lru::iterator> _index;	///< Hachage -> entrées (collisions comparées)
+	uint64_t _version = 0;
+	size_t _bytes = 0;
+	std::atomic<size_t> _capacity;	///< Modifié sous _mutex, lu sans verrou par enabled()
+	CommandCacheStats _stats;
+
+	static size_t hash(const CommandInfo* command, const CommandArgs& args) noexcept;
+	Lru::iterator lookup(const CommandInfo* command, const CommandArgs& args, size_t hash);
+	bool checkVersion(uint64_t version);
+	void eraseEntry(Lru::iterator entry);
+	void evict(size_t capacity);
+};
+
+#endif // COMMAND_CACHE_HPP
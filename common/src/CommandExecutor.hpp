@@ -0,0 +1,87 @@
+/**
+ * @file CommandExecutor.hpp
+ * @author ClemtoClem
+ * @date 17/10/2026
+ */
+
+#ifndef COMMAND_EXECUTOR_HPP
+#define COMMAND_EXECUTOR_HPP
+
+#include <atomic>
+#include <functional>
+#include <future>
+#include <memory>
+#include <optional>
+#include <stdexcept>
+#include <vector>
+
+/**
+ * @brief Exécuteur de tâches fourni par le programme principal
+ * Les plugins n'en créent pas : ils utilisent celui que le programme principal leur passe,
+ * pour que toutes les commandes asynchrones se partagent les mêmes threads.
+ */
+class CommandExecutor {
+public:
+	using Task = std::function<void()>;
+
+	virtual ~CommandExecutor() = default;
+
+	/**
+	 * @brief Ajouter une tâche, en attendant qu'une place se libère si les files sont pleines
+	 * @param[in] task Tâche à exécuter
+	 */
+	virtual void submit(Task task) = 0;
+
+	/**
+	 * @brief Ajouter plusieurs tâches en une seule mise en file
+	 * @param[in] tasks Tâches à exécuter
+	 */
+	virtual void submitBatch(std::vector<Task> tasks) = 0;
+};
+
+class CommandCancelledException : public std::runtime_error {
+public:
+	CommandCancelledException(const std::string& command)
+		: std::runtime_error("Command cancelled: " + command) {}
+};
+
+/**
+ * @brief Jeton d'annulation partagé entre l'appelant et les commandes asynchrones
+ * L'annulation est vérifiée juste avant l'exécution : une commande déjà commencée va jusqu'au bout,
+ * une commande encore en file se termine par une CommandCancelledException.
+ */
+class CancellationToken {
+public:
+	CancellationToken() : _cancelled(std::make_shared<std::atomic<bool>>(false)) {}
+
+	void cancel() noexcept { _cancelled->store(true, std::memory_order_relaxed); }
+	bool isCancelled() const noexcept { return _cancelled->load(std::memory_order_relaxed); }
+
+private:
+	std::shared_ptr<std::atomic<bool>> _cancelled;
+};
+
+/**
+ * @brief Fonction pour créer la tâche d'une commande asynchrone
+ * @param[in] promise Promesse remplie avec le résultat ou l'exception de la commande
+ * @param[in] token Jeton d'annulation, vide si la commande ne peut pas être annulée
+ * @param[in] command Nom de la commande, pour le message d'annulation
+ * @param[in] function Fonction qui exécute la commande
+ * @return Tâche à soumettre à un CommandExecutor
+ */
+template<typename T, typename F>
+CommandExecutor::Task makeCommandTask(std::shared_ptr<std::promise<T>> promise, std::optional<CancellationToken> token, std::string command, F function) {
+	return [promise = std::move(promise), token = std::move(token), command = std::move(command), function = std::move(function)]() mutable {
+		if (token && token->isCancelled()) {
+			promise->set_exception(std::make_exception_ptr(CommandCancelledException(command)));
+			return;
+		}
+		try {
+			promise->set_value(function());
+		} catch (...) {
+			promise->set_exception(std::current_exception());
+		}
+	};
+}
+
+#endif // COMMAND_EXECUTOR_HPP
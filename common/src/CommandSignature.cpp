@@ -0,0 +1,16 @@
+#include "CommandSignature.hpp"
+
+std::string CommandSignature::toString() const {
+	if (!typed) {
+		return "untyped";
+	}
+	std::string result = "(";
+	for (size_t i = 0; i < args.size(); ++i) {
+		result += (i ? ", " : "") + VariantIndexName(args[i]);
+	}
+	result += ") -> (";
+	for (size_t i = 0; i < returns.size(); ++i) {
+		result += (i ? ", " : "") + VariantIndexName(returns[i]);
+	}
+	return result + ")";
+}
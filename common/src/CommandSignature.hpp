@@ -0,0 +1,151 @@
+/**
+ * @file CommandSignature.hpp
+ * @author ClemtoClem
+ * @date 17/10/2026
+ */
+
+#ifndef COMMAND_SIGNATURE_HPP
+#define COMMAND_SIGNATURE_HPP
+
+#include <cstdint>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <tuple>
+#include <type_traits>
+#include <vector>
+#include "VariantType.hpp"
+
+static_assert(std::variant_size_v<VariantType> <= 32, "VariantType alternatives must fit in a 32 bits mask");
+
+/**
+ * @brief Conversions acceptées pour les arguments d'une commande typée
+ */
+enum class ArgumentCoercion {
+	Exact,		///< L'argument doit avoir exactement le type déclaré
+	Numeric		///< Les conversions numériques sans perte sont aussi acceptées (int32_t -> int64_t, int32_t -> double, float -> double...)
+};
+
+/**
+ * @brief Indique si toute valeur de type From est représentable exactement dans le type To
+ * bool, std::string et void* ne sont convertibles qu'en eux-mêmes.
+ */
+template<typename From, typename To>
+constexpr bool isLosslessConversion() {
+	if constexpr (std::is_same_v<From, To>) {
+		return true;
+	} else if constexpr (std::is_same_v<From, bool> || std::is_same_v<To, bool> || !std::is_arithmetic_v<From> || !std::is_arithmetic_v<To>) {
+		return false;
+	} else if constexpr (std::is_integral_v<From> && std::is_integral_v<To>) {
+		if constexpr (std::is_signed_v<From> == std::is_signed_v<To>) {
+			return sizeof(From) <= sizeof(To);
+		} else {
+			return std::is_unsigned_v<From> && sizeof(From) < sizeof(To);
+		}
+	} else if constexpr (std::is_integral_v<From>) {
+		return std::numeric_limits<From>::digits <= std::numeric_limits<To>::digits;
+	} else {
+		return std::is_floating_point_v<To> && sizeof(From) <= sizeof(To);
+	}
+}
+
+template<typename To, typename V = VariantType>
+struct LosslessSources;
+
+template<typename To, typename... Ts>
+struct LosslessSources<To, std::variant<Ts...>> {
+	static constexpr uint32_t value = []() {
+		uint32_t mask = 0;
+		size_t index = 0;
+		((mask |= isLosslessConversion<Ts, To>() ? (uint32_t(1) << index) : 0, ++index), ...);
+		return mask;
+	}();
+};
+
+/**
+ * @brief Table de conversion précalculée : types de VariantType acceptés pour un argument de type To
+ * Un bit par alternative de VariantType, à la position de l'alternative.
+ */
+template<typename To>
+constexpr uint32_t acceptedTypes(ArgumentCoercion coercion) {
+	return coercion == ArgumentCoercion::Numeric ? LosslessSources<To>::value : uint32_t(1) << variantIndex<To>;
+}
+
+/**
+ * @brief Fonction pour lire un argument déjà vérifié par CommandSignature::accepts
+ * Les chaînes et les pointeurs sont renvoyés par référence, les nombres par valeur après conversion éventuelle.
+ * @param[in] value Argument
+ * @return Valeur de l'argument dans le type T
+ */
+template<typename T>
+std::conditional_t<std::is_arithmetic_v<T>, T, const T&> argumentAs(const VariantType& value) {
+	if constexpr (std::is_arithmetic_v<T> && !std::is_same_v<T, bool>) {
+		if (const T* exact = std::get_if<T>(&value)) {
+			return *exact;
+		}
+		return std::visit([](const auto& source) -> T {
+			using From = std::decay_t<decltype(source)>;
+			if constexpr (isLosslessConversion<From, T>()) {
+				return static_cast<T>(source);
+			} else {
+				return T{};	// Jamais atteint : le type a été vérifié avant l'appel
+			}
+		}, value);
+	} else {
+		return *std::get_if<T>(&value);
+	}
+}
+
+/**
+ * @brief Signature déclarée d'une commande, consultable par les outils (getSignature)
+ * Les types sont donnés par leur position dans VariantType.
+ */
+struct CommandSignature {
+	bool typed = false;				///< false pour les commandes déclarées sans types
+	std::vector<size_t> args;		///< Type de chaque argument
+	std::vector<size_t> returns;	///< Type de chaque valeur retournée
+	std::vector<uint32_t> accepted;	///< Types acceptés pour chaque argument, conversions comprises
+
+	/**
+	 * @brief Fonction pour savoir si une valeur peut être passée comme argument
+	 * @param[in] index Position de l'argument
+	 * @param[in] value Valeur de l'argument
+	 * @return true si la valeur a le type de l'argument ou peut y être convertie
+	 */
+	bool accepts(size_t index, const VariantType& value) const noexcept {
+		return (accepted[index] >> value.index()) & 1;
+	}
+
+	/**
+	 * @brief Fonction pour écrire la signature, par exemple "(int32_t, double) -> (double)"
+	 * @return Signature, "untyped" pour une commande déclarée sans types
+	 */
+	std::string toString() const;
+};
+
+class CommandArgumentTypeException : public std::runtime_error {
+public:
+	CommandArgumentTypeException(const std::string& command, size_t index, size_t expected, size_t provided)
+		: std::runtime_error("Invalid type for argument " + std::to_string(index) + " of command: '" + command +
+							 "' Expected: " + VariantIndexName(expected) + ", Provided: " + VariantIndexName(provided)) {}
+};
+
+template<typename T>
+struct CommandReturnTypes {
+	static constexpr bool valid = variantIndex<T> != std::variant_npos;
+	static std::vector<size_t> get() { return { variantIndex<T> }; }
+};
+
+template<>
+struct CommandReturnTypes<void> {
+	static constexpr bool valid = true;
+	static std::vector<size_t> get() { return {}; }
+};
+
+template<typename... Ts>
+struct CommandReturnTypes<std::tuple<Ts...>> {
+	static constexpr bool valid = ((variantIndex<Ts> != std::variant_npos) && ...);
+	static std::vector<size_t> get() { return { variantIndex<Ts>... }; }
+};
+
+#endif // COMMAND_SIGNATURE_HPP
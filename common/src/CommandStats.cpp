@@ -0,0 +1,90 @@
+#include <algorithm>
+#include "CommandStats.hpp"
+
+namespace {
+
+size_t threadShard() noexcept {
+	static std::atomic<size_t> nextShard{0};
+	thread_local size_t shard = nextShard.fetch_add(1, std::memory_order_relaxed) % CommandStats::MAX_SHARDS;
+	return shard;
+}
+
+} // namespace
+
+uint64_t CommandStatsSnapshot::percentile(double quantile) const noexcept {
+	uint64_t count = 0;
+	for (uint64_t value : buckets) {
+		count += value;
+	}
+	if (count == 0) {
+		return 0;
+	}
+	uint64_t rank = static_cast<uint64_t>(quantile * static_cast<double>(count - 1)) + 1;
+	uint64_t seen = 0;
+	for (size_t i = 0; i < buckets.size(); ++i) {
+		seen += buckets[i];
+		if (seen >= rank) {
+			return LatencyHistogram::lowerBound(i);
+		}
+	}
+	return maxNs;
+}
+
+CommandStats::~CommandStats() {
+	for (auto& shard : _shards) {
+		delete shard.load(std::memory_order_relaxed);
+	}
+}
+
+CommandStats::Shard& CommandStats::local() noexcept {
+	std::atomic<Shard*>& slot = _shards[threadShard()];
+	Shard* shard = slot.load(std::memory_order_acquire);
+	if (!shard) {
+		// Premier appel de ce thread : la tranche est créée une fois, un seul thread l'emporte
+		Shard* created = new Shard();
+		if (slot.compare_exchange_strong(shard, created, std::memory_order_acq_rel)) {
+			shard = created;
+		} else {
+			delete created;
+		}
+	}
+	return *shard;
+}
+
+CommandStatsSnapshot CommandStats::snapshot(const std::string& command) const {
+	CommandStatsSnapshot snapshot;
+	snapshot.command = command;
+	snapshot.buckets.assign(LatencyHistogram::BUCKETS, 0);
+	for (const auto& slot : _shards) {
+		const Shard* shard = slot.load(std::memory_order_acquire);
+		if (!shard) {
+			continue;
+		}
+		snapshot.calls += shard->calls.load(std::memory_order_relaxed);
+		snapshot.argumentErrors += shard->argumentErrors.load(std::memory_order_relaxed);
+		snapshot.exceptions += shard->exceptions.load(std::memory_order_relaxed);
+		snapshot.totalNs += shard->totalNs.load(std::memory_order_relaxed);
+		snapshot.maxNs = std::max(snapshot.maxNs, shard->maxNs.load(std::memory_order_relaxed));
+		for (size_t i = 0; i < LatencyHistogram::BUCKETS; ++i) {
+			snapshot.buckets[i] += shard->buckets[i].load(std::memory_order_relaxed);
+		}
+	}
+	return snapshot;
+}
+
+void CommandStats::reset() noexcept {
+	for (auto& slot : _shards) {
+		Shard* shard = slot.load(std::memory_order_acquire);
+		if (!shard) {
+			continue;
+		}
+		shard->calls.store(0, std::memory_order_relaxed);
+		shard->argumentErrors.store(0, std::memory_order_relaxed);
+		shard->exceptions.store(0, std::memory_order_relaxed);
+		shard->totalNs.store(0, std::memory_order_relaxed);
+		shard->maxNs.store(0, std::memory_order_relaxed);
+		for (auto& bucket : shard->buckets) {
+			bucket.store(0, std::memory_order_relaxed);
+		}
+	}
+}
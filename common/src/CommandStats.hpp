@@ -0,0 +1,154 @@
+/**
+ * @file CommandStats.hpp
+ * @author ClemtoClem
+ * @date 17/10/2026
+ */
+
+#ifndef COMMAND_STATS_HPP
+#define COMMAND_STATS_HPP
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/**
+ * Statistiques des commandes : activées par défaut, désactivées en compilant avec -DCOMMAND_STATS=0
+ * (make DEFINES=-DCOMMAND_STATS=0). Le programme principal et les plugins doivent être compilés de la même façon.
+ */
+#ifndef COMMAND_STATS
+#define COMMAND_STATS 1
+#endif
+
+/**
+ * @brief Histogramme de latences à précision relative constante (à la manière de HdrHistogram)
+ * Chaque puissance de 2 est découpée en SUB_BUCKETS intervalles égaux : l'erreur est d'au plus 1/SUB_BUCKETS
+ * quelle que soit la durée. Les durées d'au moins 2^MAX_EXPONENT ns (environ 68,7 s) sont comptées à part, dans
+ * l'intervalle OVERFLOW_BUCKET, le dernier : elles n'entrent dans aucun intervalle borné.
+ */
+struct LatencyHistogram {
+	static constexpr unsigned SUB_BITS = 3;
+	static constexpr uint64_t SUB_BUCKETS = uint64_t(1) << SUB_BITS;
+	static constexpr unsigned MAX_EXPONENT = 36;
+	static constexpr size_t OVERFLOW_BUCKET = (MAX_EXPONENT - SUB_BITS + 1) * SUB_BUCKETS;	///< Durées d'au moins 2^MAX_EXPONENT ns
+	static constexpr size_t BUCKETS = OVERFLOW_BUCKET + 1;
+
+	/**
+	 * @brief Intervalle d'une durée
+	 * @param[in] ns Durée en nanosecondes
+	 * @return Position de l'intervalle
+	 */
+	static constexpr size_t bucket(uint64_t ns) noexcept {
+		if (ns < SUB_BUCKETS) {
+			return ns;
+		}
+		unsigned exponent = 63 - __builtin_clzll(ns);
+		if (exponent >= MAX_EXPONENT) {
+			return OVERFLOW_BUCKET;
+		}
+		unsigned shift = exponent - SUB_BITS;
+		return (exponent - SUB_BITS + 1) * SUB_BUCKETS + ((ns >> shift) & (SUB_BUCKETS - 1));
+	}
+
+	/**
+	 * @brief Plus petite durée d'un intervalle
+	 * @param[in] index Position de l'intervalle
+	 * @return Durée en nanosecondes
+	 */
+	static constexpr uint64_t lowerBound(size_t index) noexcept {
+		if (index < SUB_BUCKETS) {
+			return index;
+		}
+		unsigned shift = index / SUB_BUCKETS - 1;
+		return (SUB_BUCKETS + index % SUB_BUCKETS) << shift;
+	}
+};
+
+/**
+ * @brief Statistiques d'une commande à un instant donné
+ */
+struct CommandStatsSnapshot {
+	std::string command;
+	uint64_t calls = 0;				///< Appels, erreurs comprises
+	uint64_t argumentErrors = 0;	///< Appels refusés : nombre ou types des arguments invalides
+	uint64_t exceptions = 0;		///< Exceptions levées par la fonction de la commande
+	uint64_t totalNs = 0;			///< Durée cumulée des appels
+	uint64_t maxNs = 0;				///< Durée du plus long appel
+	std::vector<uint64_t> buckets;	///< Nombre d'appels par intervalle de LatencyHistogram
+
+	/**
+	 * @brief Durée sous laquelle se trouve une proportion des appels
+	 * @param[in] quantile Proportion, entre 0 et 1 (0.99 pour le 99e centile)
+	 * @return Borne inférieure de l'intervalle qui contient ce quantile, en nanosecondes
+	 */
+	uint64_t percentile(double quantile) const noexcept;
+};
+
+/**
+ * @brief Compteurs d'une commande, répartis par thread
+ * Chaque thread écrit dans sa propre tranche (créée à son premier appel), alignée sur une ligne de cache :
+ * les appels simultanés d'une même commande ne se disputent aucun compteur. Au-delà de MAX_SHARDS threads,
+ * des threads partagent une tranche (les compteurs restent atomiques).
+ */
+class CommandStats {
+public:
+	static constexpr size_t MAX_SHARDS = 16;
+
+	CommandStats() = default;
+	~CommandStats();
+
+	CommandStats(const CommandStats&) = delete;
+	CommandStats& operator=(const CommandStats&) = delete;
+
+	void record(std::chrono::nanoseconds duration) noexcept {
+		Shard& shard = local();
+		uint64_t ns = duration.count() > 0 ? duration.count() : 0;
+		shard.calls.fetch_add(1, std::memory_order_relaxed);
+		shard.totalNs.fetch_add(ns, std::memory_order_relaxed);
+		if (ns > shard.maxNs.load(std::memory_order_relaxed)) {
+			shard.maxNs.store(ns, std::memory_order_relaxed);
+		}
+		shard.buckets[LatencyHistogram::bucket(ns)].fetch_add(1, std::memory_order_relaxed);
+	}
+
+	void recordArgumentError() noexcept {
+		Shard& shard = local();
+		shard.calls.fetch_add(1, std::memory_order_relaxed);
+		shard.argumentErrors.fetch_add(1, std::memory_order_relaxed);
+	}
+
+	void recordException(std::chrono::nanoseconds duration) noexcept {
+		local().exceptions.fetch_add(1, std::memory_order_relaxed);
+		record(duration);
+	}
+
+	/**
+	 * @brief Additionner les tranches
+	 * @param[in] command Nom de la commande
+	 * @return Statistiques
+	 */
+	CommandStatsSnapshot snapshot(const std::string& command) const;
+
+	/**
+	 * @brief Remettre les compteurs à zéro (les appels en cours peuvent encore être comptés)
+	 */
+	void reset() noexcept;
+
+private:
+	struct alignas(64) Shard {
+		std::atomic<uint64_t> calls{0};
+		std::atomic<uint64_t> argumentErrors{0};
+		std::atomic<uint64_t> exceptions{0};
+		std::atomic<uint64_t> totalNs{0};
+		std::atomic<uint64_t> maxNs{0};
+		std::array<std::atomic<uint64_t>, LatencyHistogram::BUCKETS> buckets{};
+	};
+
+	std::array<std::atomic<Shard*>, MAX_SHARDS> _shards{};
+
+	Shard& local() noexcept;
+};
+
+#endif // COMMAND_STATS_HPP
@@ -1,74 +1,201 @@
+#include <algorithm>
 #include "CommandsListener.hpp"
 #include "Logger.hpp"
 
-CommandsListener::CommandsListener() = default;
-CommandsListener::~CommandsListener() = default;
+CommandsListener::CommandsListener() : _registry(new Registry()) {}
+
+CommandsListener::~CommandsListener() {
+	// Les commandes retirées vident leurs entrées du cache en étant détruites : avant _cache
+	_rcu.reclaim();
+	delete _registry.load(std::memory_order_relaxed);
+}
+
+void CommandsListener::beginCommands() {
+	_writeMutex.lock();
+	if (_batchDepth++ == 0) {
+		_draft = std::make_unique<Registry>(*_registry.load(std::memory_order_relaxed));
+		_draftChanged = false;
+	}
+}
+
+void CommandsListener::endCommands() {
+	if (--_batchDepth == 0) {
+		std::unique_ptr<Registry> draft = std::move(_draft);
+		if (_draftChanged) {
+			publish(std::move(draft));
+		}
+	}
+	_writeMutex.unlock();
+}
+
+template<typename F>
+bool CommandsListener::modify(F&& edit) {
+	std::lock_guard<std::recursive_mutex> lock(_writeMutex);
+	if (_draft) {
+		// Dans un lot : publié une seule fois par endCommands
+		bool changed = edit(*_draft);
+		_draftChanged |= changed;
+		return changed;
+	}
+	auto registry = std::make_unique<Registry>(*_registry.load(std::memory_order_relaxed));
+	if (!edit(*registry)) {
+		return false;
+	}
+	publish(std::move(registry));
+	return true;
+}
+
+void CommandsListener::publish(std::unique_ptr<Registry> registry) {
+	const Registry* old = _registry.exchange(registry.release(), std::memory_order_acq_rel);
+	_listVersion.fetch_add(1, std::memory_order_release);
+	// Les lecteurs qui ont encore l'ancien instantané (ou qui exécutent une commande supprimée) peuvent
+	// s'y trouver encore : ils sont détruits après une période de grâce commune à tout un lot de retraits
+	_rcu.retire(old);
+	for (CommandInfo* removed : _removed) {
+		_rcu.retire(removed, [](void* pointer) {
+			CommandInfo* command = static_cast<CommandInfo*>(pointer);
+			// Après la période de grâce, plus aucun appel ne peut ajouter d'entrée pour cette commande
+			if (command->owner->_cache) {
+				command->owner->_cache->erase(command);
+			}
+			delete command;
+		});
+	}
+	_removed.clear();
+}
+
+std::vector<VariantType> CommandArgs::toVector() const {
+	std::vector<VariantType> args;
+	args.reserve(size());
+	args.insert(args.end(), _args.begin(), _args.end());
+	args.insert(args.end(), _defaults.begin(), _defaults.end());
+	return args;
+}
 
 bool CommandsListener::addCommand(const std::string& command_name, const std::string& description, size_t nb_args, size_t nb_returns,
-	std::function<std::vector<VariantType>(const std::vector<VariantType>&)> function, const std::vector<VariantType>& default_args)
+	std::function<std::vector<VariantType>(const std::vector<VariantType>&)> function, const std::vector<VariantType>& default_args,
+	bool pure)
+{
+	return addCommand(command_name, description, nb_args, nb_returns,
+		[function = std::move(function)](const CommandArgs& args, std::vector<VariantType>& results) {
+			results = function(args.toVector());
+		}, default_args, pure);
+}
+
+bool CommandsListener::addCommand(const std::string& command_name, const std::string& description, size_t nb_args, size_t nb_returns,
+	CommandFunction function, const std::vector<VariantType>& default_args, bool pure)
+{
+	return registerCommand(command_name, description, nb_args, nb_returns, std::move(function), default_args, CommandSignature{}, pure);
+}
+
+bool CommandsListener::registerCommand(const std::string& command_name, const std::string& description, size_t nb_args, size_t nb_returns,
+	CommandFunction function, const std::vector<VariantType>& default_args, CommandSignature signature, bool pure)
 {
 	if (default_args.size() > nb_args) {
 		LOG(Error) << "Too many default arguments provided";
 		return false;
-	}	
-	_commands.push_back({command_name, "", description, nb_args, nb_returns, default_args, function});
-	return true;
+	}
+	if (signature.typed) {
+		// Les valeurs par défaut ne sont pas revérifiées à chaque appel
+		for (size_t i = 0, first = nb_args - default_args.size(); i < default_args.size(); ++i) {
+			if (!signature.accepts(first + i, default_args[i])) {
+				LOG(Error) << "Default argument " << first + i << " of command '" << command_name << "' must be "
+					<< VariantIndexName(signature.args[first + i]) << ", not " << VariantTypeName(default_args[i]);
+				return false;
+			}
+		}
+	}
+	return modify([&](Registry& registry) {
+		if (registry.index.contains(command_name)) {
+			LOG(Error) << "Command '" << command_name << "' already exists";
+			return false;
+		}
+		_commands.push_back(std::make_unique<CommandInfo>(CommandInfo{command_name, description, nb_args, nb_returns, default_args, std::move(function), std::move(signature), pure, this}));
+		CommandInfo* cmd = _commands.back().get();
+		if (pure && !_cache) {
+			_cache = std::make_unique<CommandCache>(_cacheCapacity);
+		}
+		registry.commands.push_back(cmd);
+		registry.index.emplace(command_name, cmd);
+		return true;
+	});
 }
 
 bool CommandsListener::setAlias(const std::string& command, const std::string& alias) {
-	for (auto& cmd : _commands) {
-		if (cmd.name == command) {
-			cmd.alias = alias;
-			return true;
+	return modify([&](Registry& registry) {
+		auto it = registry.index.find(command);
+		if (it == registry.index.end() || it->second->name != command) {
+			return false;
 		}
-	}
-	return false;
+		CommandInfo* cmd = it->second;
+		auto existing = registry.index.find(alias);
+		if (existing != registry.index.end() && existing->second != cmd) {
+			LOG(Error) << "Alias '" << alias << "' is already used by command '" << existing->second->name << "'";
+			return false;
+		}
+		auto previous = registry.aliases.find(cmd);
+		if (previous != registry.aliases.end()) {
+			registry.index.erase(previous->second);
+		}
+		registry.aliases.insert_or_assign(cmd, alias);
+		registry.index.insert_or_assign(alias, cmd);
+		return true;
+	});
 }
 
 bool CommandsListener::isAlias(const std::string& alias) const {
-	for (const auto& cmd : _commands) {
-		if (cmd.alias == alias) {
-			return true;
-		}
-	}
-	return false;
+	return read([&](const Registry& registry) {
+		auto it = registry.index.find(alias);
+		return it != registry.index.end() && it->second->name != alias;
+	});
 }
 
-const std::string& CommandsListener::getAlias(const std::string& command) const {
-	for (const auto& cmd : _commands) {
-		if (cmd.name == command) {
-			return cmd.alias;
+std::string CommandsListener::getAlias(const std::string& command) const {
+	return read([&](const Registry& registry) {
+		auto it = registry.index.find(command);
+		if (it == registry.index.end() || it->second->name != command) {
+			throw CommandNotFoundException(command);
 		}
-	}
-	throw CommandNotFoundException(command);
+		auto alias = registry.aliases.find(it->second);
+		return alias != registry.aliases.end() ? alias->second : std::string();
+	});
 }
 
 bool CommandsListener::removeCommand(const std::string& commandOrAlias) {
-	auto it = std::remove_if(_commands.begin(), _commands.end(), [&](const CommandInfo& cmd) {
-		return cmd.name == commandOrAlias || cmd.alias == commandOrAlias;
-	});
-	if (it != _commands.end()) {
-		_commands.erase(it, _commands.end());
+	return modify([&](Registry& registry) {
+		auto it = registry.index.find(commandOrAlias);
+		if (it == registry.index.end()) {
+			return false;
+		}
+		CommandInfo* cmd = it->second;
+		registry.index.erase(cmd->name);
+		auto alias = registry.aliases.find(cmd);
+		if (alias != registry.aliases.end()) {
+			registry.index.erase(alias->second);
+			registry.aliases.erase(alias);
+		}
+		std::erase(registry.commands, cmd);
+		// La commande n'est plus possédée que par la liste des retraits : détruite après la publication
+		auto owned = std::find_if(_commands.begin(), _commands.end(), [cmd](const std::unique_ptr<CommandInfo>& command) { return command.get() == cmd; });
+		_removed.push_back(owned->release());
+		_commands.erase(owned);
 		return true;
-	}
-	return false;
+	});
 }
 
 bool CommandsListener::isCommand(const std::string& commandOrAlias) const {
-	try {
-		findCommand(commandOrAlias);
-		return true;
-	} catch (...) {
-		return false;
-	}
+	return read([&](const Registry& registry) { return registry.index.contains(commandOrAlias); });
 }
 
 std::vector<std::string> CommandsListener::getCommands() const {
-	std::vector<std::string> command_names;
-	for (const auto& cmd : _commands) {
-		command_names.push_back(cmd.name);
-	}
-	return command_names;
+	return read([](const Registry& registry) {
+		std::vector<std::string> command_names;
+		command_names.reserve(registry.commands.size());
+		for (const CommandInfo* cmd : registry.commands) {
+			command_names.push_back(cmd->name);
+		}
+		return command_names;
+	});
 }
 
 const std::string& CommandsListener::getDescription(const std::string& commandOrAlias) const {
@@ -84,29 +211,168 @@ size_t CommandsListener::getNbReturns(const std::string& commandOrAlias) const {
 }
 
 const CommandInfo& CommandsListener::findCommand(const std::string& commandOrAlias) const {
-	auto it = std::find_if(_commands.begin(), _commands.end(), [&](const CommandInfo& cmd) {
-		return cmd.name == commandOrAlias || cmd.alias == commandOrAlias;
+	return read([&](const Registry& registry) -> const CommandInfo& {
+		auto it = registry.index.find(commandOrAlias);
+		if (it == registry.index.end()) {
+			throw CommandNotFoundException(commandOrAlias);
+		}
+		return *it->second;
 	});
-	if (it == _commands.end()) {
-		throw CommandNotFoundException(commandOrAlias);
+}
+
+const CommandSignature& CommandsListener::getSignature(const std::string& commandOrAlias) const {
+	return findCommand(commandOrAlias).signature;
+}
+
+CommandHandle CommandsListener::getCommandHandle(std::string_view commandOrAlias) const noexcept {
+	return read([&](const Registry& registry) {
+		auto it = registry.index.find(commandOrAlias);
+		return CommandHandle(it != registry.index.end() ? it->second : nullptr);
+	});
+}
+
+void CommandHandle::call(std::span<const VariantType> args, std::vector<VariantType>& results) const {
+	const CommandInfo& cmd = *_command;
+
+	// Vérifier si le nombre d'arguments fournis est correct : les valeurs par défaut complètent les derniers
+	const size_t required = cmd.nb_args - cmd.default_args.size();
+	if (args.size() < required || args.size() > cmd.nb_args) {
+#if COMMAND_STATS
+		cmd.stats->recordArgumentError();
+#endif
+		throw InvalidArgumentsException(cmd.name, cmd.nb_args, cmd.default_args.size(), args.size());
 	}
-	return *it;
+
+	// Vérifier les types des arguments d'une commande typée, une seule fois avant de les convertir
+	if (cmd.signature.typed) {
+		for (size_t i = 0; i < args.size(); ++i) {
+			if (!cmd.signature.accepts(i, args[i])) {
+#if COMMAND_STATS
+				cmd.stats->recordArgumentError();
+#endif
+				throw CommandArgumentTypeException(cmd.name, i, cmd.signature.args[i], args[i].index());
+			}
+		}
+	}
+
+	// Appeler la fonction avec les arguments complétés, sans les copier
+	CommandArgs full_args(args, std::span<const VariantType>(cmd.default_args).subspan(args.size() - required));
+	results.clear();
+#if COMMAND_STATS
+	auto start = std::chrono::steady_clock::now();
+	try {
+		if (cmd.pure) {
+			cmd.owner->callPure(cmd, full_args, results);
+		} else {
+			cmd.function(full_args, results);
+		}
+	} catch (...) {
+		cmd.stats->recordException(std::chrono::steady_clock::now() - start);
+		throw;
+	}
+	cmd.stats->record(std::chrono::steady_clock::now() - start);
+#else
+	if (cmd.pure) {
+		cmd.owner->callPure(cmd, full_args, results);
+	} else {
+		cmd.function(full_args, results);
+	}
+#endif
 }
 
-std::vector<VariantType> CommandsListener::callCommand(const std::string& commandOrAlias, const std::vector<VariantType>& args) {
-	const auto& cmd = findCommand(commandOrAlias);
-	
-	// Vérifier si le nombre d'arguments fournis est correct
-	if (args.size()-cmd.default_args.size() > cmd.nb_args) {
-		throw InvalidArgumentsException(commandOrAlias, cmd.nb_args, cmd.default_args.size(), args.size());
+void CommandsListener::callPure(const CommandInfo& command, const CommandArgs& args, std::vector<VariantType>& results) {
+	// Cache désactivé : ni hachage, ni verrou, ni copie des arguments
+	if (!_cache->enabled()) {
+		command.function(args, results);
+		return;
+	}
+	// Version lue avant l'exécution : un résultat calculé pendant une modification de variable n'est pas conservé
+	uint64_t version = getStateVersion();
+	if (_cache->find(&command, args, version, results)) {
+		return;
 	}
+	command.function(args, results);
+	_cache->insert(&command, args, version, results);
+}
+
+void CommandsListener::setCommandCacheCapacity(size_t bytes) {
+	// _cache est créé sous _writeMutex par la première commande pure
+	std::lock_guard<std::recursive_mutex> lock(_writeMutex);
+	_cacheCapacity = bytes;
+	if (_cache) {
+		_cache->setCapacity(bytes);
+	}
+}
+
+CommandCacheStats CommandsListener::getCommandCacheStats() const {
+	std::lock_guard<std::recursive_mutex> lock(_writeMutex);
+	if (!_cache) {
+		CommandCacheStats stats;
+		stats.capacity = _cacheCapacity;
+		return stats;
+	}
+	return _cache->getStats();
+}
 
-	// Préparer les arguments en utilisant les valeurs par défaut si nécessaire
-	std::vector<VariantType> full_args = cmd.default_args;
-	for (size_t i = 0; i < args.size(); ++i) {
-		full_args[i] = args[i];
+void CommandsListener::clearCommandCache() {
+	std::lock_guard<std::recursive_mutex> lock(_writeMutex);
+	if (_cache) {
+		_cache->clear();
 	}
+}
+
+std::vector<CommandStatsSnapshot> CommandsListener::getCommandStats() const {
+	std::vector<CommandStatsSnapshot> stats;
+#if COMMAND_STATS
+	read([&](const Registry& registry) {
+		stats.reserve(registry.commands.size());
+		for (const CommandInfo* cmd : registry.commands) {
+			stats.push_back(cmd->stats->snapshot(cmd->name));
+		}
+	});
+#endif
+	return stats;
+}
+
+void CommandsListener::resetCommandStats() {
+#if COMMAND_STATS
+	read([](const Registry& registry) {
+		for (const CommandInfo* cmd : registry.commands) {
+			cmd->stats->reset();
+		}
+	});
+#endif
+}
 
-	// Appeler la fonction avec les arguments complétés
-	return cmd.function(args);
+std::vector<VariantType> CommandHandle::call(const std::vector<VariantType>& args) const {
+	std::vector<VariantType> results;
+	call(std::span<const VariantType>(args), results);
+	return results;
+}
+
+std::vector<VariantType> CommandsListener::callCommand(const std::string& commandOrAlias, const std::vector<VariantType>& args) {
+	std::vector<VariantType> results;
+	callCommand(std::string_view(commandOrAlias), std::span<const VariantType>(args), results);
+	return results;
+}
+
+void CommandsListener::callCommand(std::string_view commandOrAlias, std::span<const VariantType> args, std::vector<VariantType>& results) {
+	// La section de lecture couvre l'appel : une suppression concurrente attend la fin de la commande
+	read([&](const Registry& registry) {
+		auto it = registry.index.find(commandOrAlias);
+		if (it == registry.index.end()) {
+			throw CommandNotFoundException(std::string(commandOrAlias));
+		}
+		CommandHandle(it->second).call(args, results);
+	});
+}
+
+std::future<std::vector<VariantType>> CommandsListener::callCommandAsync(const std::string& commandOrAlias, std::vector<VariantType> args,
+	CommandExecutor& executor, std::optional<CancellationToken> token)
+{
+	auto promise = std::make_shared<std::promise<std::vector<VariantType>>>();
+	std::future<std::vector<VariantType>> future = promise->get_future();
+	executor.submit(makeCommandTask(std::move(promise), std::move(token), commandOrAlias,
+		[this, commandOrAlias, args = std::move(args)]() { return callCommand(commandOrAlias, args); }));
+	return future;
 }
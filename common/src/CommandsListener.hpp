@@ -17,17 +17,115 @@
 #include <vector>
 #include <functional>
 #include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <span>
 #include <stdexcept>
+#include "CommandCache.hpp"
+#include "CommandExecutor.hpp"
+#include "CommandSignature.hpp"
+#include "CommandStats.hpp"
+#include "InplaceFunction.hpp"
+#include "Rcu.hpp"
+#include "StringHash.hpp"
 #include "VariantType.hpp"
 
+/**
+ * @brief Arguments d'une commande : ceux fournis par l'appelant suivis des valeurs par défaut manquantes
+ * Simple vue sur les deux tableaux, rien n'est copié.
+ */
+class CommandArgs {
+public:
+	CommandArgs(std::span<const VariantType> args, std::span<const VariantType> defaults) noexcept
+		: _args(args), _defaults(defaults) {}
+
+	size_t size() const noexcept { return _args.size() + _defaults.size(); }
+
+	const VariantType& operator[](size_t index) const noexcept {
+		return index < _args.size() ? _args[index] : _defaults[index - _args.size()];
+	}
+
+	template<typename T>
+	const T& get(size_t index) const { return std::get<T>((*this)[index]); }
+
+	/**
+	 * @brief Fonction pour copier les arguments dans un vecteur (pour les commandes de l'ancienne forme)
+	 * @return Arguments complets
+	 */
+	std::vector<VariantType> toVector() const;
+
+private:
+	std::span<const VariantType> _args;
+	std::span<const VariantType> _defaults;
+};
+
+/**
+ * @brief Fonction d'une commande : lit ses arguments et ajoute ses valeurs de retour à results
+ */
+using CommandFunction = InplaceFunction<void(const CommandArgs& args, std::vector<VariantType>& results), 64>;
+
+class CommandsListener;
+
 struct CommandInfo {
 	std::string name;	   ///< Nom de la commande
-	std::string alias;	  ///< Alias de la commande (simplification du mon de la commande)
 	std::string description;///< Description de la commande
 	size_t nb_args;		 ///< Nombre d'arguments attendus par la commande
 	size_t nb_returns;	  ///< Nombre de valeurs retournées par la commande
-	std::vector<VariantType> default_args; ///< Liste des arguments par défaut à passer à la commande
-	std::function<std::vector<VariantType>(const std::vector<VariantType>&)> function; ///< Fonction de la commande
+	std::vector<VariantType> default_args; ///< Valeurs par défaut des derniers arguments de la commande
+	CommandFunction function; ///< Fonction de la commande
+	CommandSignature signature; ///< Types déclarés des arguments et des valeurs retournées (commandes typées)
+	bool pure = false;	  ///< Résultat mis en cache : il ne dépend que des arguments et des variables du plugin
+	CommandsListener* owner = nullptr; ///< Objet qui possède la commande (et son cache)
+#if COMMAND_STATS
+	std::unique_ptr<CommandStats> stats = std::make_unique<CommandStats>(); ///< Nombre d'appels, erreurs et latences
+#endif
+};
+
+template<typename Signature>
+struct TypedCommand;
+
+/**
+ * @brief Génère le code qui passe les arguments d'une commande typée à sa fonction
+ * Les types des arguments sont vérifiés avant l'appel (CommandSignature::accepts) : ici ils sont lus sans contrôle.
+ */
+template<typename R, typename... Args>
+struct TypedCommand<R(Args...)> {
+	static_assert(((variantIndex<std::decay_t<Args>> != std::variant_npos) && ...), "Command argument types must be VariantType alternatives");
+	static_assert(CommandReturnTypes<R>::valid, "Command return types must be void, a VariantType alternative or a tuple of them");
+
+	static constexpr size_t nb_args = sizeof...(Args);
+
+	static CommandSignature signature([[maybe_unused]] ArgumentCoercion coercion) {
+		return CommandSignature{ true, { variantIndex<std::decay_t<Args>>... }, CommandReturnTypes<R>::get(),
+			{ acceptedTypes<std::decay_t<Args>>(coercion)... } };
+	}
+
+	template<typename F>
+	static CommandFunction wrap(F function) {
+		return [function = std::move(function)](const CommandArgs& args, std::vector<VariantType>& results) mutable {
+			invoke(function, args, results, std::index_sequence_for<Args...>{});
+		};
+	}
+
+private:
+	template<typename F, size_t... I>
+	static void invoke(F& function, const CommandArgs& args, std::vector<VariantType>& results, std::index_sequence<I...>) {
+		if constexpr (std::is_void_v<R>) {
+			function(argumentAs<std::decay_t<Args>>(args[I])...);
+		} else {
+			addResults(results, function(argumentAs<std::decay_t<Args>>(args[I])...));
+		}
+	}
+
+	template<typename T>
+	static void addResults(std::vector<VariantType>& results, T&& value) {
+		results.emplace_back(std::forward<T>(value));
+	}
+
+	template<typename... Ts>
+	static void addResults(std::vector<VariantType>& results, std::tuple<Ts...>&& values) {
+		std::apply([&results](auto&&... value) { (results.emplace_back(std::move(value)), ...); }, std::move(values));
+	}
 };
 
 class CommandNotFoundException : public std::runtime_error {
@@ -44,9 +142,91 @@ public:
 							 ", Provided: " + std::to_string(provided)) {}
 };
 
+/**
+ * @brief Référence directe vers une commande
+ * Obtenue une fois avec CommandsListener::getCommandHandle, elle appelle ensuite la commande sans
+ * recherche ni comparaison de chaînes. Elle reste valide tant que la commande n'est pas supprimée
+ * et que l'objet qui la possède (le plugin) existe : un thread qui peut supprimer une commande
+ * utilisée ailleurs doit faire appeler celle-ci par son nom (callCommand), qui est protégé.
+ */
+class CommandHandle {
+public:
+	CommandHandle() noexcept = default;
+
+	bool ok() const noexcept { return _command != nullptr; }
+	const CommandInfo& info() const noexcept { return *_command; }
+
+	/**
+	 * @brief Fonction pour appeler la commande
+	 * @param[in] args Liste des arguments passés à la commande
+	 * @return Liste des valeurs retournées par la commande
+	 */
+	std::vector<VariantType> call(const std::vector<VariantType>& args) const;
+
+	/**
+	 * @brief Fonction pour appeler la commande sans allocation
+	 * Les arguments manquants sont complétés par les valeurs par défaut sans copie, et les valeurs retournées
+	 * sont écrites dans results, vidé au préalable : en réutilisant le même vecteur, un appel n'alloue rien.
+	 * @param[in] args Arguments passés à la commande
+	 * @param[out] results Valeurs retournées par la commande
+	 */
+	void call(std::span<const VariantType> args, std::vector<VariantType>& results) const;
+
+private:
+	friend class CommandsListener;
+	explicit CommandHandle(const CommandInfo* command) noexcept : _command(command) {}
+
+	const CommandInfo* _command = nullptr;
+};
+
+/**
+ * @brief Liste des commandes d'un plugin
+ *
+ * Les commandes peuvent être appelées et recherchées depuis plusieurs threads pendant qu'un autre en ajoute
+ * ou en supprime. Les lectures passent par un instantané immuable de la liste (Registry), publié atomiquement
+ * et lu dans une section RCU : aucun verrou, quelques nanosecondes par lecture. Les modifications sont
+ * sérialisées : chacune copie l'instantané et publie la copie modifiée. L'ancien instantané (et la commande
+ * supprimée) est retiré sans attendre : il est détruit avec un lot d'autres après une seule période de grâce.
+ * beginCommands et endCommands regroupent plusieurs modifications en une seule copie et une seule publication.
+ * Une commande ne doit pas ajouter ni supprimer de commande du même objet pendant son exécution.
+ */
 class CommandsListener {
 private:
-	std::vector<CommandInfo> _commands;
+	/**
+	 * @brief Instantané des commandes, jamais modifié après sa publication
+	 */
+	struct Registry {
+		std::vector<CommandInfo*> commands;							///< Dans l'ordre d'ajout
+		StringMap<CommandInfo*> index;								///< Noms et alias -> commande
+		std::unordered_map<const CommandInfo*, std::string> aliases;	///< Commande -> alias
+	};
+
+	std::atomic<const Registry*> _registry;
+	std::atomic<uint64_t> _listVersion{0};	///< Incrémenté à chaque publication d'un nouvel instantané
+	RcuDomain _rcu;
+	mutable std::recursive_mutex _writeMutex;				///< Sérialise les modifications, tenu pendant tout un lot
+	std::vector<std::unique_ptr<CommandInfo>> _commands;	///< Commandes possédées, adresses stables (modifié sous _writeMutex)
+	std::vector<CommandInfo*> _removed;						///< Commandes supprimées, retirées à la prochaine publication
+	std::unique_ptr<Registry> _draft;						///< Instantané en cours de modification par un lot
+	size_t _batchDepth = 0;									///< Imbrication de beginCommands
+	bool _draftChanged = false;
+	std::unique_ptr<CommandCache> _cache;					///< Résultats des commandes pures, créé avec la première (sous _writeMutex)
+	size_t _cacheCapacity = CommandCache::DEFAULT_CAPACITY;	///< Modifié sous _writeMutex
+
+	friend class CommandHandle;
+
+	bool registerCommand(const std::string& command_name, const std::string& description, size_t nb_args, size_t nb_returns,
+		CommandFunction function, const std::vector<VariantType>& default_args, CommandSignature signature, bool pure);
+	void callPure(const CommandInfo& command, const CommandArgs& args, std::vector<VariantType>& results);
+	void publish(std::unique_ptr<Registry> registry);
+	template<typename F>
+	bool modify(F&& edit);
+
+	template<typename F>
+	decltype(auto) read(F&& function) const {
+		auto guard = _rcu.read();
+		return function(*_registry.load(std::memory_order_acquire));
+	}
 public:
 	CommandsListener();
 
@@ -60,20 +240,81 @@ protected:
 	 * @param[in] nb_args Nombre d'arguments attendus par la commande
 	 * @param[in] nb_returns Nombre de valeurs retournées par la commande
 	 * @param[in] function Fonction à appeler pour exécuter la commande
-	 * @param[in] default_args Valeurs par défaut à utiliser si aucune n'est fournie
-	 * @return true si la commande a été ajoutée, false sinon
+	 * @param[in] default_args Valeurs par défaut des derniers arguments, utilisées quand l'appelant ne les fournit pas
+	 * @param[in] pure true si le résultat ne dépend que des arguments et des variables du plugin : il est alors mis en cache
+	 * @return true si la commande a été ajoutée, false sinon (nom déjà utilisé, trop d'arguments par défaut)
 	 */
 	bool addCommand(const std::string& command_name, const std::string& description, size_t nb_args, size_t nb_returns,
-		std::function<std::vector<VariantType>(const std::vector<VariantType>&)> function, const std::vector<VariantType>& default_args = {});
+		std::function<std::vector<VariantType>(const std::vector<VariantType>&)> function, const std::vector<VariantType>& default_args = {},
+		bool pure = false);
+
+	/**
+	 * @brief Fonction pour ajouter une commande appelée sans allocation
+	 * La fonction reçoit une vue sur les arguments et ajoute ses valeurs de retour au vecteur fourni.
+	 * @param[in] command_name Nom de la commande
+	 * @param[in] description Description de la commande
+	 * @param[in] nb_args Nombre d'arguments attendus par la commande
+	 * @param[in] nb_returns Nombre de valeurs retournées par la commande
+	 * @param[in] function Fonction à appeler pour exécuter la commande
+	 * @param[in] default_args Valeurs par défaut des derniers arguments, utilisées quand l'appelant ne les fournit pas
+	 * @param[in] pure true si le résultat ne dépend que des arguments et des variables du plugin : il est alors mis en cache
+	 * @return true si la commande a été ajoutée, false sinon (nom déjà utilisé, trop d'arguments par défaut)
+	 */
+	bool addCommand(const std::string& command_name, const std::string& description, size_t nb_args, size_t nb_returns,
+		CommandFunction function, const std::vector<VariantType>& default_args = {}, bool pure = false);
+
+	/**
+	 * @brief Fonction pour ajouter une commande typée, par exemple addCommand<double(int32_t, double)>(...)
+	 * Le nombre d'arguments, leurs types et ceux des valeurs retournées sont déduits de la signature.
+	 * Les types des arguments sont vérifiés une fois avant l'appel (CommandArgumentTypeException),
+	 * puis la fonction reçoit des valeurs déjà converties. Pour plusieurs valeurs retournées, la fonction renvoie un std::tuple.
+	 * @param[in] command_name Nom de la commande
+	 * @param[in] description Description de la commande
+	 * @param[in] function Fonction à appeler pour exécuter la commande
+	 * @param[in] default_args Valeurs par défaut des derniers arguments, utilisées quand l'appelant ne les fournit pas
+	 * @param[in] coercion Conversions acceptées pour les arguments
+	 * @param[in] pure true si le résultat ne dépend que des arguments et des variables du plugin : il est alors mis en cache
+	 * @return true si la commande a été ajoutée, false sinon (nom déjà utilisé, valeurs par défaut invalides)
+	 */
+	template<typename Signature, typename F>
+	bool addCommand(const std::string& command_name, const std::string& description, F function,
+		const std::vector<VariantType>& default_args = {}, ArgumentCoercion coercion = ArgumentCoercion::Exact, bool pure = false)
+	{
+		using Command = TypedCommand<Signature>;
+		CommandSignature signature = Command::signature(coercion);
+		size_t nb_returns = signature.returns.size();
+		return registerCommand(command_name, description, Command::nb_args, nb_returns,
+			Command::wrap(std::move(function)), default_args, std::move(signature), pure);
+	}
 
 	/**
 	 * @brief Fonction pour ajouter un alias à une commande
 	 * @param[in] command Nom de la commande
 	 * @param[in] alias Alias à donner à la commande
-	 * @return true si l'alias a été ajouté, false sinon
+	 * @return true si l'alias a été ajouté, false sinon (commande inconnue, alias déjà utilisé)
 	 */
 	bool setAlias(const std::string& command, const std::string& alias);
 
+	/**
+	 * @brief Commencer un lot de modifications de la liste, publié en une seule fois par endCommands
+	 * Jusqu'à endCommands, addCommand, setAlias et removeCommand appelées depuis ce thread modifient une copie
+	 * de la liste : les lecteurs voient la liste précédente, les modifications des autres threads attendent.
+	 * Les lots peuvent être imbriqués, seul le dernier endCommands publie.
+	 */
+	void beginCommands();
+
+	/**
+	 * @brief Terminer un lot de modifications commencé par beginCommands et le publier
+	 */
+	void endCommands();
+
+	/**
+	 * @brief Version de l'état dont dépendent les commandes pures (les variables du plugin)
+	 * Le cache est vidé entièrement dès qu'elle change, quelle que soit la variable modifiée. Sans variables, elle ne change jamais.
+	 * @return Version actuelle
+	 */
+	virtual uint64_t getStateVersion() const noexcept { return 0; }
+
 public:
 	/**
 	 * @brief Fonction savoir si c'est un alias
@@ -86,7 +327,7 @@ public:
 	 * @brief Fonction pour connaître l'alias d'une commande
 	 * @param[in] command Alias de la commande
 	 */
-	const std::string &getAlias(const std::string& command) const;
+	std::string getAlias(const std::string& command) const;
 
 protected:
 	/**
@@ -110,6 +351,26 @@ public:
 	 */
 	std::vector<std::string> getCommands() const;
 
+	/**
+	 * @brief Fonction pour parcourir les commandes dans l'ordre d'ajout, sans construire la liste des noms
+	 * La fonction est appelée dans une section de lecture : elle ne doit pas ajouter ni supprimer de commande.
+	 * @param[in] function Fonction appelée avec le nom de chaque commande
+	 */
+	template<typename F>
+	void forEachCommand(F&& function) const {
+		read([&](const Registry& registry) {
+			for (const CommandInfo* cmd : registry.commands) {
+				function(cmd->name);
+			}
+		});
+	}
+
+	/**
+	 * @brief Fonction pour savoir si des commandes ont été ajoutées, supprimées ou renommées par un alias
+	 * @return Version de la liste des commandes
+	 */
+	uint64_t getCommandListVersion() const noexcept { return _listVersion.load(std::memory_order_acquire); }
+
 	/**
 	 * @brief fonction pur connaître la description d'une commande
 	 * @param[in] commandOrAlias Nom de la commande ou alias
@@ -134,10 +395,52 @@ public:
 	/**
 	 * @brief Fonction pour trouver les informations d'une commande
 	 * @param[in] commandOrAlias Nom de la commande ou alias
-	 * @return Informations de la commande
+	 * @return Informations de la commande, valides tant que la commande n'est pas supprimée
 	 */
 	const CommandInfo &findCommand(const std::string& commandOrAlias) const;
 
+	/**
+	 * @brief Fonction pour connaître les types déclarés d'une commande
+	 * @param[in] commandOrAlias Nom de la commande ou alias
+	 * @return Signature de la commande (CommandSignature::typed == false si elle a été déclarée sans types)
+	 */
+	const CommandSignature &getSignature(const std::string& commandOrAlias) const;
+
+	/**
+	 * @brief Fonction pour limiter la mémoire du cache des commandes pures
+	 * @param[in] bytes Mémoire maximale, en octets (0 désactive le cache)
+	 */
+	void setCommandCacheCapacity(size_t bytes);
+
+	/**
+	 * @brief Fonction pour récupérer les compteurs du cache des commandes pures
+	 * @return Compteurs, nuls si aucune commande n'est pure
+	 */
+	CommandCacheStats getCommandCacheStats() const;
+
+	/**
+	 * @brief Fonction pour vider le cache des commandes pures
+	 */
+	void clearCommandCache();
+
+	/**
+	 * @brief Fonction pour récupérer les statistiques des commandes (appels, erreurs, histogramme des latences)
+	 * @return Statistiques de chaque commande, vide si elles sont désactivées à la compilation (COMMAND_STATS=0)
+	 */
+	std::vector<CommandStatsSnapshot> getCommandStats() const;
+
+	/**
+	 * @brief Fonction pour remettre à zéro les statistiques des commandes
+	 */
+	void resetCommandStats();
+
+	/**
+	 * @brief Fonction pour obtenir une référence directe vers une commande
+	 * @param[in] commandOrAlias Nom de la commande ou alias
+	 * @return Référence de la commande, invalide (ok() == false) si la commande n'existe pas
+	 */
+	CommandHandle getCommandHandle(std::string_view commandOrAlias) const noexcept;
+
 	/**
 	 * @brief Fonction pour appeler une commande avec un nombre variable d'arguments
 	 * @param[in] commandOrAlias Nom de la commande ou alias
@@ -145,6 +448,27 @@ public:
 	 * @return Liste des valeurs retournées par la commande
 	 */
 	std::vector<VariantType> callCommand(const std::string& commandOrAlias, const std::vector<VariantType>& args);
+
+	/**
+	 * @brief Fonction pour appeler une commande sans allocation (voir CommandHandle::call)
+	 * @param[in] commandOrAlias Nom de la commande ou alias
+	 * @param[in] args Arguments passés à la commande
+	 * @param[out] results Valeurs retournées par la commande
+	 */
+	void callCommand(std::string_view commandOrAlias, std::span<const VariantType> args, std::vector<VariantType>& results);
+
+	/**
+	 * @brief Fonction pour appeler une commande sur un exécuteur, sans attendre son résultat
+	 * Les exceptions de la commande (commande inconnue, arguments invalides...) sont transmises par le future.
+	 * L'objet doit rester en vie jusqu'à la fin de la commande.
+	 * @param[in] commandOrAlias Nom de la commande ou alias
+	 * @param[in] args Liste des arguments passés à la commande
+	 * @param[in] executor Exécuteur du programme principal
+	 * @param[in] token Jeton d'annulation optionnel
+	 * @return Future des valeurs retournées par la commande
+	 */
+	std::future<std::vector<VariantType>> callCommandAsync(const std::string& commandOrAlias, std::vector<VariantType> args,
+		CommandExecutor& executor, std::optional<CancellationToken> token = std::nullopt);
 };
 
 #endif // COMMANDS_LISTENER_HPP
\ No newline at end of file
@@ -0,0 +1,362 @@
+#include <algorithm>
+#include <stdexcept>
+#include "EventBus.hpp"
+#include "Logger.hpp"
+
+EventBus *EventBus::instance = nullptr;
+
+EventBus &EventBus::getInstance() {
+	if (instance == nullptr) {
+		throw std::runtime_error("EventBus not initialized");
+	}
+	return *instance;
+}
+
+EventBus &EventBus::setInstance(EventBus *events) {
+	if (instance != nullptr) {
+		throw std::runtime_error("EventBus already initialized");
+	}
+	instance = events;
+	return *instance;
+}
+
+EventBus::EventBus(size_t nbDispatchers)
+	: _topics(std::make_unique<TopicState[]>(MAX_TOPICS)), _topicCount(0), _inFlight(0), _stopping(false),
+	  _nbDispatchers(nbDispatchers), _nextSubscription(0), _started(false) {}
+
+EventBus::~EventBus() {
+	stop();
+	for (auto& [id, subscriber] : _subscribers) {
+		delete subscriber;
+	}
+	for (uint32_t i = 0; i < _topicCount.load(); ++i) {
+		delete _topics[i].subscribers.load();
+	}
+	for (auto& dispatcher : _dispatchers) {
+		delete dispatcher->subscribers.load();
+	}
+	for (const SubscriberList* list : _retiredLists) {
+		delete list;
+	}
+	for (Subscriber* subscriber : _retiredSubscribers) {
+		delete subscriber;
+	}
+}
+
+void EventBus::setDispatchers(size_t nbDispatchers) {
+	std::lock_guard<std::mutex> lock(_mutex);
+	if (_started) {
+		LOG(Warning) << "Event bus already started, the number of dispatchers cannot change.";
+		return;
+	}
+	_nbDispatchers = nbDispatchers;
+}
+
+void EventBus::start() {
+	std::lock_guard<std::mutex> lock(_mutex);
+	startLocked();
+}
+
+void EventBus::startLocked() {
+	if (_started || _stopping.load()) {
+		return;
+	}
+	size_t nbDispatchers = _nbDispatchers ? _nbDispatchers : std::max(1u, std::thread::hardware_concurrency());
+	for (size_t i = 0; i < nbDispatchers; ++i) {
+		_dispatchers.push_back(std::make_unique<Dispatcher>());
+	}
+	for (auto& dispatcher : _dispatchers) {
+		dispatcher->thread = std::thread(&EventBus::dispatchLoop, this, std::ref(*dispatcher));
+	}
+	_started = true;
+}
+
+uint32_t EventBus::registerTopic(const std::string& name, size_t type) {
+	std::lock_guard<std::mutex> lock(_mutex);
+	auto it = _topicIndex.find(name);
+	if (it != _topicIndex.end()) {
+		if (_topics[it->second].type != type) {
+			LOG(Error) << "Topic '" << name << "' already exists with another type";
+			return Topic<int>::INVALID;
+		}
+		return it->second;
+	}
+	uint32_t id = _topicCount.load(std::memory_order_relaxed);
+	if (id >= MAX_TOPICS) {
+		LOG(Error) << "Too many topics, cannot create '" << name << "'";
+		return Topic<int>::INVALID;
+	}
+	_topics[id].name = name;
+	_topics[id].type = type;
+	_topicIndex.emplace(name, id);
+	_topicCount.store(id + 1, std::memory_order_release);
+	return id;
+}
+
+bool EventBus::publish(uint32_t topicId, VariantType&& value) {
+	if (topicId >= _topicCount.load(std::memory_order_acquire) || _stopping.load(std::memory_order_relaxed)) {
+		return false;
+	}
+	auto guard = _rcu.read();
+	const SubscriberList* subscribers = _topics[topicId].subscribers.load(std::memory_order_acquire);
+	if (!subscribers) {
+		return true;
+	}
+	bool delivered = true;
+	for (Subscriber* subscriber : *subscribers) {
+		delivered = deliver(*subscriber, value) && delivered;
+	}
+	return delivered;
+}
+
+bool EventBus::deliver(Subscriber& subscriber, const VariantType& value) {
+	// Compté avant l'ajout : flush() ne peut pas voir une file non vide avec _inFlight à 0
+	_inFlight.fetch_add(1, std::memory_order_relaxed);
+	if (!subscriber.queue.tryPush(value)) {
+		switch (subscriber.policy) {
+			case OverflowPolicy::Drop:
+				subscriber.dropped.fetch_add(1, std::memory_order_relaxed);
+				_inFlight.fetch_sub(1, std::memory_order_relaxed);
+				return false;
+			case OverflowPolicy::Overwrite: {
+				VariantType oldest;
+				while (!subscriber.queue.tryPush(value)) {
+					if (subscriber.queue.tryPop(oldest)) {
+						subscriber.overwritten.fetch_add(1, std::memory_order_relaxed);
+						_inFlight.fetch_sub(1, std::memory_order_relaxed);
+					}
+				}
+				break;
+			}
+			case OverflowPolicy::Block: {
+				Dispatcher& dispatcher = *_dispatchers[subscriber.dispatcher];
+				bool own = dispatcher.threadId.load(std::memory_order_relaxed) == std::this_thread::get_id();
+				while (!subscriber.queue.tryPush(value)) {
+					// Un abonné retiré entre-temps n'est plus vidé par son dispatcher : attendre ne finirait jamais
+					if (_stopping.load(std::memory_order_relaxed) || !subscriber.active.load(std::memory_order_relaxed)) {
+						subscriber.dropped.fetch_add(1, std::memory_order_relaxed);
+						_inFlight.fetch_sub(1, std::memory_order_relaxed);
+						return false;
+					}
+					// Le thread qui doit vider la file, c'est nous : on la vide au lieu d'attendre
+					if (own) {
+						drain(subscriber, BATCH_SIZE);
+					} else {
+						wake(dispatcher);
+						std::this_thread::yield();
+					}
+				}
+				break;
+			}
+		}
+	}
+	wake(*_dispatchers[subscriber.dispatcher]);
+	return true;
+}
+
+void EventBus::wake(Dispatcher& dispatcher) {
+	// seq_cst : soit le thread voit le nouveau signal avant de s'endormir, soit on voit qu'il dort
+	// (atomic::wait n'est pas utilisable : son état interne n'est pas partagé entre le programme et les plugins)
+	dispatcher.signal.fetch_add(1);
+	if (dispatcher.sleeping.load()) {
+		std::lock_guard<std::mutex> lock(dispatcher.mutex);
+		dispatcher.cv.notify_one();
+	}
+}
+
+size_t EventBus::drain(Subscriber& subscriber, size_t max) {
+	VariantType value;
+	size_t handled = 0;
+	while (handled < max && subscriber.queue.tryPop(value)) {
+		if (subscriber.active.load(std::memory_order_relaxed)) {
+			try {
+				subscriber.callback(value);
+			} catch (const std::exception& e) {
+				LOG(Error) << "Exception in event subscriber " << subscriber.id << ": " << e.what();
+			}
+			subscriber.delivered.fetch_add(1, std::memory_order_relaxed);
+		}
+		_inFlight.fetch_sub(1, std::memory_order_release);
+		handled++;
+	}
+	return handled;
+}
+
+void EventBus::dispatchLoop(Dispatcher& dispatcher) {
+	dispatcher.threadId.store(std::this_thread::get_id());
+	while (true) {
+		uint32_t seen = dispatcher.signal.load();
+		size_t handled = 0;
+		{
+			auto guard = _rcu.read();
+			if (const SubscriberList* subscribers = dispatcher.subscribers.load(std::memory_order_acquire)) {
+				for (Subscriber* subscriber : *subscribers) {
+					handled += drain(*subscriber, BATCH_SIZE);
+				}
+			}
+		}
+		if (handled > 0) {
+			continue;
+		}
+		if (_stopping.load()) {
+			return;
+		}
+		std::unique_lock<std::mutex> lock(dispatcher.mutex);
+		dispatcher.sleeping.store(true);
+		dispatcher.cv.wait(lock, [&]() { return dispatcher.signal.load() != seen || _stopping.load(); });
+		dispatcher.sleeping.store(false);
+	}
+}
+
+bool EventBus::onDispatcherThread() const noexcept {
+	std::thread::id self = std::this_thread::get_id();
+	return std::any_of(_dispatchers.begin(), _dispatchers.end(), [&](const auto& dispatcher) {
+		return dispatcher->threadId.load(std::memory_order_relaxed) == self;
+	});
+}
+
+const EventBus::SubscriberList* EventBus::copyWith(const SubscriberList* list, Subscriber* added, Subscriber* removed) {
+	auto* copy = new SubscriberList();
+	if (list) {
+		copy->reserve(list->size() + 1);
+		for (Subscriber* subscriber : *list) {
+			if (subscriber != removed) {
+				copy->push_back(subscriber);
+			}
+		}
+	}
+	if (added) {
+		copy->push_back(added);
+	}
+	return copy;
+}
+
+Subscription EventBus::subscribe(uint32_t topicId, size_t type, Callback callback, OverflowPolicy policy, size_t capacity, const void* owner) {
+	std::unique_lock<std::mutex> lock(_mutex);
+	if (topicId >= _topicCount.load(std::memory_order_relaxed) || _topics[topicId].type != type) {
+		LOG(Error) << "Cannot subscribe to unknown topic " << topicId;
+		return Subscription();
+	}
+	if (_stopping.load()) {
+		LOG(Error) << "Cannot subscribe to topic '" << _topics[topicId].name << "': event bus stopped";
+		return Subscription();
+	}
+	startLocked();
+
+	uint32_t id = _nextSubscription++;
+	auto* subscriber = new Subscriber(id, topicId, owner, id % _dispatchers.size(), policy, std::move(callback), capacity);
+	_subscribers.emplace(id, subscriber);
+
+	// Le thread de distribution connaît l'abonné avant que les émetteurs puissent le remplir
+	Dispatcher& dispatcher = *_dispatchers[subscriber->dispatcher];
+	_retiredLists.push_back(dispatcher.subscribers.exchange(copyWith(dispatcher.subscribers.load(), subscriber, nullptr), std::memory_order_acq_rel));
+	TopicState& topic = _topics[topicId];
+	_retiredLists.push_back(topic.subscribers.exchange(copyWith(topic.subscribers.load(), subscriber, nullptr), std::memory_order_acq_rel));
+	reclaim(lock);
+	return Subscription{ id };
+}
+
+void EventBus::removeLocked(Subscriber* subscriber) {
+	subscriber->active.store(false, std::memory_order_relaxed);
+	TopicState& topic = _topics[subscriber->topic];
+	_retiredLists.push_back(topic.subscribers.exchange(copyWith(topic.subscribers.load(), nullptr, subscriber), std::memory_order_acq_rel));
+	Dispatcher& dispatcher = *_dispatchers[subscriber->dispatcher];
+	_retiredLists.push_back(dispatcher.subscribers.exchange(copyWith(dispatcher.subscribers.load(), nullptr, subscriber), std::memory_order_acq_rel));
+	_subscribers.erase(subscriber->id);
+	_retiredSubscribers.push_back(subscriber);
+}
+
+bool EventBus::unsubscribe(Subscription subscription) {
+	std::unique_lock<std::mutex> lock(_mutex);
+	auto it = _subscribers.find(subscription.id);
+	if (it == _subscribers.end()) {
+		return false;
+	}
+	removeLocked(it->second);
+	reclaim(lock);
+	return true;
+}
+
+size_t EventBus::unsubscribeAll(const void* owner) {
+	std::unique_lock<std::mutex> lock(_mutex);
+	std::vector<Subscriber*> owned;
+	for (auto& [id, subscriber] : _subscribers) {
+		if (subscriber->owner == owner) {
+			owned.push_back(subscriber);
+		}
+	}
+	for (Subscriber* subscriber : owned) {
+		removeLocked(subscriber);
+	}
+	reclaim(lock);
+	return owned.size();
+}
+
+void EventBus::reclaim(std::unique_lock<std::mutex>& lock) {
+	// Depuis un thread de distribution, on est dans une section de lecture : la libération est reportée
+	if (onDispatcherThread() || (_retiredLists.empty() && _retiredSubscribers.empty())) {
+		return;
+	}
+	std::vector<const SubscriberList*> lists = std::move(_retiredLists);
+	std::vector<Subscriber*> subscribers = std::move(_retiredSubscribers);
+	_retiredLists.clear();
+	_retiredSubscribers.clear();
+	lock.unlock();
+
+	_rcu.synchronize();
+	for (const SubscriberList* list : lists) {
+		delete list;
+	}
+	for (Subscriber* subscriber : subscribers) {
+		// Les événements restants ne seront jamais transmis
+		VariantType value;
+		while (subscriber->queue.tryPop(value)) {
+			_inFlight.fetch_sub(1, std::memory_order_relaxed);
+		}
+		delete subscriber;
+	}
+}
+
+SubscriptionStats EventBus::getStats(Subscription subscription) const {
+	std::lock_guard<std::mutex> lock(_mutex);
+	auto it = _subscribers.find(subscription.id);
+	if (it == _subscribers.end()) {
+		return SubscriptionStats();
+	}
+	const Subscriber& subscriber = *it->second;
+	return { subscriber.delivered.load(std::memory_order_relaxed), subscriber.dropped.load(std::memory_order_relaxed),
+		subscriber.overwritten.load(std::memory_order_relaxed) };
+}
+
+void EventBus::flush() {
+	if (onDispatcherThread()) {
+		return;
+	}
+	// Les abonnés retirés depuis un thread de distribution gardent des événements comptés dans _inFlight
+	{
+		std::unique_lock<std::mutex> lock(_mutex);
+		reclaim(lock);
+	}
+	while (_inFlight.load(std::memory_order_acquire) > 0 && !_stopping.load()) {
+		std::this_thread::yield();
+	}
+}
+
+void EventBus::stop() {
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+		if (_stopping.exchange(true) || !_started) {
+			return;
+		}
+	}
+	for (auto& dispatcher : _dispatchers) {
+		std::lock_guard<std::mutex> lock(dispatcher->mutex);
+		dispatcher->signal.fetch_add(1);
+		dispatcher->cv.notify_one();
+	}
+	for (auto& dispatcher : _dispatchers) {
+		if (dispatcher->thread.joinable()) {
+			dispatcher->thread.join();
+		}
+	}
+}
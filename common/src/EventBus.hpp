@@ -0,0 +1,251 @@
+/**
+ * @file EventBus.hpp
+ * @author ClemtoClem
+ * @date 17/10/2026
+ */
+
+#ifndef EVENT_BUS_HPP
+#define EVENT_BUS_HPP
+
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+#include "MpmcQueue.hpp"
+#include "Rcu.hpp"
+#include "StringHash.hpp"
+#include "VariantType.hpp"
+
+/**
+ * @brief Comportement d'un abonné dont la file est pleine
+ */
+enum class OverflowPolicy {
+	Drop,		///< L'événement publié est perdu pour cet abonné
+	Block,		///< L'émetteur attend qu'une place se libère
+	Overwrite	///< Le plus ancien événement en attente est remplacé
+};
+
+/**
+ * @brief Sujet typé, obtenu une fois par son nom avec EventBus::topic
+ */
+template<typename T>
+struct Topic {
+	static constexpr uint32_t INVALID = UINT32_MAX;
+
+	uint32_t id = INVALID;
+
+	bool ok() const noexcept { return id != INVALID; }
+};
+
+/**
+ * @brief Abonnement à un sujet, à passer à EventBus::unsubscribe
+ */
+struct Subscription {
+	static constexpr uint32_t INVALID = UINT32_MAX;
+
+	uint32_t id = INVALID;
+
+	bool ok() const noexcept { return id != INVALID; }
+};
+
+/**
+ * @brief Compteurs d'un abonnement
+ */
+struct SubscriptionStats {
+	uint64_t delivered = 0;		///< Événements transmis à la fonction de l'abonné
+	uint64_t dropped = 0;		///< Événements perdus (OverflowPolicy::Drop)
+	uint64_t overwritten = 0;	///< Événements remplacés avant d'être transmis (OverflowPolicy::Overwrite)
+};
+
+/**
+ * @brief Bus d'événements entre plugins, possédé par PluginsManager
+ *
+ * Chaque abonné a sa propre file bornée sans verrou (MpmcQueue). Publier sur un sujet ne prend aucun
+ * verrou et ne parcourt que les abonnés de ce sujet : la liste est lue dans une section RCU.
+ * Les files sont vidées par lots par des threads de distribution ; les événements d'un abonné lui sont
+ * toujours transmis dans l'ordre, par le même thread.
+ *
+ * Les abonnements et désabonnements prennent un verrou et attendent une période de grâce :
+ * quand unsubscribe() retourne hors d'un thread de distribution, la fonction de l'abonné n'est plus appelée.
+ * OverflowPolicy::Block ne doit pas être utilisé entre abonnés qui se publient mutuellement des événements.
+ */
+class EventBus {
+public:
+	using Callback = std::function<void(const VariantType&)>;
+
+	static constexpr size_t MAX_TOPICS = 1024;
+	static constexpr size_t BATCH_SIZE = 64;	///< Événements transmis par abonné avant de passer au suivant
+
+	static EventBus *instance;
+
+	static EventBus &getInstance();
+	static EventBus &setInstance(EventBus *events);
+
+	/**
+	 * @brief Constructeur de EventBus
+	 * @param[in] nbDispatchers Nombre de threads de distribution, démarrés au premier abonnement
+	 */
+	explicit EventBus(size_t nbDispatchers = 1);
+	~EventBus();
+
+	EventBus(const EventBus&) = delete;
+	EventBus& operator=(const EventBus&) = delete;
+
+	/**
+	 * @brief Définir le nombre de threads de distribution, avant le premier abonnement
+	 * @param[in] nbDispatchers Nombre de threads, 0 pour le nombre de coeurs
+	 */
+	void setDispatchers(size_t nbDispatchers);
+
+	/**
+	 * @brief Démarrer les threads de distribution (fait automatiquement au premier abonnement)
+	 * Le programme principal les démarre lui-même : ainsi ils exécutent son code et non celui d'un plugin
+	 * qui pourrait être déchargé.
+	 */
+	void start();
+
+	/**
+	 * @brief Obtenir un sujet par son nom, en le créant si besoin
+	 * @param[in] name Nom du sujet
+	 * @return Sujet, invalide si le nom est déjà utilisé avec un autre type ou si MAX_TOPICS est atteint
+	 */
+	template<typename T>
+	Topic<T> topic(const std::string& name) {
+		static_assert(variantIndex<T> != std::variant_npos, "Topic type must be one of VariantType alternatives");
+		return Topic<T>{ registerTopic(name, variantIndex<T>) };
+	}
+
+	/**
+	 * @brief Publier un événement
+	 * @param[in] topic Sujet de l'événement
+	 * @param[in] value Valeur transmise aux abonnés
+	 * @return true si l'événement a été placé dans la file de tous les abonnés, false si au moins un l'a perdu
+	 */
+	template<typename T>
+	bool publish(Topic<T> topic, T value) {
+		return publish(topic.id, VariantType(std::move(value)));
+	}
+
+	/**
+	 * @brief S'abonner à un sujet
+	 * @param[in] topic Sujet
+	 * @param[in] callback Fonction appelée pour chaque événement, depuis un thread de distribution
+	 * @param[in] policy Comportement quand la file de l'abonné est pleine
+	 * @param[in] capacity Taille de la file de l'abonné
+	 * @param[in] owner Propriétaire de l'abonnement (le plugin), pour unsubscribeAll
+	 * @return Abonnement, invalide si le sujet n'existe pas
+	 */
+	template<typename T>
+	Subscription subscribe(Topic<T> topic, std::function<void(const T&)> callback, OverflowPolicy policy = OverflowPolicy::Drop,
+		size_t capacity = 1024, const void* owner = nullptr)
+	{
+		return subscribe(topic.id, variantIndex<T>, [callback = std::move(callback)](const VariantType& value) {
+			callback(std::get<T>(value));
+		}, policy, capacity, owner);
+	}
+
+	/**
+	 * @brief Se désabonner
+	 * @param[in] subscription Abonnement
+	 * @return true si l'abonnement existait, false sinon
+	 */
+	bool unsubscribe(Subscription subscription);
+
+	/**
+	 * @brief Supprimer tous les abonnements d'un propriétaire
+	 * @param[in] owner Propriétaire des abonnements
+	 * @return Nombre d'abonnements supprimés
+	 */
+	size_t unsubscribeAll(const void* owner);
+
+	/**
+	 * @brief Récupérer les compteurs d'un abonnement
+	 * @param[in] subscription Abonnement
+	 * @return Compteurs, nuls si l'abonnement n'existe pas
+	 */
+	SubscriptionStats getStats(Subscription subscription) const;
+
+	/**
+	 * @brief Attendre que tous les événements publiés aient été transmis
+	 */
+	void flush();
+
+	/**
+	 * @brief Transmettre les événements en attente puis arrêter les threads de distribution
+	 */
+	void stop();
+
+private:
+	struct Subscriber {
+		uint32_t id;
+		uint32_t topic;
+		const void* owner;
+		size_t dispatcher;
+		OverflowPolicy policy;
+		Callback callback;
+		MpmcQueue<VariantType> queue;
+		std::atomic<bool> active{true};
+		std::atomic<uint64_t> delivered{0};
+		std::atomic<uint64_t> dropped{0};
+		std::atomic<uint64_t> overwritten{0};
+
+		Subscriber(uint32_t id, uint32_t topic, const void* owner, size_t dispatcher, OverflowPolicy policy, Callback callback, size_t capacity)
+			: id(id), topic(topic), owner(owner), dispatcher(dispatcher), policy(policy), callback(std::move(callback)), queue(capacity) {}
+	};
+
+	using SubscriberList = std::vector<Subscriber*>;	///< Liste immuable, remplacée à chaque modification
+
+	struct TopicState {
+		std::string name;
+		size_t type = std::variant_npos;
+		std::atomic<const SubscriberList*> subscribers{nullptr};
+	};
+
+	struct Dispatcher {
+		std::thread thread;
+		std::atomic<std::thread::id> threadId;
+		std::atomic<const SubscriberList*> subscribers{nullptr};
+		std::atomic<uint32_t> signal{0};	///< Incrémenté à chaque publication
+		std::atomic<bool> sleeping{false};	///< Les émetteurs ne prennent le verrou que si le thread dort
+		std::mutex mutex;
+		std::condition_variable cv;
+	};
+
+	// Chemin de publication : sans verrou
+	std::unique_ptr<TopicState[]> _topics;
+	std::atomic<uint32_t> _topicCount;
+	std::vector<std::unique_ptr<Dispatcher>> _dispatchers;
+	std::atomic<size_t> _inFlight;			///< Événements placés dans une file et pas encore traités
+	std::atomic<bool> _stopping;
+	RcuDomain _rcu;
+
+	// Modifications : sous _mutex
+	mutable std::mutex _mutex;
+	StringMap<uint32_t> _topicIndex;
+	std::unordered_map<uint32_t, Subscriber*> _subscribers;
+	std::vector<const SubscriberList*> _retiredLists;
+	std::vector<Subscriber*> _retiredSubscribers;
+	size_t _nbDispatchers;
+	uint32_t _nextSubscription;
+	bool _started;
+
+	uint32_t registerTopic(const std::string& name, size_t type);
+	bool publish(uint32_t topic, VariantType&& value);
+	Subscription subscribe(uint32_t topic, size_t type, Callback callback, OverflowPolicy policy, size_t capacity, const void* owner);
+	void startLocked();
+	bool deliver(Subscriber& subscriber, const VariantType& value);
+	size_t drain(Subscriber& subscriber, size_t max);
+	void wake(Dispatcher& dispatcher);
+	void dispatchLoop(Dispatcher& dispatcher);
+	bool onDispatcherThread() const noexcept;
+	void removeLocked(Subscriber* subscriber);
+	void reclaim(std::unique_lock<std::mutex>& lock);
+	static const SubscriberList* copyWith(const SubscriberList* list, Subscriber* added, Subscriber* removed);
+};
+
+#endif // EVENT_BUS_HPP
@@ -0,0 +1,111 @@
+/**
+ * @file InplaceFunction.hpp
+ * @author ClemtoClem
+ * @date 17/10/2026
+ */
+
+#ifndef INPLACE_FUNCTION_HPP
+#define INPLACE_FUNCTION_HPP
+
+#include <cstddef>
+#include <functional>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+template<typename Signature, size_t Capacity = 64>
+class InplaceFunction;
+
+/**
+ * @brief Équivalent de std::function dont l'objet appelé est stocké dans un tampon interne de taille fixe
+ * Jamais d'allocation : un objet trop grand pour le tampon est refusé à la compilation.
+ */
+template<typename R, typename... Args, size_t Capacity>
+class InplaceFunction<R(Args...), Capacity> {
+public:
+	InplaceFunction() noexcept = default;
+
+	template<typename F, typename D = std::decay_t<F>,
+		typename = std::enable_if_t<!std::is_same_v<D, InplaceFunction> && std::is_invocable_r_v<R, D&, Args...>>>
+	InplaceFunction(F&& function) {
+		static_assert(sizeof(D) <= Capacity, "Callable too large for InplaceFunction, increase its capacity");
+		static_assert(alignof(D) <= alignof(std::max_align_t), "Callable over-aligned for InplaceFunction");
+		static_assert(std::is_nothrow_move_constructible_v<D>, "Callable must be nothrow move constructible");
+		new (_storage) D(std::forward<F>(function));
+		_invoke = [](void* storage, Args... args) -> R {
+			return std::invoke(*static_cast<D*>(storage), std::forward<Args>(args)...);
+		};
+		_manage = [](Operation operation, void* destination, void* source) {
+			switch (operation) {
+				case Operation::Copy:	new (destination) D(*static_cast<const D*>(source)); break;
+				case Operation::Move:	new (destination) D(std::move(*static_cast<D*>(source))); break;
+				case Operation::Destroy:static_cast<D*>(destination)->~D(); break;
+			}
+		};
+	}
+
+	InplaceFunction(const InplaceFunction& other) {
+		// Copie d'abord : si elle lève, le tampon n'est jamais détruit
+		if (other._manage) {
+			other._manage(Operation::Copy, _storage, const_cast<unsigned char*>(other._storage));
+			_invoke = other._invoke;
+			_manage = other._manage;
+		}
+	}
+
+	InplaceFunction(InplaceFunction&& other) noexcept : _invoke(other._invoke), _manage(other._manage) {
+		if (_manage) {
+			_manage(Operation::Move, _storage, other._storage);
+		}
+	}
+
+	InplaceFunction& operator=(const InplaceFunction& other) {
+		if (this != &other) {
+			InplaceFunction copy(other);
+			*this = std::move(copy);
+		}
+		return *this;
+	}
+
+	InplaceFunction& operator=(InplaceFunction&& other) noexcept {
+		if (this != &other) {
+			reset();
+			_invoke = other._invoke;
+			_manage = other._manage;
+			if (_manage) {
+				_manage(Operation::Move, _storage, other._storage);
+			}
+		}
+		return *this;
+	}
+
+	~InplaceFunction() {
+		reset();
+	}
+
+	explicit operator bool() const noexcept { return _invoke != nullptr; }
+
+	R operator()(Args... args) const {
+		if (!_invoke) {
+			throw std::bad_function_call();
+		}
+		return _invoke(const_cast<unsigned char*>(_storage), std::forward<Args>(args)...);
+	}
+
+private:
+	enum class Operation { Copy, Move, Destroy };
+
+	void reset() noexcept {
+		if (_manage) {
+			_manage(Operation::Destroy, _storage, nullptr);
+		}
+		_invoke = nullptr;
+		_manage = nullptr;
+	}
+
+	alignas(std::max_align_t) unsigned char _storage[Capacity];
+	R (*_invoke)(void*, Args...) = nullptr;
+	void (*_manage)(Operation, void*, void*) = nullptr;
+};
+
+#endif // INPLACE_FUNCTION_HPP
@@ -2,7 +2,7 @@
 
 Logger *Logger::instance = nullptr;
 
-Logger::Logger() : _minLevel(Debug), _maxLevel(Fatal), _writeInTerminal(false) {
+Logger::Logger() : _minLevel(Debug), _maxLevel(Fatal), _writeInTerminal(false), _msg_level(Info), _msg_line(0) {
 	_file.open(LOG_FILE, std::ios::app);
 	if (!_file.is_open()) {
 		throw std::runtime_error("Unable to open log file");
@@ -63,8 +63,12 @@ void Logger::setMaxLevel(LogLevel level) {
 }
 
 void Logger::write(const std::string &msg) {
+	write(_msg_level, _msg_file, _msg_line, msg);
+}
+
+void Logger::write(LogLevel level, const std::string &file, int line, const std::string &msg) {
 	std::lock_guard<std::mutex> lock(_mutex); // Lock the mutex for the duration of this scope
-	if (_msg_level >= _minLevel && _msg_level <= _maxLevel) {
+	if (level >= _minLevel && level <= _maxLevel) {
 		std::ostringstream ss;
 
 		// time
@@ -74,14 +78,14 @@ void Logger::write(const std::string &msg) {
 		strftime(date, sizeof(date), "%y-%m-%d %H:%M:%S", timeinfo);
 
 		// Logger
-		ss  << "[" << getLabel(_msg_level) << "] " << date << " - " << _msg_file << ":" << _msg_line << " - ";
+		ss  << "[" << getLabel(level) << "] " << date << " - " << file << ":" << line << " - ";
 		ss << msg << std::endl;
 
 		if (_file.is_open()) {
 			_file << ss.str();
 		}
 		if (_writeInTerminal) {
-			std::cerr << getColor(_msg_level) << ss.str() << "\e[0m";
+			std::cerr << getColor(level) << ss.str() << "\e[0m";
 		}
 	}
 }
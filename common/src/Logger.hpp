@@ -60,11 +60,10 @@ public:
 	void write_break_line();
 
 	Buffer_p log(LogLevel level, const std::string &file, int line) {
-		_msg_level = level;
-		_msg_file = file;
-		_msg_line = line;
-		return Buffer_p(new Stream, [&](Stream* st) {
-			write(st->str());
+		// Le niveau, le fichier et la ligne sont capturés par le message et non stockés dans le Logger :
+		// deux threads (ou deux LOG imbriqués) ne peuvent plus s'écraser mutuellement leurs en-têtes
+		return Buffer_p(new Stream, [this, level, file, line](Stream* st) {
+			write(level, file, line, st->str());
 			delete st;  // Explicitly delete the stream to prevent memory leaks
 		});
 	}
@@ -80,6 +79,8 @@ private:
 
 	std::mutex _mutex; // Ajout du mutex pour la synchronisation
 
+	void write(LogLevel level, const std::string &file, int line, const std::string &msg);
+
 	static std::string getLabel(LogLevel type);
 	static std::string getColor(LogLevel type);
 
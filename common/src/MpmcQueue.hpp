@@ -0,0 +1,113 @@
+/**
+ * @file MpmcQueue.hpp
+ * @author ClemtoClem
+ * @date 17/10/2026
+ */
+
+#ifndef MPMC_QUEUE_HPP
+#define MPMC_QUEUE_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+/**
+ * @brief File bornée sans verrou à plusieurs producteurs et plusieurs consommateurs
+ *
+ * Tableau circulaire dont chaque case porte un numéro de séquence (algorithme de D. Vyukov) :
+ * un producteur ou un consommateur réserve une position par compare-exchange puis publie la case
+ * en mettant à jour sa séquence. Aucune allocation après la construction.
+ */
+template<typename T>
+class MpmcQueue {
+public:
+	/**
+	 * @brief Constructeur de MpmcQueue
+	 * @param[in] capacity Nombre de cases, arrondi à la puissance de 2 supérieure (au moins 2)
+	 */
+	explicit MpmcQueue(size_t capacity) {
+		size_t size = 2;
+		while (size < capacity) {
+			size <<= 1;
+		}
+		_mask = size - 1;
+		_cells = std::make_unique<Cell[]>(size);
+		for (size_t i = 0; i < size; ++i) {
+			_cells[i].sequence.store(i, std::memory_order_relaxed);
+		}
+	}
+
+	MpmcQueue(const MpmcQueue&) = delete;
+	MpmcQueue& operator=(const MpmcQueue&) = delete;
+
+	/**
+	 * @brief Ajouter un élément
+	 * @param[in] value Élément à ajouter
+	 * @return true si l'élément a été ajouté, false si la file est pleine
+	 */
+	template<typename U>
+	bool tryPush(U&& value) {
+		size_t pos = _enqueuePos.load(std::memory_order_relaxed);
+		Cell* cell;
+		while (true) {
+			cell = &_cells[pos & _mask];
+			size_t sequence = cell->sequence.load(std::memory_order_acquire);
+			intptr_t diff = static_cast<intptr_t>(sequence) - static_cast<intptr_t>(pos);
+			if (diff == 0) {
+				if (_enqueuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+					break;
+				}
+			} else if (diff < 0) {
+				return false;
+			} else {
+				pos = _enqueuePos.load(std::memory_order_relaxed);
+			}
+		}
+		cell->value = std::forward<U>(value);
+		cell->sequence.store(pos + 1, std::memory_order_release);
+		return true;
+	}
+
+	/**
+	 * @brief Retirer le plus ancien élément
+	 * @param[out] value Élément retiré
+	 * @return true si un élément a été retiré, false si la file est vide
+	 */
+	bool tryPop(T& value) {
+		size_t pos = _dequeuePos.load(std::memory_order_relaxed);
+		Cell* cell;
+		while (true) {
+			cell = &_cells[pos & _mask];
+			size_t sequence = cell->sequence.load(std::memory_order_acquire);
+			intptr_t diff = static_cast<intptr_t>(sequence) - static_cast<intptr_t>(pos + 1);
+			if (diff == 0) {
+				if (_dequeuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+					break;
+				}
+			} else if (diff < 0) {
+				return false;
+			} else {
+				pos = _dequeuePos.load(std::memory_order_relaxed);
+			}
+		}
+		value = std::move(cell->value);
+		cell->sequence.store(pos + _mask + 1, std::memory_order_release);
+		return true;
+	}
+
+	size_t capacity() const noexcept { return _mask + 1; }
+
+private:
+	struct Cell {
+		std::atomic<size_t> sequence;
+		T value;
+	};
+
+	std::unique_ptr<Cell[]> _cells;
+	size_t _mask;
+	alignas(64) std::atomic<size_t> _enqueuePos{0};	///< Séparées sur deux lignes de cache :
+	alignas(64) std::atomic<size_t> _dequeuePos{0};	///< producteurs et consommateurs ne se gênent pas
+};
+
+#endif // MPMC_QUEUE_HPP
@@ -21,23 +21,29 @@ std::string to_string(PluginType type) {
 
 /* ------------------------------------------------------------------------------ */
 
-PluginInterface::PluginInterface(const std::string &name, const std::string &author, const std::string &description, const Version &version, const Version &mainVersion, int priority, PluginType type) noexcept
-	: _info{name, author, description, version, mainVersion, priority, type} {}
+PluginInterface::PluginInterface(const std::string &name, const std::string &author, const std::string &description, const Version &version, const Version &mainVersion, int priority, PluginType type, const std::vector<std::string>& dependencies) noexcept
+	: _info{name, author, description, version, mainVersion, priority, type, dependencies} {}
 
 PluginInterface::PluginInterface(const PluginInfo &info) noexcept : _info(info) {}
 
-void PluginInterface::setInstances(Logger *logger, ResourcesManager *res) noexcept {
+void PluginInterface::setInstances(Logger *logger, ResourcesManager *res, EventBus *events) noexcept {
 	Logger::setInstance(logger);
 	ResourcesManager::setInstance(res);
+	EventBus::setInstance(events);
 }
 
 std::string PluginInterface::getInfoToString() const noexcept {
+	std::string dependencies;
+	for (const auto& dependency : _info.dependencies) {
+		dependencies += (dependencies.empty() ? "" : ", ") + dependency;
+	}
 	return "Plugin Name: '" + _info.name + "'" +
 			", Author: " + _info.author +
 			", Version: " + to_string(_info.version) +
 			", Main Version: " + to_string(_info.mainVersion) +
 			", Priority: " + std::to_string(_info.priority) +
-			", Type: " + to_string(_info.type);
+			", Type: " + to_string(_info.type) +
+			(dependencies.empty() ? "" : ", Dependencies: " + dependencies);
 }
 
 bool PluginInterface::isCompatible(const Version& mainVersion) const noexcept {
@@ -19,10 +19,12 @@
 #include <variant>
 #include <string>
 #include <map>
+#include <vector>
 #include "Logger.hpp"
 #include "CommandsListener.hpp"
 #include "VariablesListener.hpp"
 #include "ResourcesManager.hpp"
+#include "EventBus.hpp"
 #include "VariantType.hpp"
 
 struct Version {
@@ -54,6 +56,7 @@ struct PluginInfo {
 	Version mainVersion;		///< Version du programme principal pour lequel le plugin a été programmé
 	int priority; 				///< Priorité d'initialisation du plugin, le plus propriétaire est celui avec la plus petite priorité
 	PluginType type;			///< Type du plugin
+	std::vector<std::string> dependencies; ///< Noms des plugins qui doivent être initialisés avant celui-ci
 };
 
 /* ------------------------------------------------------------------------------ */
@@ -70,8 +73,10 @@ public:
 	 * @param[in] version Version du plugin
 	 * @param[in] mainVersion Version du programme principal pour lequel le plugin a été programmé
 	 * @param[in] priority Priorité du plugin, le plus propriétaire est celui avec la plus petite priorité
+	 * @param[in] type Type du plugin
+	 * @param[in] dependencies Noms des plugins qui doivent être initialisés avant celui-ci
 	 */
-	PluginInterface(const std::string &name, const std::string &author, const std::string &description, const Version& version, const Version& mainVersion, int priority = 0, PluginType type = PluginType::Default) noexcept;
+	PluginInterface(const std::string &name, const std::string &author, const std::string &description, const Version& version, const Version& mainVersion, int priority = 0, PluginType type = PluginType::Default, const std::vector<std::string>& dependencies = {}) noexcept;
 
 	/**
 	 * @brief Constructeur de PluginInterface
@@ -85,8 +90,9 @@ public:
 	 * @brief Fonction pour définir les instances de Logger pour quelles soient commune entre le programme principal et les différents plugins
 	 * @param[in] logger Instance de Logger du programme principal
 	 * @param[in] res Instance de ResourcesManager du programme principal
+	 * @param[in] events Bus d'événements du programme principal
 	 */
-	virtual void setInstances(Logger* logger, ResourcesManager *res) noexcept;
+	virtual void setInstances(Logger* logger, ResourcesManager *res, EventBus *events) noexcept;
 
 	/**
 	 * @brief Fonction pour initialiser le plugin
@@ -149,12 +155,38 @@ public:
 	 * @return Priorité du plugin
 	 */
 	int getPriority() const noexcept { return _info.priority; }
+
+	/**
+	 * @brief Fonction pour récupérer les dépendances du plugin
+	 * @return Noms des plugins qui doivent être initialisés avant celui-ci
+	 */
+	const std::vector<std::string>& getDependencies() const noexcept { return _info.dependencies; }
 	
 	/**
 	 * @brief Fonction pour vérifier si le plugin est compatible avec le programme principal
 	 * @param[in] mainVersion Version du programme principal
 	 */
 	bool isCompatible(const Version& mainVersion) const noexcept;
+
+protected:
+	/**
+	 * @brief Les commandes pures dépendent des variables du plugin
+	 */
+	uint64_t getStateVersion() const noexcept override { return getVariablesVersion(); }
+
+	/**
+	 * @brief Fonction pour s'abonner à un sujet du bus d'événements
+	 * L'abonnement appartient au plugin : il est supprimé par le programme principal avant la destruction du plugin.
+	 * @param[in] topic Sujet
+	 * @param[in] callback Fonction appelée pour chaque événement, depuis un thread de distribution
+	 * @param[in] policy Comportement quand la file de l'abonné est pleine
+	 * @param[in] capacity Taille de la file de l'abonné
+	 * @return Abonnement, invalide si le sujet n'existe pas
+	 */
+	template<typename T>
+	Subscription subscribe(Topic<T> topic, std::function<void(const T&)> callback, OverflowPolicy policy = OverflowPolicy::Drop, size_t capacity = 1024) {
+		return EventBus::getInstance().subscribe(topic, std::move(callback), policy, capacity, this);
+	}
 };
 
 typedef PluginInterface* create_t();
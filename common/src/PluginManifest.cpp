@@ -0,0 +1,31 @@
+#include <cstring>
+#include "PluginManifest.hpp"
+
+namespace {
+	// Les champs ne sont pas forcément terminés par un zéro quand le texte remplit tout le tableau
+	template<size_t N>
+	std::string fromField(const char (&field)[N]) {
+		return std::string(field, strnlen(field, N));
+	}
+}
+
+PluginInfo toPluginInfo(const PluginManifest& manifest) {
+	PluginInfo info;
+	info.name = fromField(manifest.name);
+	info.author = fromField(manifest.author);
+	info.description = fromField(manifest.description);
+	info.version = manifest.version;
+	info.mainVersion = manifest.mainVersion;
+	info.priority = manifest.priority;
+	info.type = manifest.type;
+	for (const auto& dependency : manifest.dependencies) {
+		if (dependency[0] != '\0') {
+			info.dependencies.push_back(fromField(dependency));
+		}
+	}
+	return info;
+}
+
+bool isValidManifest(const PluginManifest& manifest) noexcept {
+	return manifest.magic == PLUGIN_MANIFEST_MAGIC && manifest.manifestVersion == PLUGIN_MANIFEST_VERSION && manifest.name[0] != '\0';
+}
@@ -0,0 +1,68 @@
+/**
+ * @file PluginManifest.hpp
+ * @author ClemtoClem
+ * @date 17/10/2026
+ */
+
+#ifndef PLUGIN_MANIFEST_HPP
+#define PLUGIN_MANIFEST_HPP
+
+#include <cstdint>
+#include <type_traits>
+#include "PluginInterface.hpp"
+
+#define PLUGIN_MANIFEST_SYMBOL "plugin_manifest"
+
+constexpr uint32_t PLUGIN_MANIFEST_MAGIC = 0x464D4C50; // "PLMF"
+constexpr uint32_t PLUGIN_MANIFEST_VERSION = 1;
+constexpr size_t PLUGIN_MANIFEST_NAME_SIZE = 64;
+constexpr size_t PLUGIN_MANIFEST_TEXT_SIZE = 256;
+constexpr size_t PLUGIN_MANIFEST_MAX_DEPENDENCIES = 8;
+
+/**
+ * @brief Informations du plugin sous forme de données brutes
+ *
+ * Chaque plugin exporte une instance constante de cette structure sous le nom C "plugin_manifest".
+ * Elle ne contient ni pointeur ni constructeur : elle est placée telle quelle dans la section .rodata
+ * de la bibliothèque, et le programme principal peut la lire directement dans le fichier ELF,
+ * sans dlopen et sans exécuter de code du plugin.
+ *
+ * @code
+ * extern "C" constinit const PluginManifest plugin_manifest = {
+ * 	.name = "Plugin1", .author = "ClemtoClem", .description = "...",
+ * 	.version = {1, 0, 0}, .mainVersion = {1, 0, 0}, .priority = 0, .type = PluginType::System, .dependencies = {}
+ * };
+ * const PluginInfo informations = toPluginInfo(plugin_manifest);
+ * @endcode
+ */
+struct PluginManifest {
+	uint32_t magic = PLUGIN_MANIFEST_MAGIC;				///< Signature de la structure
+	uint32_t manifestVersion = PLUGIN_MANIFEST_VERSION;	///< Version du format de la structure
+	char name[PLUGIN_MANIFEST_NAME_SIZE];				///< Nom du plugin
+	char author[PLUGIN_MANIFEST_NAME_SIZE];				///< Auteur du plugin
+	char description[PLUGIN_MANIFEST_TEXT_SIZE];		///< Description du plugin
+	Version version;									///< Version du plugin
+	Version mainVersion;								///< Version du programme principal pour lequel le plugin a été programmé
+	int32_t priority;									///< Priorité d'initialisation du plugin
+	PluginType type;									///< Type du plugin
+	char dependencies[PLUGIN_MANIFEST_MAX_DEPENDENCIES][PLUGIN_MANIFEST_NAME_SIZE]; ///< Noms des plugins requis
+};
+
+static_assert(std::is_standard_layout_v<PluginManifest> && std::is_trivially_copyable_v<PluginManifest>,
+	"PluginManifest must stay plain data to be readable from the ELF file");
+
+/**
+ * @brief Fonction pour convertir un manifeste en informations de plugin
+ * @param[in] manifest Manifeste du plugin
+ * @return Informations du plugin
+ */
+PluginInfo toPluginInfo(const PluginManifest& manifest);
+
+/**
+ * @brief Fonction pour vérifier la signature et la version d'un manifeste
+ * @param[in] manifest Manifeste à vérifier
+ * @return true si le manifeste est utilisable, false sinon
+ */
+bool isValidManifest(const PluginManifest& manifest) noexcept;
+
+#endif // PLUGIN_MANIFEST_HPP
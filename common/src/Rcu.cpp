@@ -0,0 +1,65 @@
+#include <thread>
+#include "Rcu.hpp"
+
+size_t RcuDomain::stripe() noexcept {
+	static std::atomic<size_t> nextStripe{0};
+	thread_local size_t index = nextStripe.fetch_add(1, std::memory_order_relaxed) % NB_STRIPES;
+	return index;
+}
+
+void RcuDomain::synchronize() {
+	std::lock_guard<std::mutex> lock(_syncMutex);
+
+	// Les nouveaux lecteurs passent sur l'autre parité, on attend que l'ancienne se vide.
+	// Deux basculements sont nécessaires : un lecteur qui a lu la parité avant le premier basculement
+	// peut n'incrémenter son compteur qu'après la première attente.
+	for (int flip = 0; flip < 2; ++flip) {
+		size_t parity = _epoch.fetch_add(1) & 1;
+		for (auto& counter : _readers[parity]) {
+			for (size_t spins = 0; counter.value.load() != 0; ++spins) {
+				if (spins > 64) {
+					std::this_thread::yield();
+				}
+			}
+		}
+	}
+}
+
+RcuDomain::~RcuDomain() {
+	// Plus aucun lecteur ne peut exister : pas de période de grâce à attendre
+	release(_retired);
+}
+
+void RcuDomain::retire(void* object, void (*deleter)(void*)) {
+	std::vector<Retired> batch;
+	{
+		std::lock_guard<std::mutex> lock(_retireMutex);
+		_retired.push_back({ object, deleter });
+		if (_retired.size() < RETIRE_BATCH) {
+			return;
+		}
+		batch.swap(_retired);
+	}
+	synchronize();
+	release(batch);
+}
+
+void RcuDomain::reclaim() {
+	std::vector<Retired> batch;
+	{
+		std::lock_guard<std::mutex> lock(_retireMutex);
+		batch.swap(_retired);
+	}
+	if (batch.empty()) {
+		return;
+	}
+	synchronize();
+	release(batch);
+}
+
+void RcuDomain::release(std::vector<Retired>& batch) {
+	for (const Retired& retired : batch) {
+		retired.deleter(retired.object);
+	}
+	batch.clear();
+}
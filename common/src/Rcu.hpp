@@ -0,0 +1,117 @@
+/**
+ * @file Rcu.hpp
+ * @author ClemtoClem
+ * @date 17/10/2026
+ */
+
+#ifndef RCU_HPP
+#define RCU_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <mutex>
+#include <type_traits>
+#include <vector>
+
+/**
+ * @brief Domaine de récupération différée de type RCU
+ *
+ * Les lecteurs entourent leur accès à un pointeur publié par une section de lecture (read()),
+ * qui ne bloque jamais : elle incrémente un compteur réparti sur plusieurs lignes de cache.
+ * Un écrivain publie le nouveau pointeur puis appelle synchronize(), qui attend que toutes
+ * les sections de lecture commencées avant la publication soient terminées : l'ancien objet
+ * peut alors être détruit sans risque.
+ *
+ * Un écrivain qui ne veut pas attendre confie l'ancien objet à retire() : les objets retirés sont détruits
+ * par lots, après une seule période de grâce pour RETIRE_BATCH objets.
+ *
+ * synchronize(), retire() et reclaim() ne doivent jamais être appelées depuis une section de lecture du même domaine.
+ */
+class RcuDomain {
+public:
+	static constexpr size_t NB_STRIPES = 16;
+	static constexpr size_t RETIRE_BATCH = 32;	///< Objets retirés détruits ensemble après une période de grâce
+
+	class ReadGuard {
+	public:
+		ReadGuard(const ReadGuard&) = delete;
+		ReadGuard& operator=(const ReadGuard&) = delete;
+
+		~ReadGuard() {
+			_counter.fetch_sub(1, std::memory_order_release);
+		}
+
+	private:
+		friend class RcuDomain;
+		explicit ReadGuard(std::atomic<size_t>& counter) noexcept : _counter(counter) {}
+
+		std::atomic<size_t>& _counter;
+	};
+
+	RcuDomain() = default;
+	~RcuDomain();
+	RcuDomain(const RcuDomain&) = delete;
+	RcuDomain& operator=(const RcuDomain&) = delete;
+
+	/**
+	 * @brief Ouvrir une section de lecture, fermée à la destruction du garde
+	 * @return Garde de la section de lecture
+	 */
+	[[nodiscard]] ReadGuard read() const noexcept {
+		// seq_cst : l'incrément doit être ordonné avant la lecture du pointeur protégé,
+		// c'est ce qui garantit qu'un lecteur non compté par synchronize() voit la nouvelle valeur
+		std::atomic<size_t>& counter = _readers[_epoch.load() & 1][stripe()].value;
+		counter.fetch_add(1);
+		return ReadGuard(counter);
+	}
+
+	/**
+	 * @brief Attendre la fin des sections de lecture commencées avant l'appel
+	 */
+	void synchronize();
+
+	/**
+	 * @brief Différer la destruction d'un objet qui n'est plus publié
+	 * L'appelant qui complète un lot attend la période de grâce et détruit tout le lot.
+	 * @param[in] object Objet retiré
+	 * @param[in] deleter Fonction de destruction
+	 */
+	void retire(void* object, void (*deleter)(void*));
+
+	template<typename T>
+	void retire(T* object) {
+		retire(const_cast<std::remove_const_t<T>*>(object), [](void* pointer) { delete static_cast<T*>(pointer); });
+	}
+
+	/**
+	 * @brief Détruire tous les objets retirés, après une période de grâce
+	 */
+	void reclaim();
+
+	/**
+	 * @brief Compteur de basculements, incrémenté deux fois par période de grâce
+	 */
+	size_t epoch() const noexcept { return _epoch.load(std::memory_order_relaxed); }
+
+private:
+	struct alignas(64) Counter {
+		std::atomic<size_t> value{0};
+	};
+
+	struct Retired {
+		void* object;
+		void (*deleter)(void*);
+	};
+
+	mutable Counter _readers[2][NB_STRIPES];
+	std::atomic<size_t> _epoch{0};
+	std::mutex _syncMutex;
+	std::mutex _retireMutex;
+	std::vector<Retired> _retired;	///< Objets en attente de destruction (sous _retireMutex)
+
+	void release(std::vector<Retired>& batch);
+
+	static size_t stripe() noexcept;
+};
+
+#endif // RCU_HPP
@@ -0,0 +1,33 @@
+/**
+ * @file StringHash.hpp
+ * @author ClemtoClem
+ * @date 17/10/2026
+ */
+
+#ifndef STRING_HASH_HPP
+#define STRING_HASH_HPP
+
+#include <functional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+/**
+ * @brief Fonction de hachage transparente pour les chaînes
+ * Permet de chercher dans une StringMap avec un std::string_view ou un const char* sans construire de std::string.
+ */
+struct StringHash {
+	using is_transparent = void;
+
+	size_t operator()(std::string_view str) const noexcept {
+		return std::hash<std::string_view>{}(str);
+	}
+};
+
+/**
+ * @brief Table de hachage indexée par des chaînes, avec recherche hétérogène
+ */
+template<typename T>
+using StringMap = std::unordered_map<std::string, T, StringHash, std::equal_to<>>;
+
+#endif // STRING_HASH_HPP
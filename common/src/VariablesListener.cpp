@@ -1,71 +1,809 @@
+#include <algorithm>
+#include <array>
+#include <unordered_set>
+#include <utility>
 #include "VariablesListener.hpp"
+#include "CommandSignature.hpp"
 #include "Logger.hpp"
 
+namespace {
+	/**
+	 * @brief Affecter une valeur à une variable en gardant le type de la variable
+	 * @param[in,out] target Valeur de la variable
+	 * @param[in] value Nouvelle valeur, du même type ou convertible sans perte (int32_t -> int64_t, float -> double...)
+	 * @return true si la valeur a été affectée, false si son type ne convient pas
+	 */
+	bool assignSameType(VariantType& target, const VariantType& value) {
+		if (target.index() == value.index()) {
+			target = value;	// Même alternative : affectation sur place, une chaîne réutilise sa mémoire
+			return true;
+		}
+		return std::visit([&](auto& current) {
+			using To = std::decay_t<decltype(current)>;
+			if constexpr (std::is_arithmetic_v<To> && !std::is_same_v<To, bool>) {
+				if ((LosslessSources<To>::value >> value.index()) & 1) {
+					current = argumentAs<To>(value);
+					return true;
+				}
+			}
+			return false;
+		}, target);
+	}
+}
+
 VariablesListener::VariablesListener() = default;
-VariablesListener::~VariablesListener() = default;
+
+VariablesListener::~VariablesListener() {
+	// Les notifications différées en cours utilisent encore cet objet
+	unobserveAll();
+	for (const auto& var : _variables) {
+		unlink(*var, true);
+		delete var->text.load(std::memory_order_relaxed);
+	}
+}
+
+void VariablesListener::enableConcurrentAccess() {
+	if (_concurrent) {
+		return;
+	}
+	_rcu = std::make_unique<RcuDomain>();
+	_concurrent = true;
+	for (const auto& var : _variables) {
+		publish(*var);
+	}
+}
+
+void VariablesListener::publish(VariableInfo& var) const {
+	std::visit([&](const auto& value) {
+		using T = std::decay_t<decltype(value)>;
+		if constexpr (std::is_same_v<T, std::string>) {
+			const std::string* old = var.text.exchange(new std::string(value), std::memory_order_acq_rel);
+			if (old) {
+				// Des lecteurs copient peut-être encore l'ancienne chaîne : libérée avec un lot d'autres, après une période de grâce
+				_rcu->retire(old);
+			}
+		} else {
+			var.bits.store(pack(value), std::memory_order_release);
+		}
+	}, var.value);
+}
+
+VariantType VariablesListener::load(const VariableInfo& var) const {
+	if (!_concurrent) {
+		return var.value;
+	}
+	// Le type d'une variable ne change jamais : seul le contenu est lu de façon atomique
+	static constexpr auto loaders = []<typename... Ts>(std::variant<Ts...>*) {
+		return std::array<VariantType (*)(const VariablesListener&, const VariableInfo&), sizeof...(Ts)>{
+			[](const VariablesListener& listener, const VariableInfo& variable) -> VariantType { return listener.loadAs<Ts>(variable); }...
+		};
+	}(static_cast<VariantType*>(nullptr));
+	return loaders[var.type](*this, var);
+}
 
 bool VariablesListener::addVariable(const std::string& variable_name, const std::string& description, const VariantType& value) {
 	if (isVariable(variable_name)) {
 		return false; // La variable existe déjà
 	}
-	_variables.push_back({variable_name, description, value});
+	auto var = std::make_unique<VariableInfo>();
+	var->name = variable_name;
+	var->description = description;
+	var->value = value;
+	var->type = value.index();
+	var->position = _variables.size();
+	_variables.push_back(std::move(var));
+	_index.emplace(variable_name, _variables.back().get());
+	if (_concurrent) {
+		publish(*_variables.back());
+	}
+	_version.fetch_add(1, std::memory_order_release);
+	_listVersion.fetch_add(1, std::memory_order_release);
 	return true;
 }
 
 bool VariablesListener::removeVariable(const std::string &variable_name) {
-	auto it = std::remove_if(_variables.begin(), _variables.end(), [&](const VariableInfo& var) {
-		return var.name == variable_name;
-	});
-	if (it != _variables.end()) {
-		_variables.erase(it, _variables.end());
-		return true;
+	auto it = _index.find(variable_name);
+	if (it == _index.end()) {
+		return false;
 	}
-	return false;
+	VariableInfo* var = it->second;
+	_index.erase(it);
+	unlink(*var, false);
+	delete var->text.load(std::memory_order_relaxed);
+	const size_t position = var->position;
+	_variables.erase(_variables.begin() + position);
+	for (size_t i = position; i < _variables.size(); ++i) {
+		_variables[i]->position = i;
+	}
+	_version.fetch_add(1, std::memory_order_release);
+	_listVersion.fetch_add(1, std::memory_order_release);
+	return true;
+}
+
+VariableInfo* VariablesListener::findVariable(std::string_view variable_name) const noexcept {
+	auto it = _index.find(variable_name);
+	return it != _index.end() ? it->second : nullptr;
+}
+
+VariableInfo* VariablesListener::findVariable(std::string_view variable_name, const VariableInfo* previous) const noexcept {
+	// Des noms donnés dans l'ordre de déclaration se suivent : comparer le suivant coûte moins que hacher
+	if (previous) {
+		const size_t next = previous->position + 1;
+		if (next < _variables.size() && _variables[next]->name == variable_name) {
+			return _variables[next].get();
+		}
+	}
+	return findVariable(variable_name);
 }
 
 bool VariablesListener::setVariable(const std::string& variable_name, const VariantType& value) {
-	for (auto& var : _variables) {
-		if (var.name == variable_name) {
-			var.value = value;
-			return true;
+	VariableInfo* var = findVariable(variable_name);
+	return var && assign(*var, value);
+}
+
+bool VariablesListener::assign(VariableInfo& var, const VariantType& value) {
+	if (var.derivation) {
+		LOG(Error) << "Variable '" << var.name << "' is derived from other variables, it cannot be set";
+		return false;
+	}
+	if (_concurrent) {
+		const bool observed = _nbObservers.load(std::memory_order_acquire) != 0;
+		VariableChange change;
+		{
+			std::lock_guard<std::mutex> lock(_writeMutex);
+			if (observed) {
+				change.oldValue = var.value;
+			}
+			if (!assignSameType(var.value, value)) {
+				LOG(Error) << "Variable '" << var.name << "' is " << VariantTypeName(var.value) << ", cannot set it to " << VariantTypeName(value);
+				return false;
+			}
+			publish(var);
+			_version.fetch_add(1, std::memory_order_release);
+			if (observed) {
+				change.newValue = var.value;
+			}
+		}
+		invalidate(var);
+		// Hors du verrou : un observateur synchrone peut modifier d'autres variables
+		if (observed && change.oldValue != change.newValue) {
+			change.name = var.name;
+			notify({ &change, 1 });
 		}
+		return true;
 	}
-	return false;
+	if (_nbObservers.load(std::memory_order_acquire) == 0) {
+		if (!assignSameType(var.value, value)) {
+			LOG(Error) << "Variable '" << var.name << "' is " << VariantTypeName(var.value) << ", cannot set it to " << VariantTypeName(value);
+			return false;
+		}
+		_version.fetch_add(1, std::memory_order_release);
+		invalidate(var);
+		return true;
+	}
+	VariableChange change{ var.name, var.value, {} };
+	if (!assignSameType(var.value, value)) {
+		LOG(Error) << "Variable '" << var.name << "' is " << VariantTypeName(var.value) << ", cannot set it to " << VariantTypeName(value);
+		return false;
+	}
+	_version.fetch_add(1, std::memory_order_release);
+	invalidate(var);
+	if (change.oldValue != var.value) {
+		change.newValue = var.value;
+		notify({ &change, 1 });
+	}
+	return true;
+}
+
+bool VariablesListener::setVariables(const std::vector<std::pair<std::string, VariantType>>& values) {
+	PreparedVariables prepared;
+	std::string error;
+	if (!prepareVariables(values, prepared, error)) {
+		LOG(Error) << "Variables not modified: " << error;
+		return false;
+	}
+	applyVariables(prepared);
+	notifyVariables(prepared);
+	return true;
+}
+
+template<typename Values, typename Resolve>
+bool VariablesListener::prepare(Values&& values, Resolve resolve, PreparedVariables& prepared, std::string& error) {
+	// Des valeurs passées par rvalue sont déplacées : une chaîne n'est pas copiée une seconde fois
+	constexpr bool movable = !std::is_const_v<std::remove_reference_t<Values>>;
+	// Les modifications déjà préparées sont réutilisées : une chaîne garde sa mémoire d'une préparation à l'autre
+	prepared.release();
+	prepared._changes.resize(values.size());
+	prepared._variables.resize(values.size());
+
+	// En mode concurrent, le verrou est gardé jusqu'à applyVariables : validateVariables voit les valeurs qui seront remplacées
+	std::unique_lock<std::mutex> lock(_writeMutex, std::defer_lock);
+	if (_concurrent) {
+		lock.lock();
+	}
+	// Sans vérification, l'ancienne valeur n'est connue qu'à l'application
+	const bool validate = _validation;
+	for (size_t i = 0; i < values.size(); ++i) {
+		auto& [key, value] = values[i];
+		VariableInfo* var = resolve(key, error);
+		if (!var) {
+			return false;
+		}
+		const std::string& name = var->name;
+		if (var->derivation) {
+			error = "variable '" + name + "' is derived from other variables";
+			return false;
+		}
+		VariableChange& change = prepared._changes[i];
+		change.name = name;
+		if (validate) {
+			change.oldValue = var->value;
+		}
+		if (value.index() == var->type) {
+			if constexpr (movable) {
+				change.newValue = std::move(value);
+			} else {
+				change.newValue = value;
+			}
+		} else {
+			change.newValue = var->value;
+			if (!assignSameType(change.newValue, value)) {
+				error = "variable '" + name + "' is " + VariantTypeName(var->value) + ", cannot set it to " + VariantTypeName(value);
+				return false;
+			}
+		}
+		prepared._variables[i] = var;
+	}
+
+	if (validate) {
+		try {
+			if (!validateVariables(prepared._changes, error)) {
+				if (error.empty()) {
+					error = "rejected";
+				}
+				return false;
+			}
+		} catch (const std::exception& e) {
+			error = e.what();
+			return false;
+		}
+	}
+	prepared._lock = std::move(lock);
+	return true;
+}
+
+bool VariablesListener::prepareVariables(const std::vector<std::pair<std::string, VariantType>>& values, PreparedVariables& prepared, std::string& error) {
+	return prepare(values, [this](const std::string& name, std::string& error) {
+		VariableInfo* var = findVariable(name);
+		if (!var) {
+			error = "variable '" + name + "' not found";
+		}
+		return var;
+	}, prepared, error);
+}
+
+bool VariablesListener::prepareVariables(const std::vector<std::pair<VariableHandle<>, VariantType>>& values, PreparedVariables& prepared, std::string& error) {
+	return prepare(values, [this](const VariableHandle<>& handle, std::string& error) { return resolveHandle(handle, error); }, prepared, error);
+}
+
+bool VariablesListener::prepareVariables(std::vector<std::pair<VariableHandle<>, VariantType>>&& values, PreparedVariables& prepared, std::string& error) {
+	return prepare(values, [this](const VariableHandle<>& handle, std::string& error) { return resolveHandle(handle, error); }, prepared, error);
+}
+
+VariableInfo* VariablesListener::resolveHandle(const VariableHandle<>& handle, std::string& error) const {
+	if (!handle.ok() || handle._owner != this) {
+		error = "invalid variable handle";
+		return nullptr;
+	}
+	return handle._variable;
+}
+
+void VariablesListener::applyVariables(PreparedVariables& prepared) {
+	{
+		std::unique_lock<std::mutex> lock = std::move(prepared._lock);
+		if (_concurrent && !lock.owns_lock()) {
+			lock = std::unique_lock<std::mutex>(_writeMutex);
+		}
+		for (size_t i = 0; i < prepared._changes.size(); ++i) {
+			VariableInfo& var = *prepared._variables[i];
+			VariableChange& change = prepared._changes[i];
+			// Même type que la variable (vérifié par prepareVariables) : échange puis copie sur place, sans allocation.
+			// L'ancienne valeur est celle du moment de l'application.
+			change.oldValue.swap(var.value);
+			var.value = change.newValue;
+			if (_concurrent) {
+				publish(var);
+			}
+		}
+		_version.fetch_add(1, std::memory_order_release);
+	}
+	for (VariableInfo* var : prepared._variables) {
+		invalidate(*var);
+	}
+}
+
+void VariablesListener::notifyVariables(PreparedVariables& prepared) {
+	size_t kept = 0;
+	for (size_t i = 0; i < prepared._changes.size(); ++i) {
+		if (prepared._changes[i].oldValue != prepared._changes[i].newValue) {
+			if (kept != i) {
+				prepared._changes[kept] = std::move(prepared._changes[i]);
+				prepared._variables[kept] = prepared._variables[i];
+			}
+			++kept;
+		}
+	}
+	prepared._changes.resize(kept);
+	prepared._variables.resize(kept);
+	if (prepared._changes.empty()) {
+		return;
+	}
+
+	if (_nbObservers.load(std::memory_order_acquire) != 0) {
+		notify(prepared._changes);
+	}
+	try {
+		variablesCommitted(prepared._changes);
+	} catch (const std::exception& e) {
+		LOG(Error) << "Notification of " << prepared._changes.size() << " modified variables failed: " << e.what();
+	}
+}
+
+VariableObserver VariablesListener::observeVariable(const std::string& variable_name, VariableCallback callback,
+	NotificationMode mode, CommandExecutor* executor)
+{
+	if (!variable_name.empty() && !isVariable(variable_name)) {
+		LOG(Error) << "Cannot observe variable '" << variable_name << "': it does not exist";
+		return {};
+	}
+	if (!variable_name.empty() && isDerivedVariable(variable_name)) {
+		LOG(Error) << "Cannot observe variable '" << variable_name << "': it is derived, its value is only computed when read";
+		return {};
+	}
+	if (mode == NotificationMode::Deferred && !executor) {
+		LOG(Error) << "Cannot observe variable '" << variable_name << "': deferred notifications need an executor";
+		return {};
+	}
+	auto observer = std::make_shared<Observer>();
+	observer->variable = variable_name;
+	observer->callback = std::move(callback);
+	observer->mode = mode;
+	observer->executor = executor;
+	return addObserver(std::move(observer));
+}
+
+VariableObserver VariablesListener::observeVariables(VariablesCallback callback, NotificationMode mode, CommandExecutor* executor) {
+	if (mode == NotificationMode::Deferred && !executor) {
+		LOG(Error) << "Cannot observe variables: deferred notifications need an executor";
+		return {};
+	}
+	auto observer = std::make_shared<Observer>();
+	observer->grouped = std::move(callback);
+	observer->mode = mode;
+	observer->executor = executor;
+	return addObserver(std::move(observer));
+}
+
+VariableObserver VariablesListener::addObserver(std::shared_ptr<Observer> observer) {
+	std::lock_guard<std::mutex> lock(_observersMutex);
+	observer->id = _nextObserver++;
+	_observers.push_back(std::move(observer));
+	_nbObservers.store(_observers.size(), std::memory_order_release);
+	return VariableObserver{ _observers.back()->id };
+}
+
+bool VariablesListener::unobserveVariable(VariableObserver observer) {
+	std::lock_guard<std::mutex> lock(_observersMutex);
+	auto it = std::find_if(_observers.begin(), _observers.end(), [&](const auto& o) { return o->id == observer.id; });
+	if (it == _observers.end()) {
+		return false;
+	}
+	(*it)->active.store(false, std::memory_order_relaxed);
+	_observers.erase(it);
+	_nbObservers.store(_observers.size(), std::memory_order_release);
+	return true;
+}
+
+size_t VariablesListener::unobserveAll() {
+	std::unique_lock<std::mutex> lock(_observersMutex);
+	size_t removed = _observers.size();
+	for (const auto& observer : _observers) {
+		observer->active.store(false, std::memory_order_relaxed);
+	}
+	_observers.clear();
+	_nbObservers.store(0, std::memory_order_release);
+	_idle.wait(lock, [this]() { return _inFlight == 0; });
+	return removed;
+}
+
+void VariablesListener::notify(std::span<const VariableChange> changes) {
+	// Une seule copie de la liste pour toutes les modifications : les fonctions appelées peuvent ajouter ou supprimer des observateurs
+	std::vector<std::shared_ptr<Observer>> observers;
+	{
+		std::lock_guard<std::mutex> lock(_observersMutex);
+		observers = _observers;
+	}
+	auto observes = [](const Observer& observer, const VariableChange& change) {
+		return observer.variable.empty() || observer.variable == change.name;
+	};
+
+	for (auto& observer : observers) {
+		if (!observer->active.load(std::memory_order_relaxed)) {
+			continue;
+		}
+		if (observer->mode == NotificationMode::Synchronous) {
+			if (observer->grouped) {
+				try {
+					observer->grouped(changes);
+				} catch (const std::exception& e) {
+					LOG(Error) << "Observer of " << changes.size() << " modified variables failed: " << e.what();
+				}
+				continue;
+			}
+			for (const VariableChange& change : changes) {
+				if (!observes(*observer, change)) {
+					continue;
+				}
+				try {
+					observer->callback(change);
+				} catch (const std::exception& e) {
+					LOG(Error) << "Observer of variable '" << change.name << "' failed: " << e.what();
+				}
+			}
+			continue;
+		}
+
+		// Toutes les modifications sont fusionnées sous un seul verrou, une seule notification est planifiée
+		bool schedule = false;
+		{
+			std::lock_guard<std::mutex> lock(observer->mutex);
+			const bool merge = !observer->pending.empty();
+			bool observed = false;
+			for (const VariableChange& change : changes) {
+				if (!observes(*observer, change)) {
+					continue;
+				}
+				observed = true;
+				auto pending = !merge ? observer->pending.end() : std::find_if(observer->pending.begin(), observer->pending.end(),
+					[&](const VariableChange& other) { return other.name == change.name; });
+				if (pending != observer->pending.end()) {
+					pending->newValue = change.newValue;	// Fusionnée : l'ancienne valeur reste celle d'avant la première modification
+				} else {
+					observer->pending.push_back(change);
+				}
+			}
+			if (observed) {
+				schedule = !observer->scheduled;
+				observer->scheduled = true;
+			}
+		}
+		if (schedule) {
+			{
+				std::lock_guard<std::mutex> lock(_observersMutex);
+				++_inFlight;
+			}
+			try {
+				observer->executor->submit([this, observer]() mutable { deliver(std::move(observer)); });
+			} catch (...) {
+				// Tâche refusée : livrée ici, sinon _inFlight ne redescendrait jamais et unobserveAll attendrait indéfiniment
+				LOG(Warning) << "Deferred notification of " << changes.size() << " modified variables could not be queued, delivered synchronously";
+				deliver(std::move(observer));
+			}
+		}
+	}
+}
+
+void VariablesListener::deliver(std::shared_ptr<Observer> observer) {
+	std::vector<VariableChange> changes;
+	{
+		std::lock_guard<std::mutex> lock(observer->mutex);
+		changes.swap(observer->pending);
+		observer->scheduled = false;
+	}
+	// Des modifications qui se sont annulées ne sont pas transmises
+	std::erase_if(changes, [](const VariableChange& change) { return change.oldValue == change.newValue; });
+	if (observer->grouped) {
+		if (!changes.empty() && observer->active.load(std::memory_order_relaxed)) {
+			try {
+				observer->grouped(changes);
+			} catch (const std::exception& e) {
+				LOG(Error) << "Observer of " << changes.size() << " modified variables failed: " << e.what();
+			}
+		}
+		changes.clear();
+	}
+	for (const VariableChange& change : changes) {
+		if (!observer->active.load(std::memory_order_relaxed)) {
+			continue;
+		}
+		try {
+			observer->callback(change);
+		} catch (const std::exception& e) {
+			LOG(Error) << "Observer of variable '" << change.name << "' failed: " << e.what();
+		}
+	}
+	observer.reset();
+
+	std::lock_guard<std::mutex> lock(_observersMutex);
+	--_inFlight;
+	_idle.notify_all();
 }
 
 VariantType VariablesListener::getVariable(const std::string& variable_name) const {
-	for (const auto& var : _variables) {
-		if (var.name == variable_name) {
-			return var.value;
+	if (VariableInfo* var = findVariable(variable_name)) {
+		if (var->derivation) {
+			refresh(*var);
 		}
+		return load(*var);
 	}
 	throw VariableNotFoundException(variable_name);
 }
 
 bool VariablesListener::isVariable(const std::string& variable_name) const {
-	for (const auto& var : _variables) {
-		if (var.name == variable_name) {
+	return _index.contains(variable_name);
+}
+
+bool VariablesListener::addDerivedVariable(const std::string& variable_name, const std::string& description,
+	const std::vector<VariableSource>& inputs, DerivedFunction function)
+{
+	if (isVariable(variable_name)) {
+		return false; // La variable existe déjà
+	}
+	// Une nouvelle variable n'a encore aucune variable dérivée : elle ne peut pas fermer un cycle
+	auto derivation = std::make_unique<VariableDerivation>();
+	std::string error;
+	if (!resolveInputs(inputs, derivation->inputs, error)) {
+		LOG(Error) << "Cannot define derived variable '" << variable_name << "': " << error;
+		return false;
+	}
+	// Premier calcul : donne son type à la variable
+	VariantType value;
+	if (!evaluate(variable_name, function, derivation->inputs, value)) {
+		return false;
+	}
+	derivation->function = std::move(function);
+	addVariable(variable_name, description, value);
+
+	VariableInfo& var = *_variables.back();
+	var.derivation = std::move(derivation);
+	for (const VariableLink& input : var.derivation->inputs) {
+		addDependent(*input.variable, { this, &var });
+	}
+	return true;
+}
+
+bool VariablesListener::redefineVariable(const std::string& variable_name, const std::vector<VariableSource>& inputs, DerivedFunction function) {
+	VariableInfo* var = findVariable(variable_name);
+	if (!var || !var->derivation) {
+		LOG(Error) << "Cannot redefine variable '" << variable_name << "': it is not a derived variable";
+		return false;
+	}
+	std::vector<VariableLink> links;
+	std::string error;
+	if (!resolveInputs(inputs, links, error)) {
+		LOG(Error) << "Cannot redefine variable '" << variable_name << "': " << error;
+		return false;
+	}
+	for (const VariableLink& input : links) {
+		if (dependsOn(*input.variable, *var)) {
+			LOG(Error) << "Cannot redefine variable '" << variable_name << "': input '" << input.variable->name << "' depends on it (cycle)";
+			return false;
+		}
+	}
+	VariantType value;
+	if (!evaluate(variable_name, function, links, value)) {
+		return false;
+	}
+	VariantType current = load(*var);
+	if (!assignSameType(current, value)) {
+		LOG(Error) << "Cannot redefine variable '" << variable_name << "': it is " << VariantTypeName(current) << ", the new function returns " << VariantTypeName(value);
+		return false;
+	}
+
+	// Les nouvelles entrées la préviennent avant le remplacement : une modification pendant celui-ci la marque à recalculer
+	for (const VariableLink& input : links) {
+		addDependent(*input.variable, { this, var });
+	}
+	std::vector<VariableLink> previous;
+	{
+		std::lock_guard<std::mutex> definition(var->derivation->mutex);
+		previous = std::exchange(var->derivation->inputs, std::move(links));
+		var->derivation->function = std::move(function);
+		std::unique_lock<std::mutex> lock(_writeMutex, std::defer_lock);
+		if (_concurrent) {
+			lock.lock();
+		}
+		var->value = std::move(current);
+		if (_concurrent) {
+			publish(*var);
+		}
+	}
+	for (const VariableLink& input : previous) {
+		if (input.variable) {
+			removeDependent(*input.variable, *var);
+		}
+	}
+	_version.fetch_add(1, std::memory_order_release);
+	invalidate(*var);
+	return true;
+}
+
+bool VariablesListener::isDerivedVariable(const std::string& variable_name) const {
+	const VariableInfo* var = findVariable(variable_name);
+	return var && var->derivation;
+}
+
+bool VariablesListener::hasExternalDependents() const noexcept {
+	return std::any_of(_variables.begin(), _variables.end(), [this](const auto& var) {
+		std::lock_guard<std::mutex> lock(var->dependentsMutex);
+		return std::any_of(var->dependents.begin(), var->dependents.end(), [this](const VariableLink& link) { return link.owner != this; });
+	});
+}
+
+bool VariablesListener::resolveInputs(const std::vector<VariableSource>& sources, std::vector<VariableLink>& inputs, std::string& error) {
+	inputs.clear();
+	inputs.reserve(sources.size());
+	for (const VariableSource& source : sources) {
+		VariablesListener* owner = source.owner ? source.owner : this;
+		VariableInfo* input = owner->findVariable(source.name);
+		if (!input) {
+			error = "input '" + source.name + "' not found";
+			return false;
+		}
+		inputs.push_back({ owner, input });
+	}
+	return true;
+}
+
+bool VariablesListener::evaluate(const std::string& variable_name, const DerivedFunction& function, const std::vector<VariableLink>& inputs, VariantType& result) {
+	std::vector<VariantType> arguments;
+	arguments.reserve(inputs.size());
+	for (const VariableLink& input : inputs) {
+		if (!input.variable) {
+			return false;	// Entrée supprimée, signalée par unlink() : la variable garde sa dernière valeur
+		}
+		if (input.variable->derivation) {
+			input.owner->refresh(*input.variable);
+		}
+		arguments.push_back(input.owner->load(*input.variable));
+	}
+	try {
+		result = function(arguments);
+		return true;
+	} catch (const std::exception& e) {
+		LOG(Error) << "Derived variable '" << variable_name << "' failed: " << e.what();
+		return false;
+	}
+}
+
+void VariablesListener::addDependent(VariableInfo& input, VariableLink dependent) {
+	std::lock_guard<std::mutex> lock(input.dependentsMutex);
+	input.dependents.push_back(dependent);
+	input.hasDependents.store(true, std::memory_order_release);
+}
+
+void VariablesListener::removeDependent(VariableInfo& input, const VariableInfo& dependent) {
+	// Un seul lien par appel, comme addDependent : une entrée présente deux fois, ou reliée aussi par une nouvelle définition, garde l'autre
+	std::lock_guard<std::mutex> lock(input.dependentsMutex);
+	auto link = std::find_if(input.dependents.begin(), input.dependents.end(), [&](const VariableLink& other) { return other.variable == &dependent; });
+	if (link != input.dependents.end()) {
+		input.dependents.erase(link);
+	}
+	input.hasDependents.store(!input.dependents.empty(), std::memory_order_release);
+}
+
+bool VariablesListener::dependsOn(const VariableInfo& var, const VariableInfo& target) {
+	// Parcours en profondeur des entrées ; visited évite de reparcourir les losanges du graphe
+	std::unordered_set<const VariableInfo*> visited;
+	std::vector<const VariableInfo*> stack{ &var };
+	while (!stack.empty()) {
+		const VariableInfo* current = stack.back();
+		stack.pop_back();
+		if (current == &target) {
 			return true;
 		}
+		if (!current->derivation || !visited.insert(current).second) {
+			continue;
+		}
+		std::lock_guard<std::mutex> lock(current->derivation->mutex);
+		for (const VariableLink& input : current->derivation->inputs) {
+			if (input.variable) {
+				stack.push_back(input.variable);
+			}
+		}
 	}
 	return false;
 }
 
+void VariablesListener::invalidate(VariableInfo& var) {
+	if (!var.hasDependents.load(std::memory_order_acquire)) {
+		return;
+	}
+	// Verrous pris dans le sens du graphe, qui n'a pas de cycle : une variable dérivée détruite attend la fin du parcours
+	std::lock_guard<std::mutex> lock(var.dependentsMutex);
+	for (const VariableLink& dependent : var.dependents) {
+		// Déjà marquée : celles qui en dérivent l'ont été en même temps
+		if (!dependent.variable->derivation->dirty.exchange(true, std::memory_order_acq_rel)) {
+			dependent.owner->_version.fetch_add(1, std::memory_order_release);
+			dependent.owner->invalidate(*dependent.variable);
+		}
+	}
+}
+
+void VariablesListener::refresh(VariableInfo& var) const {
+	VariableDerivation& derivation = *var.derivation;
+	if (!derivation.dirty.load(std::memory_order_acquire)) {
+		return;
+	}
+	// Un seul calcul à la fois : la définition ne change pas pendant le calcul, un calcul plus ancien n'écrase pas un plus récent
+	std::lock_guard<std::mutex> definition(derivation.mutex);
+	// Effacé avant de lire les entrées : une modification pendant le calcul marque de nouveau la variable
+	if (!derivation.dirty.exchange(false, std::memory_order_acq_rel)) {
+		return;
+	}
+	VariantType result;
+	if (!evaluate(var.name, derivation.function, derivation.inputs, result)) {
+		return;
+	}
+
+	std::unique_lock<std::mutex> lock(_writeMutex, std::defer_lock);
+	if (_concurrent) {
+		lock.lock();
+	}
+	if (!assignSameType(var.value, result)) {
+		LOG(Error) << "Derived variable '" << var.name << "' is " << VariantTypeName(var.value) << ", its function returned " << VariantTypeName(result);
+		return;
+	}
+	if (_concurrent) {
+		publish(var);
+	}
+}
+
+void VariablesListener::unlink(VariableInfo& var, bool externalOnly) {
+	// Ses entrées ne la préviennent plus. Deux objets liés ne sont jamais détruits en même temps (le gestionnaire
+	// de plugins les détruit un par un) : les entrées copiées existent encore.
+	if (var.derivation) {
+		std::vector<VariableLink> inputs;
+		{
+			std::lock_guard<std::mutex> lock(var.derivation->mutex);
+			inputs = var.derivation->inputs;
+		}
+		for (const VariableLink& input : inputs) {
+			if (input.variable && !(externalOnly && input.owner == this)) {
+				removeDependent(*input.variable, var);
+			}
+		}
+	}
+	// Les variables dérivées qui l'utilisent gardent leur dernière valeur, jusqu'à une éventuelle redéfinition
+	std::lock_guard<std::mutex> lock(var.dependentsMutex);
+	for (const VariableLink& dependent : var.dependents) {
+		if (externalOnly && dependent.owner == this) {
+			continue;
+		}
+		{
+			std::lock_guard<std::mutex> definition(dependent.variable->derivation->mutex);
+			for (VariableLink& input : dependent.variable->derivation->inputs) {
+				if (input.variable == &var) {
+					input.variable = nullptr;
+				}
+			}
+		}
+		LOG(Warning) << "Derived variable '" << dependent.variable->name << "' lost its input '" << var.name << "', it keeps its last value";
+	}
+}
+
 std::vector<std::string> VariablesListener::getVariables() const {
-	LOG(Debug) << "VariablesListener::getVariables()";
 	std::vector<std::string> variable_names;
+	variable_names.reserve(_variables.size());
 	for (const auto& var : _variables) {
-		variable_names.push_back(var.name);
-		LOG(Debug) << "Variable: " << var.name << " - " << VariantToString(var.value);
+		variable_names.push_back(var->name);
 	}
 	return variable_names;
 }
 
 const std::string& VariablesListener::getDescription(const std::string& variable_name) const {
-	for (const auto& var : _variables) {
-		if (var.name == variable_name) {
-			return var.description;
-		}
+	if (const VariableInfo* var = findVariable(variable_name)) {
+		return var->description;
 	}
 	throw VariableNotFoundException(variable_name);
 }
@@ -13,17 +13,77 @@
 #ifndef VARIABLES_LISTENER_HPP
 #define VARIABLES_LISTENER_HPP
 
+#include <atomic>
+#include <condition_variable>
+#include <cstring>
 #include <string>
 #include <vector>
 #include <functional>
 #include <memory>
+#include <mutex>
+#include <span>
 #include <stdexcept>
+#include <string_view>
+#include "CommandExecutor.hpp"
+#include "Rcu.hpp"
+#include "StringHash.hpp"
 #include "VariantType.hpp"
 
+class VariablesListener;
+struct VariableInfo;
+
+/**
+ * @brief Fonction d'une variable dérivée
+ * Reçoit les valeurs des entrées dans l'ordre de leur déclaration et retourne la valeur de la variable.
+ */
+using DerivedFunction = std::function<VariantType(const std::vector<VariantType>& inputs)>;
+
+/**
+ * @brief Entrée d'une variable dérivée : une variable du même objet ou d'un autre (d'un autre plugin par exemple)
+ */
+struct VariableSource {
+	VariablesListener* owner = nullptr;	///< Objet qui possède la variable, nullptr pour celui de la variable dérivée
+	std::string name;
+
+	VariableSource(const char* name) : name(name) {}
+	VariableSource(std::string name) : name(std::move(name)) {}
+	VariableSource(VariablesListener& owner, std::string name) : owner(&owner), name(std::move(name)) {}
+};
+
+/**
+ * @brief Lien entre une variable dérivée et l'une de ses entrées
+ */
+struct VariableLink {
+	VariablesListener* owner;	///< Objet qui possède la variable
+	VariableInfo* variable;		///< Nulle si l'entrée a été supprimée
+};
+
+/**
+ * @brief Définition d'une variable dérivée
+ */
+struct VariableDerivation {
+	std::mutex mutex;					///< Protège function et inputs, pris pendant chaque calcul
+	DerivedFunction function;
+	std::vector<VariableLink> inputs;
+	std::atomic<bool> dirty{false};		///< Une entrée a changé depuis le dernier calcul
+};
+
 struct VariableInfo {
 	std::string name;		///< Nom de la variable
 	std::string description; ///< Description de la variable
 	VariantType value;	   ///< Valeur de la variable
+	size_t type = 0;		///< Position du type de la valeur dans VariantType, fixée à l'ajout
+	size_t position = 0;	///< Position dans l'ordre d'ajout (VariablesListener::_variables)
+
+	// Copie lue par les lecteurs en mode concurrent (VariablesListener::enableConcurrentAccess)
+	std::atomic<uint64_t> bits{0};					///< Valeur d'un type numérique, booléen ou pointeur
+	std::atomic<const std::string*> text{nullptr};	///< Chaîne immuable, publiée par RCU
+
+	// Variables dérivées (VariablesListener::addDerivedVariable)
+	std::unique_ptr<VariableDerivation> derivation;	///< Définition, nulle pour une variable ordinaire
+	std::vector<VariableLink> dependents;				///< Variables dérivées qui utilisent celle-ci (sous dependentsMutex)
+	std::atomic<bool> hasDependents{false};			///< dependents n'est pas vide, lu sans verrou à chaque modification
+	std::mutex dependentsMutex;						///< Un autre objet peut modifier dependents pendant un parcours (rechargement d'un plugin)
 };
 
 class VariableNotFoundException : public std::runtime_error {
@@ -32,9 +92,256 @@ public:
 		: std::runtime_error("Variable not found: " + variable) {}
 };
 
+/**
+ * @brief Modification d'une variable, transmise aux observateurs
+ */
+struct VariableChange {
+	std::string name;		///< Nom de la variable
+	VariantType oldValue;	///< Valeur avant la modification (avant la première, si plusieurs ont été fusionnées)
+	VariantType newValue;	///< Valeur après la modification
+};
+
+using VariableCallback = std::function<void(const VariableChange&)>;
+
+/**
+ * @brief Fonction d'un observateur de modifications groupées (VariablesListener::observeVariables)
+ */
+using VariablesCallback = std::function<void(std::span<const VariableChange> changes)>;
+
+/**
+ * @brief Moment où un observateur est prévenu d'une modification
+ */
+enum class NotificationMode {
+	Synchronous,	///< Dans setVariable, avant son retour
+	Deferred		///< Plus tard, sur un CommandExecutor : les modifications rapprochées d'une variable sont fusionnées
+};
+
+/**
+ * @brief Observateur de variables, à passer à VariablesListener::unobserveVariable
+ */
+struct VariableObserver {
+	static constexpr uint32_t INVALID = UINT32_MAX;
+
+	uint32_t id = INVALID;
+
+	bool ok() const noexcept { return id != INVALID; }
+};
+
+/**
+ * @brief Référence directe vers une variable, obtenue une fois avec VariablesListener::getVariableHandle
+ *
+ * Les lectures renvoient une référence sur la valeur (ou un std::string_view) sans copie ni recherche par nom,
+ * les écritures remplacent la valeur sur place et préviennent les observateurs comme setVariable.
+ * Avec T = VariantType la poignée lit le variant ; avec un type T de VariantType, le type est vérifié une seule
+ * fois à l'obtention de la poignée et get() le lit sans vérification (une variable garde toujours son type).
+ * La poignée reste valide tant que la variable n'est pas supprimée et que l'objet qui la possède existe.
+ * En mode concurrent, get() et view() ne sont sûres que dans le thread qui modifie les variables : les autres utilisent load().
+ */
+template<typename T = VariantType>
+class VariableHandle {
+	static_assert(std::is_same_v<T, VariantType> || variantIndex<T> != std::variant_npos, "VariableHandle type must be one of VariantType alternatives");
+public:
+	VariableHandle() noexcept = default;
+
+	bool ok() const noexcept { return _variable != nullptr; }
+
+	const std::string& name() const noexcept { return _variable->name; }
+
+	/**
+	 * @brief Type de la variable, fixé à son ajout
+	 * @return Position du type dans VariantType
+	 */
+	size_t type() const noexcept { return _variable->type; }
+
+	/**
+	 * @brief Savoir si la variable est dérivée, donc en lecture seule
+	 */
+	bool derived() const noexcept { return _variable->derivation != nullptr; }
+
+	/**
+	 * @brief Lire la valeur
+	 * @return Référence sur la valeur, valide jusqu'à la prochaine modification de la variable
+	 * @throw l'exception de la fonction d'une variable dérivée recalculée, si elle ne dérive pas de std::exception
+	 */
+	const T& get() const {
+		refresh();
+		if constexpr (std::is_same_v<T, VariantType>) {
+			return _variable->value;
+		} else {
+			return *std::get_if<T>(&_variable->value);
+		}
+	}
+
+	/**
+	 * @brief Lire une copie de la valeur, y compris pendant qu'un autre thread la modifie
+	 * En mode concurrent, sans verrou : lecture atomique pour les nombres, dans une section RCU pour les chaînes.
+	 * @return Valeur de la variable
+	 */
+	T load() const;
+
+	/**
+	 * @brief Lire une variable texte sans copie
+	 * @return Vue sur la chaîne, valide jusqu'à la prochaine modification de la variable
+	 * @throw std::bad_variant_access si la variable n'est pas une chaîne
+	 */
+	std::string_view view() const {
+		if constexpr (std::is_same_v<T, std::string>) {
+			return get();
+		} else {
+			refresh();
+			return std::get<std::string>(_variable->value);
+		}
+	}
+
+	/**
+	 * @brief Modifier la valeur sur place
+	 * @param[in] value Nouvelle valeur
+	 * @return true si la valeur a été modifiée, false si son type ne convient pas ou si la variable est dérivée
+	 */
+	bool set(const T& value) const;
+
+private:
+	friend class VariablesListener;
+
+	VariableHandle(VariablesListener* owner, VariableInfo* variable) noexcept : _owner(owner), _variable(variable) {}
+
+	void refresh() const;
+
+	VariablesListener* _owner = nullptr;
+	VariableInfo* _variable = nullptr;
+};
+
+/**
+ * @brief Modifications de plusieurs variables d'un même objet, vérifiées ensemble avant d'être appliquées
+ * Obtenues avec VariablesListener::prepareVariables, qui recherche chaque variable une seule fois et convertit
+ * les valeurs dans le type des variables : VariablesListener::applyVariables ne peut plus échouer.
+ */
+class PreparedVariables {
+public:
+	/**
+	 * @brief Modifications préparées
+	 * @return Nom, valeur actuelle et nouvelle valeur de chaque variable
+	 */
+	const std::vector<VariableChange>& changes() const noexcept { return _changes; }
+
+	bool empty() const noexcept { return _changes.empty(); }
+
+	/**
+	 * @brief Rendre le verrou d'écriture pris par prepareVariables, pour des modifications qui ne seront pas appliquées
+	 */
+	void release() noexcept { _lock = {}; }
+
+private:
+	friend class VariablesListener;
+
+	std::vector<VariableChange> _changes;
+	std::vector<VariableInfo*> _variables;	///< Variable de chaque modification
+	std::unique_lock<std::mutex> _lock;		///< Verrou d'écriture en mode concurrent, de la préparation à l'application
+};
+
+/**
+ * @brief Variables d'un plugin
+ *
+ * Les observateurs enregistrés avec observeVariable sont prévenus à chaque setVariable qui change la valeur,
+ * avec l'ancienne et la nouvelle valeur : un plugin peut garder un état dérivé de ses variables et ne le
+ * recalculer que lorsqu'elles changent, au lieu de les relire à chaque utilisation.
+ * Un observateur de observeVariables reçoit en un seul appel toutes les modifications faites ensemble (setVariables).
+ * En mode différé, les modifications d'une variable faites avant que la notification ne soit traitée sont
+ * fusionnées en une seule ; le destructeur attend la fin des notifications différées en cours.
+ *
+ * Par défaut les variables ne sont pas protégées. En mode concurrent (enableConcurrentAccess), getVariable et
+ * VariableHandle::load peuvent être appelées depuis n'importe quel thread pendant que d'autres appellent setVariable :
+ * les lecteurs ne prennent aucun verrou et ne voient jamais de valeur à moitié écrite. Les nombres, booléens et
+ * pointeurs sont copiés dans un std::atomic<uint64_t>, les chaînes dans une copie immuable publiée par RCU.
+ * Les écrivains sont sérialisés mais n'attendent pas les lecteurs : les anciennes chaînes sont libérées par lots,
+ * après une seule période de grâce pour RcuDomain::RETIRE_BATCH chaînes. L'ajout et la suppression de variables restent réservés à l'initialisation.
+ *
+ * setVariables (ou prepareVariables, applyVariables et notifyVariables) modifie plusieurs variables en tout ou rien :
+ * un plugin peut refuser l'ensemble dans validateVariables et reçoit une seule notification dans variablesCommitted.
+ *
+ * Une variable dérivée (addDerivedVariable) est calculée à partir d'autres variables, éventuellement d'autres plugins.
+ * Modifier une entrée ne fait que marquer les variables qui en dépendent, de proche en proche ; la fonction n'est
+ * rappelée qu'à la lecture suivante, et seulement si une entrée a changé. redefineVariable, qui peut être appelée
+ * pendant que d'autres threads lisent la variable, refuse une définition qui créerait un cycle.
+ */
 class VariablesListener {
 private:
-	std::vector<VariableInfo> _variables;
+	struct Observer {
+		uint32_t id;
+		std::string variable;	///< Variable observée, vide pour toutes
+		VariableCallback callback;
+		VariablesCallback grouped;	///< Si défini, appelé une fois avec toutes les modifications au lieu de callback
+		NotificationMode mode;
+		CommandExecutor* executor;
+		std::atomic<bool> active{true};
+		std::mutex mutex;						///< Protège pending et scheduled
+		std::vector<VariableChange> pending;	///< Une entrée par variable modifiée depuis la dernière notification
+		bool scheduled = false;					///< Une notification différée est dans la file de l'exécuteur
+	};
+
+	std::vector<std::unique_ptr<VariableInfo>> _variables;	///< Dans l'ordre d'ajout, adresses stables : les VariableHandle pointent dessus
+	StringMap<VariableInfo*> _index;						///< Nom -> variable
+	std::atomic<uint64_t> _version{0};	///< Incrémenté à chaque modification, ajout ou suppression de variable
+	std::atomic<uint64_t> _listVersion{0};	///< Incrémenté à chaque ajout ou suppression de variable
+
+	// Observateurs : sous _observersMutex
+	std::vector<std::shared_ptr<Observer>> _observers;
+	std::atomic<size_t> _nbObservers{0};	///< Lu sans verrou par setVariable
+	mutable std::mutex _observersMutex;
+	std::condition_variable _idle;			///< Signalé quand une notification différée se termine
+	size_t _inFlight = 0;					///< Notifications différées dans la file de l'exécuteur ou en cours
+	uint32_t _nextObserver = 0;
+
+	// Mode concurrent
+	bool _concurrent = false;
+	std::unique_ptr<RcuDomain> _rcu;
+	mutable std::mutex _writeMutex;		///< Sérialise les écrivains (et les recalculs des variables dérivées)
+
+	bool _validation = true;	///< Mis à false par la version par défaut de validateVariables : prepare ne copie plus les valeurs actuelles
+
+	template<typename> friend class VariableHandle;
+
+	void publish(VariableInfo& variable) const;
+	VariantType load(const VariableInfo& variable) const;
+	template<typename T>
+	T loadAs(const VariableInfo& variable) const;
+
+	template<typename T>
+	static uint64_t pack(T value) noexcept {
+		uint64_t bits = 0;
+		std::memcpy(&bits, &value, sizeof(T));
+		return bits;
+	}
+
+	template<typename T>
+	static T unpack(uint64_t bits) noexcept {
+		T value;
+		std::memcpy(&value, &bits, sizeof(T));
+		return value;
+	}
+
+	VariableInfo* findVariable(std::string_view variable_name) const noexcept;
+	VariableInfo* findVariable(std::string_view variable_name, const VariableInfo* previous) const noexcept;
+	bool assign(VariableInfo& variable, const VariantType& value);
+	template<typename T>
+	void assign(VariableInfo& variable, const T& value);
+	void notify(std::span<const VariableChange> changes);
+	VariableObserver addObserver(std::shared_ptr<Observer> observer);
+
+	template<typename Values, typename Resolve>
+	bool prepare(Values&& values, Resolve resolve, PreparedVariables& prepared, std::string& error);
+	VariableInfo* resolveHandle(const VariableHandle<>& handle, std::string& error) const;
+
+	// Variables dérivées
+	bool resolveInputs(const std::vector<VariableSource>& sources, std::vector<VariableLink>& inputs, std::string& error);
+	static bool evaluate(const std::string& variable_name, const DerivedFunction& function, const std::vector<VariableLink>& inputs, VariantType& result);
+	static void addDependent(VariableInfo& input, VariableLink dependent);
+	static void removeDependent(VariableInfo& input, const VariableInfo& dependent);
+	static bool dependsOn(const VariableInfo& variable, const VariableInfo& target);
+	void invalidate(VariableInfo& variable);
+	void refresh(VariableInfo& variable) const;
+	void unlink(VariableInfo& variable, bool externalOnly);
+	void deliver(std::shared_ptr<Observer> observer);
 public:
 	VariablesListener();
 
@@ -57,15 +364,135 @@ protected:
 	 */
 	bool removeVariable(const std::string& variable_name);
 
+	/**
+	 * @brief Fonction appelée avant d'appliquer des modifications groupées, pour les refuser toutes
+	 * Permet de vérifier des valeurs qui dépendent les unes des autres. Une exception vaut un refus.
+	 * En mode concurrent, elle est appelée sous le verrou d'écriture gardé jusqu'à l'application : les valeurs
+	 * actuelles ne peuvent pas changer entre-temps, mais elle ne doit ni modifier de variable ni lire de variable dérivée.
+	 * Une redéfinition ne doit pas appeler cette version, qui signale qu'aucune vérification n'est faite.
+	 * @param[in] changes Valeur actuelle et nouvelle valeur de chaque variable modifiée
+	 * @param[out] reason Raison du refus
+	 * @return true pour accepter les modifications, false pour les refuser
+	 */
+	virtual bool validateVariables(const std::vector<VariableChange>& changes, std::string& reason) {
+		(void)changes;
+		(void)reason;
+		_validation = false;
+		return true;
+	}
+
+	/**
+	 * @brief Fonction appelée une seule fois après des modifications groupées, après les observateurs des variables
+	 * @param[in] changes Variables dont la valeur a changé
+	 */
+	virtual void variablesCommitted(const std::vector<VariableChange>& changes) {
+		(void)changes;
+	}
+
 public:
 	/**
 	 * @brief Fonction pour modifier la valeur d'une variable
+	 * La variable garde le type de sa valeur initiale : la valeur doit avoir ce type ou y être convertible sans perte.
 	 * @param[in] variable_name Nom de la variable
 	 * @param[in] value Valeur de la variable
-	 * @return true si la variable a été modifiée, false sinon
+	 * @return true si la variable a été modifiée, false si elle n'existe pas ou si le type de la valeur ne convient pas
 	 */
 	bool setVariable(const std::string& variable_name, const VariantType& value);
 
+	/**
+	 * @brief Fonction pour ajouter une variable calculée à partir d'autres variables
+	 * La fonction est appelée une première fois pour donner sa valeur et son type à la variable. Ensuite, chaque
+	 * modification d'une entrée marque la variable (et celles qui en dérivent) comme à recalculer, sans rien calculer :
+	 * la fonction n'est rappelée qu'à la lecture suivante. Une variable dérivée ne peut pas être modifiée ni observée.
+	 * Les entrées d'un autre objet doivent exister aussi longtemps que la variable ; si l'une est supprimée avant,
+	 * la variable garde sa dernière valeur.
+	 * @param[in] variable_name Nom de la variable
+	 * @param[in] description Description de la variable
+	 * @param[in] inputs Variables utilisées, de cet objet ou d'un autre, éventuellement dérivées
+	 * @param[in] function Fonction qui calcule la valeur à partir des valeurs des entrées
+	 * @return true si la variable a été ajoutée, false si elle existe déjà, si une entrée n'existe pas ou si la fonction échoue
+	 */
+	bool addDerivedVariable(const std::string& variable_name, const std::string& description, const std::vector<VariableSource>& inputs, DerivedFunction function);
+
+	/**
+	 * @brief Fonction pour changer les entrées et la fonction d'une variable dérivée
+	 * @param[in] variable_name Nom de la variable dérivée
+	 * @param[in] inputs Nouvelles entrées
+	 * @param[in] function Nouvelle fonction, dont le résultat doit garder le type de la variable
+	 * @return true si la définition a été remplacée, false sinon, en particulier si elle créerait un cycle
+	 */
+	bool redefineVariable(const std::string& variable_name, const std::vector<VariableSource>& inputs, DerivedFunction function);
+
+	/**
+	 * @brief Fonction pour savoir si une variable est dérivée
+	 * @param[in] variable_name Nom de la variable
+	 * @return true si la variable existe et est dérivée
+	 */
+	bool isDerivedVariable(const std::string& variable_name) const;
+
+	/**
+	 * @brief Fonction pour savoir si des variables dérivées d'autres objets utilisent des variables de celui-ci
+	 * @return true si l'objet doit rester en vie pour que ces variables restent à jour
+	 */
+	bool hasExternalDependents() const noexcept;
+
+	/**
+	 * @brief Fonction pour modifier plusieurs variables ensemble
+	 * Aucune variable n'est modifiée si l'une n'existe pas, si une valeur n'a pas le bon type ou si validateVariables
+	 * refuse les modifications. Sinon elles sont toutes appliquées, puis les observateurs sont prévenus et
+	 * variablesCommitted est appelée une seule fois.
+	 * @param[in] values Nom et nouvelle valeur de chaque variable
+	 * @return true si les variables ont été modifiées, false sinon
+	 */
+	bool setVariables(const std::vector<std::pair<std::string, VariantType>>& values);
+
+	/**
+	 * @brief Fonction pour vérifier des modifications groupées sans les appliquer
+	 * Chaque variable est recherchée une seule fois et sa nouvelle valeur convertie dans son type, puis
+	 * validateVariables est appelée. Une variable présente plusieurs fois reçoit la dernière valeur.
+	 * En mode concurrent, le verrou d'écriture reste pris jusqu'à applyVariables ou PreparedVariables::release.
+	 * @param[in] values Nom et nouvelle valeur de chaque variable
+	 * @param[out] prepared Modifications prêtes à être appliquées
+	 * @param[out] error Raison de l'échec
+	 * @return true si les modifications peuvent être appliquées, false sinon
+	 */
+	bool prepareVariables(const std::vector<std::pair<std::string, VariantType>>& values, PreparedVariables& prepared, std::string& error);
+
+	/**
+	 * @brief Fonction pour vérifier des modifications groupées de variables déjà trouvées (getVariableHandle)
+	 * Comme prepareVariables avec des noms, sans les rechercher une seconde fois.
+	 * @param[in] values Poignée de cet objet et nouvelle valeur de chaque variable
+	 * @param[out] prepared Modifications prêtes à être appliquées
+	 * @param[out] error Raison de l'échec
+	 * @return true si les modifications peuvent être appliquées, false sinon
+	 */
+	bool prepareVariables(const std::vector<std::pair<VariableHandle<>, VariantType>>& values, PreparedVariables& prepared, std::string& error);
+
+	/**
+	 * @brief Fonction pour vérifier des modifications groupées de variables déjà trouvées, en déplaçant les valeurs
+	 * Comme la version précédente, sans copier les valeurs : values ne doit plus être utilisé ensuite.
+	 * @param[in] values Poignée de cet objet et nouvelle valeur de chaque variable
+	 * @param[out] prepared Modifications prêtes à être appliquées
+	 * @param[out] error Raison de l'échec
+	 * @return true si les modifications peuvent être appliquées, false sinon
+	 */
+	bool prepareVariables(std::vector<std::pair<VariableHandle<>, VariantType>>&& values, PreparedVariables& prepared, std::string& error);
+
+	/**
+	 * @brief Fonction pour appliquer des modifications préparées, sans prévenir les observateurs
+	 * En mode concurrent, elles sont appliquées sous le verrou d'écriture pris par prepareVariables, puis il est rendu.
+	 * @param[in,out] prepared Modifications préparées par prepareVariables, anciennes valeurs mises à jour
+	 */
+	void applyVariables(PreparedVariables& prepared);
+
+	/**
+	 * @brief Fonction pour prévenir les observateurs de modifications appliquées par applyVariables
+	 * Les modifications qui ne changent pas la valeur sont retirées ; s'il en reste, chaque observateur est prévenu
+	 * en une seule passe (une seule notification pour un observateur de observeVariables), puis variablesCommitted est appelée.
+	 * @param[in,out] prepared Modifications appliquées
+	 */
+	void notifyVariables(PreparedVariables& prepared);
+
 	/**
 	 * @brief Fonction pour récupérer la valeur d'une variable
 	 * @param[in] variable_name Nom de la variable
@@ -74,6 +501,25 @@ public:
 	 */
 	VariantType getVariable(const std::string& variable_name) const;
 
+	/**
+	 * @brief Fonction pour obtenir une référence directe vers une variable
+	 * Des noms cherchés dans l'ordre d'ajout des variables (un fichier de configuration) sont trouvés sans hachage
+	 * en passant la poignée de la variable précédente.
+	 * @param[in] variable_name Nom de la variable
+	 * @param[in] previous Poignée de la variable cherchée juste avant : celle qui la suit est essayée en premier
+	 * @return Poignée, invalide si la variable n'existe pas ou n'est pas de type T
+	 */
+	template<typename T = VariantType>
+	VariableHandle<T> getVariableHandle(std::string_view variable_name, const VariableHandle<>& previous = {}) noexcept {
+		VariableInfo* var = findVariable(variable_name, previous._owner == this ? previous._variable : nullptr);
+		if constexpr (!std::is_same_v<T, VariantType>) {
+			if (var && var->type != variantIndex<T>) {
+				return {};
+			}
+		}
+		return VariableHandle<T>(this, var);
+	}
+
 	/**
 	 * @brief Fonction pour vérifier si la variable existe
 	 * @param[in] variable_name Nom de la variable
@@ -87,6 +533,35 @@ public:
 	 */
 	std::vector<std::string> getVariables() const;
 
+	/**
+	 * @brief Fonction pour parcourir les variables dans l'ordre d'ajout, sans construire la liste des noms
+	 * @param[in] function Fonction appelée avec le nom et la valeur de chaque variable
+	 */
+	template<typename F>
+	void forEachVariable(F&& function) const {
+		for (const auto& var : _variables) {
+			if (var->derivation) {
+				refresh(*var);
+			}
+			if (_concurrent) {
+				function(var->name, load(*var));
+			} else {
+				function(var->name, var->value);
+			}
+		}
+	}
+
+	/**
+	 * @brief Fonction pour parcourir les noms des variables dans l'ordre d'ajout, sans lire ni recalculer leurs valeurs
+	 * @param[in] function Fonction appelée avec le nom de chaque variable
+	 */
+	template<typename F>
+	void forEachVariableName(F&& function) const {
+		for (const auto& var : _variables) {
+			function(var->name);
+		}
+	}
+
 	/**
 	 * @brief Fonction pour récupérer la description d'une variable
 	 * @param[in] variable_name Nom de la variable
@@ -94,7 +569,134 @@ public:
 	 */
 	const std::string &getDescription(const std::string& variable_name) const;
 
+	/**
+	 * @brief Fonction pour savoir si les variables ont changé depuis une lecture précédente
+	 * @return Version des variables, incrémentée à chaque modification
+	 */
+	uint64_t getVariablesVersion() const noexcept { return _version.load(std::memory_order_acquire); }
+
+	/**
+	 * @brief Fonction pour savoir si des variables ont été ajoutées ou supprimées, sans tenir compte des modifications
+	 * @return Version de la liste des variables
+	 */
+	uint64_t getVariableListVersion() const noexcept { return _listVersion.load(std::memory_order_acquire); }
+
+	/**
+	 * @brief Fonction pour permettre les lectures et écritures de variables depuis plusieurs threads
+	 * À appeler avant que les variables ne soient partagées entre threads ; le mode ne peut pas être désactivé.
+	 */
+	void enableConcurrentAccess();
+
+	bool isConcurrentAccess() const noexcept { return _concurrent; }
+
+	/**
+	 * @brief Fonction pour être prévenu des modifications d'une variable
+	 * @param[in] variable_name Nom de la variable, vide pour observer toutes les variables
+	 * @param[in] callback Fonction appelée avec l'ancienne et la nouvelle valeur
+	 * @param[in] mode Notification synchrone, ou différée et fusionnée
+	 * @param[in] executor Exécuteur des notifications différées, qui doit exister aussi longtemps que l'observateur et exécuter
+	 * toutes les tâches qu'il accepte ; une notification qu'il refuse (exception de submit) est livrée de façon synchrone
+	 * @return Observateur, invalide si la variable n'existe pas ou si le mode différé n'a pas d'exécuteur
+	 */
+	VariableObserver observeVariable(const std::string& variable_name, VariableCallback callback,
+		NotificationMode mode = NotificationMode::Synchronous, CommandExecutor* executor = nullptr);
+
+	/**
+	 * @brief Fonction pour être prévenu une seule fois de toutes les variables modifiées ensemble
+	 * setVariables, notifyVariables et les transactions font un seul appel avec toutes leurs modifications, setVariable
+	 * un appel avec une seule. En mode différé, les modifications faites avant la notification sont fusionnées.
+	 * @param[in] callback Fonction appelée avec les modifications
+	 * @param[in] mode Notification synchrone, ou différée et fusionnée
+	 * @param[in] executor Exécuteur des notifications différées (voir observeVariable)
+	 * @return Observateur, invalide si le mode différé n'a pas d'exécuteur
+	 */
+	VariableObserver observeVariables(VariablesCallback callback,
+		NotificationMode mode = NotificationMode::Synchronous, CommandExecutor* executor = nullptr);
+
+	/**
+	 * @brief Fonction pour supprimer un observateur
+	 * Les notifications différées encore en attente pour cet observateur sont abandonnées, une notification déjà
+	 * commencée va jusqu'au bout.
+	 * @param[in] observer Observateur retourné par observeVariable ou observeVariables
+	 * @return true si l'observateur existait, false sinon
+	 */
+	bool unobserveVariable(VariableObserver observer);
+
+	/**
+	 * @brief Fonction pour supprimer tous les observateurs et attendre la fin des notifications différées en cours
+	 * Un plugin qui observe ses variables en mode différé l'appelle dans shutdown(), avant que son état ne soit détruit.
+	 * Ne doit pas être appelée depuis une notification différée.
+	 * @return Nombre d'observateurs supprimés
+	 */
+	size_t unobserveAll();
+
 };
 
 
+template<typename T>
+T VariablesListener::loadAs(const VariableInfo& var) const {
+	if (!_concurrent) {
+		return *std::get_if<T>(&var.value);
+	}
+	if constexpr (std::is_same_v<T, std::string>) {
+		auto guard = _rcu->read();
+		return *var.text.load(std::memory_order_acquire);
+	} else {
+		return unpack<T>(var.bits.load(std::memory_order_acquire));
+	}
+}
+
+template<typename T>
+void VariablesListener::assign(VariableInfo& var, const T& value) {
+	if (_concurrent) {
+		assign(var, VariantType(value));
+		return;
+	}
+	T& current = *std::get_if<T>(&var.value);
+	if (_nbObservers.load(std::memory_order_acquire) == 0) {
+		current = value;
+		_version.fetch_add(1, std::memory_order_release);
+		invalidate(var);
+		return;
+	}
+	VariableChange change{ var.name, var.value, {} };
+	current = value;
+	_version.fetch_add(1, std::memory_order_release);
+	invalidate(var);
+	if (change.oldValue != var.value) {
+		change.newValue = var.value;
+		notify({ &change, 1 });
+	}
+}
+
+template<typename T>
+void VariableHandle<T>::refresh() const {
+	if (_variable->derivation) {
+		_owner->refresh(*_variable);
+	}
+}
+
+template<typename T>
+T VariableHandle<T>::load() const {
+	refresh();
+	if constexpr (std::is_same_v<T, VariantType>) {
+		return _owner->load(*_variable);
+	} else {
+		return _owner->template loadAs<T>(*_variable);
+	}
+}
+
+template<typename T>
+bool VariableHandle<T>::set(const T& value) const {
+	if constexpr (std::is_same_v<T, VariantType>) {
+		return _owner->assign(*_variable, value);
+	} else {
+		if (_variable->derivation) {
+			return false;
+		}
+		_owner->assign(*_variable, value);	// Type vérifié à l'obtention de la poignée
+		return true;
+	}
+}
+
 #endif // VARIABLES_LISTENER_HPP
\ No newline at end of file
@@ -1,4 +1,5 @@
 #include "VariantType.hpp"
+#include <iterator>
 
 std::string VariantToString(const VariantType &var) {
 	return std::visit([](const auto& value) -> std::string {
@@ -15,21 +16,15 @@ std::string VariantToString(const VariantType &var) {
 }
 
 std::string VariantTypeName(const VariantType &var) {
-	return std::visit([](const auto& value) -> std::string {
-		using T = std::decay_t<decltype(value)>;
-		if      constexpr (std::is_same_v<T, uint8_t>)      return "uint8_t";
-		else if constexpr (std::is_same_v<T, uint16_t>)     return "uint16_t";
-		else if constexpr (std::is_same_v<T, uint32_t>)     return "uint32_t";
-		else if constexpr (std::is_same_v<T, uint64_t>)     return "uint64_t";
-		else if constexpr (std::is_same_v<T, int8_t>)       return "int8_t";
-		else if constexpr (std::is_same_v<T, int16_t>)      return "int16_t";
-		else if constexpr (std::is_same_v<T, int32_t>)      return "int32_t";
-		else if constexpr (std::is_same_v<T, int64_t>)      return "int64_t";
-		else if constexpr (std::is_same_v<T, float>)        return "float";
-		else if constexpr (std::is_same_v<T, double>)       return "double";
-		else if constexpr (std::is_same_v<T, bool>)         return "bool";
-		else if constexpr (std::is_same_v<T, std::string>)  return "std::string";
-		else if constexpr (std::is_same_v<T, void*>)        return "void*";
-		else return "unknown";
-	}, var);
-}
\ No newline at end of file
+	return VariantIndexName(var.index());
+}
+
+std::string VariantIndexName(size_t index) {
+	// Dans l'ordre des alternatives de VariantType
+	static const char* const names[] = {
+		"uint8_t", "uint16_t", "uint32_t", "uint64_t", "int8_t", "int16_t", "int32_t", "int64_t",
+		"float", "double", "bool", "std::string", "void*"
+	};
+	static_assert(std::size(names) == std::variant_size_v<VariantType>, "One name per VariantType alternative");
+	return index < std::size(names) ? names[index] : "unknown";
+}
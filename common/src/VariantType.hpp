@@ -11,10 +11,29 @@
 // Définir VariantType
 using VariantType = std::variant<uint8_t, uint16_t, uint32_t, uint64_t, int8_t, int16_t, int32_t, int64_t, float, double, bool, std::string, void*>;
 
+// Position d'un type dans VariantType, std::variant_npos si le type n'en fait pas partie
+template<typename T, typename V = VariantType>
+struct VariantIndex;
+
+template<typename T, typename... Ts>
+struct VariantIndex<T, std::variant<Ts...>> {
+	static constexpr size_t value = []() {
+		size_t index = 0;
+		bool found = ((std::is_same_v<T, Ts> ? true : (++index, false)) || ...);
+		return found ? index : std::variant_npos;
+	}();
+};
+
+template<typename T>
+inline constexpr size_t variantIndex = VariantIndex<T>::value;
+
 // Fonction pour convertir un VariantType en chaîne de caractères
 std::string VariantToString(const VariantType& var);
 
 // Fonction pour obtenir le type d'un VariantType en chaîne de caractères
 std::string VariantTypeName(const VariantType& var);
 
+// Fonction pour obtenir le nom d'un type à partir de sa position dans VariantType
+std::string VariantIndexName(size_t index);
+
 #endif // VARIANT_TYPE_HPP
\ No newline at end of file
@@ -0,0 +1,1243 @@
+/**
+ * @file Benchmarks.cpp
+ * @author ClemtoClem
+ * @date 17/10/2026
+ */
+
+#include "Benchmarks.hpp"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <new>
+#include <sstream>
+#include <thread>
+#include <unistd.h>
+#include "../../common/src/CommandsListener.hpp"
+#include "../../common/src/Logger.hpp"
+#include "../../common/src/PluginInterface.hpp"
+#include "ConfigFile.hpp"
+#include "PluginsManager.hpp"
+#include "ScriptRunner.hpp"
+#include "ThreadPool.hpp"
+#include "VariablesSnapshot.hpp"
+
+// Compteur d'allocations du programme principal, utilisé par les mesures
+static std::atomic<size_t> allocations{0};
+
+void* operator new(size_t size) {
+	allocations.fetch_add(1, std::memory_order_relaxed);
+	if (void* pointer = std::malloc(size ? size : 1)) {
+		return pointer;
+	}
+	throw std::bad_alloc();
+}
+
+void operator delete(void* pointer) noexcept {
+	std::free(pointer);
+}
+
+void operator delete(void* pointer, size_t) noexcept {
+	std::free(pointer);
+}
+
+namespace {
+
+class BenchCommands : public CommandsListener {
+public:
+	// Ouverts pour que --bench-registry modifie la liste depuis un autre thread
+	using CommandsListener::addCommand;
+	using CommandsListener::setAlias;
+	using CommandsListener::removeCommand;
+	using CommandsListener::beginCommands;
+	using CommandsListener::endCommands;
+
+	BenchCommands() {
+		beginCommands();
+		addCommand("add", "Additionne deux entiers (ancienne forme)", 2, 1, [](const std::vector<VariantType>& args) {
+			return std::vector<VariantType>{ std::get<int>(args[0]) + std::get<int>(args[1]) };
+		}, { 1 });
+		addCommand("add_inplace", "Additionne deux entiers", 2, 1, [](const CommandArgs& args, std::vector<VariantType>& results) {
+			results.emplace_back(args.get<int>(0) + args.get<int>(1));
+		}, { 1 });
+		addCommand<int32_t(int32_t, int32_t)>("add_typed", "Additionne deux entiers (commande typée)", [](int32_t a, int32_t b) {
+			return a + b;
+		}, { 1 });
+		addCommand<std::tuple<double, std::string>(double, const std::string&)>("scale", "Multiplie par deux et nomme le résultat",
+			[](double value, const std::string& unit) {
+				return std::make_tuple(value * 2, unit);
+			}, {}, ArgumentCoercion::Numeric);
+		endCommands();
+	}
+};
+
+// Appel direct de référence, non inliné pour rester comparable à un appel de commande
+[[gnu::noinline]] int32_t directAdd(int32_t a, int32_t b) {
+	return a + b;
+}
+
+// Plugin local avec une commande pure coûteuse qui dépend d'une variable
+class BenchPlugin : public PluginInterface {
+public:
+	using VariablesListener::addVariable;
+
+	BenchPlugin() : PluginInterface("BenchPlugin", "ClemtoClem", "Pure command benchmark", {1, 0, 0}, {1, 0, 0}) {
+		addVariable("scale", "Facteur appliqué à la somme", int64_t(1));
+		addCommand<int64_t(int32_t)>("scaled_sum", "Somme des entiers de 0 à n, multipliée par scale", [this](int32_t n) {
+			int64_t scale = std::get<int64_t>(getVariable("scale"));
+			int64_t sum = 0;
+			for (int32_t k = 0; k < n; ++k) {
+				sum += k * scale;
+			}
+			return sum;
+		}, {}, ArgumentCoercion::Exact, true);
+	}
+
+	int init(int, char*[]) override { return 0; }
+	int shutdown() noexcept override { return 0; }
+};
+
+struct Measure {
+	double nsPerCall;
+	size_t allocations;
+};
+
+template<typename F>
+Measure measure(size_t iterations, F&& function) {
+	size_t before = allocations.load(std::memory_order_relaxed);
+	auto start = std::chrono::steady_clock::now();
+	for (size_t i = 0; i < iterations; ++i) {
+		function(i);
+	}
+	auto elapsed = std::chrono::steady_clock::now() - start;
+	return { std::chrono::duration<double, std::nano>(elapsed).count() / iterations, allocations.load(std::memory_order_relaxed) - before };
+}
+
+} // namespace
+
+int benchCommands() {
+	constexpr size_t ITERATIONS = 1000000;
+
+	BenchCommands commands;
+	const std::vector<VariantType> args{ 20, 22 };
+	const std::vector<VariantType> partialArgs{ 41 };
+	int64_t checksum = 0;
+
+	Measure legacy = measure(ITERATIONS, [&](size_t) {
+		checksum += std::get<int>(commands.callCommand("add", args)[0]);
+	});
+
+	CommandHandle wrapped = commands.getCommandHandle("add");
+	CommandHandle inplace = commands.getCommandHandle("add_inplace");
+	std::vector<VariantType> results;
+	inplace.call(args, results);	// Première réservation du vecteur des résultats
+
+	Measure wrappedHandle = measure(ITERATIONS, [&](size_t) {
+		wrapped.call(args, results);
+		checksum += std::get<int>(results[0]);
+	});
+	CommandHandle typed = commands.getCommandHandle("add_typed");
+	Measure typedHandle = measure(ITERATIONS, [&](size_t i) {
+		typed.call((i & 1) ? std::span<const VariantType>(partialArgs) : std::span<const VariantType>(args), results);
+		checksum += std::get<int32_t>(results[0]);
+	});
+	Measure direct = measure(ITERATIONS, [&](size_t i) {
+		checksum += (i & 1) ? directAdd(41, 1) : directAdd(20, 22);
+	});
+
+	Measure inplaceHandle = measure(ITERATIONS, [&](size_t i) {
+		inplace.call((i & 1) ? std::span<const VariantType>(partialArgs) : std::span<const VariantType>(args), results);
+		checksum += std::get<int>(results[0]);
+	});
+
+	LOG(Info) << "callCommand(name, vector), old command:  " << legacy.nsPerCall << " ns/call, " << legacy.allocations << " allocations";
+	LOG(Info) << "CommandHandle::call(span), old command:  " << wrappedHandle.nsPerCall << " ns/call, " << wrappedHandle.allocations << " allocations";
+	LOG(Info) << "CommandHandle::call(span), new command:  " << inplaceHandle.nsPerCall << " ns/call, " << inplaceHandle.allocations << " allocations";
+	LOG(Info) << "CommandHandle::call(span), typed command: " << typedHandle.nsPerCall << " ns/call, " << typedHandle.allocations << " allocations";
+	LOG(Info) << "Direct function call:                    " << direct.nsPerCall << " ns/call";
+	LOG(Debug) << "Checksum: " << checksum;
+
+	// Conversion numérique sans perte (int32_t -> double) et erreur de type détectée avant l'appel
+	LOG(Info) << "scale " << commands.getSignature("scale").toString() << ": "
+		<< VariantToString(commands.callCommand("scale", { int32_t(21), std::string("m") })[0]);
+	try {
+		commands.callCommand("add_typed", { std::string("20"), int32_t(22) });
+		LOG(Error) << "Type mismatch not detected";
+		return 1;
+	} catch (const CommandArgumentTypeException& e) {
+		LOG(Info) << e.what();
+	}
+
+	// Commande pure : 64 arguments différents appelés en boucle, puis une variable modifiée et un cache trop petit
+	BenchPlugin plugin;
+	CommandHandle pure = plugin.getCommandHandle("scaled_sum");
+	std::vector<VariantType> pureArgs(1);
+	auto callPure = [&](size_t i) {
+		pureArgs[0] = int32_t(10000 + i % 64);
+		pure.call(pureArgs, results);
+		checksum += std::get<int64_t>(results[0]);
+	};
+	plugin.setCommandCacheCapacity(0);
+	Measure uncached = measure(ITERATIONS / 100, callPure);
+	plugin.setCommandCacheCapacity(CommandCache::DEFAULT_CAPACITY);
+	Measure cached = measure(ITERATIONS / 100, callPure);
+	plugin.setVariable("scale", int64_t(2));
+	pure.call(pureArgs, results);
+	bool invalidated = std::get<int64_t>(results[0]) == 2 * int64_t(10000 + (ITERATIONS / 100 - 1) % 64) * (10000 + (ITERATIONS / 100 - 1) % 64 - 1) / 2;
+	plugin.setCommandCacheCapacity(16 * 256);
+	measure(ITERATIONS / 100, callPure);
+	CommandCacheStats stats = plugin.getCommandCacheStats();
+
+	LOG(Info) << "Pure command, cache disabled:            " << uncached.nsPerCall << " ns/call";
+	LOG(Info) << "Pure command, 64 distinct arguments:     " << cached.nsPerCall << " ns/call";
+	LOG(Info) << "Cache: " << stats.hits << " hits, " << stats.misses << " misses, " << stats.evictions << " evictions, "
+		<< stats.invalidations << " invalidations, " << stats.entries << " entries, " << stats.bytes << "/" << stats.capacity << " bytes";
+
+	if (!invalidated || stats.invalidations == 0 || stats.evictions == 0) {
+		LOG(Error) << "Pure command cache was not invalidated or not bounded";
+		return 1;
+	}
+	if (inplaceHandle.allocations != 0 || typedHandle.allocations != 0) {
+		LOG(Error) << "Allocation-free command call path allocated " << inplaceHandle.allocations + typedHandle.allocations << " times";
+		return 1;
+	}
+	return 0;
+}
+
+int benchPipeline(PluginsManager& manager) {
+	constexpr size_t ITERATIONS = 100000;
+
+	// (x + 1) * 2 + (x + 1) * 3 : les deux multiplications sont indépendantes
+	CommandBatch batch;
+	size_t input = batch.add({ "Plugin2", "add", { 0.0, 1.0 } });
+	size_t doubled = batch.add({ "Plugin2", "mul", { 2.0 } }, { { 1, input, 0 } });
+	size_t tripled = batch.add({ "Plugin2", "mul", { 3.0 } }, { { 1, input, 0 } });
+	size_t sum = batch.add({ "Plugin2", "add", {} }, { { 0, doubled, 0 }, { 1, tripled, 0 } });
+	CommandPipeline pipeline = manager.compilePipeline(batch);
+	LOG(Info) << "Pipeline: " << pipeline.size() << " steps, " << pipeline.levels() << " levels";
+
+	bool correct = true;
+	Measure individual = measure(ITERATIONS, [&](size_t i) {
+		double x = double(i);
+		VariantType a = manager.callCommand("Plugin2", "add", { x, 1.0 })[0];
+		VariantType b = manager.callCommand("Plugin2", "mul", { 2.0, a })[0];
+		VariantType c = manager.callCommand("Plugin2", "mul", { 3.0, a })[0];
+		correct &= std::get<double>(manager.callCommand("Plugin2", "add", { b, c })[0]) == (x + 1) * 5;
+	});
+	auto runPipeline = [&](bool parallel) {
+		return measure(ITERATIONS, [&](size_t i) {
+			double x = double(i);
+			pipeline.setArgument(input, 0, x);
+			manager.runPipeline(pipeline, parallel);
+			correct &= std::get<double>(pipeline.results(sum)[0]) == (x + 1) * 5;
+		});
+	};
+	Measure sequential = runPipeline(false);
+	Measure parallel = runPipeline(true);
+
+	LOG(Info) << "Individual callCommand by name: " << individual.nsPerCall << " ns/iteration, " << individual.allocations << " allocations";
+	LOG(Info) << "Pipeline, sequential:           " << sequential.nsPerCall << " ns/iteration, " << sequential.allocations << " allocations";
+	LOG(Info) << "Pipeline, parallel:             " << parallel.nsPerCall << " ns/iteration, " << parallel.allocations << " allocations";
+
+	// Un branchement vers une étape suivante est refusé à la compilation
+	CommandBatch invalid;
+	invalid.add({ "Plugin2", "add", { 1.0 } }, { { 1, 1, 0 } });
+	invalid.add({ "Plugin2", "add", { 1.0, 2.0 } });
+	try {
+		manager.compilePipeline(invalid);
+		LOG(Error) << "Invalid pipeline accepted";
+		return 1;
+	} catch (const InvalidPipelineException& e) {
+		LOG(Info) << e.what();
+	}
+
+	if (!correct) {
+		LOG(Error) << "Pipeline results differ from individual calls";
+		return 1;
+	}
+	return 0;
+}
+
+int benchRegistry() {
+	constexpr size_t READS = 200000;
+	constexpr size_t VOLATILE = 4;
+	const size_t nbReaders = std::max<size_t>(2, std::min<size_t>(8, std::thread::hardware_concurrency()));
+
+	BenchCommands commands;
+	CommandHandle stable = commands.getCommandHandle("add_inplace");
+	const std::vector<VariantType> args{ 20, 22 };
+
+	// Lectures sans modification concurrente, comme référence
+	std::vector<VariantType> results;
+	Measure quiet = measure(READS, [&](size_t) {
+		commands.callCommand(std::string_view("add_inplace"), args, results);
+	});
+
+	// Des lecteurs appellent les commandes par leur nom pendant qu'un écrivain en ajoute et en supprime
+	std::atomic<bool> stop{false};
+	std::atomic<size_t> errors{0};
+	std::atomic<size_t> found{0};
+	std::atomic<size_t> missing{0};
+	std::atomic<int64_t> readNs{0};
+	std::atomic<size_t> writes{0};
+
+	std::thread writer([&]() {
+		for (size_t k = 0; !stop.load(std::memory_order_relaxed); ++k) {
+			std::string name = "volatile_" + std::to_string(k % VOLATILE);
+			const int value = int(k % VOLATILE);
+			commands.addCommand(name, "Commande ajoutée puis supprimée", 0, 1, [value](const CommandArgs&, std::vector<VariantType>& results) {
+				results.emplace_back(value);
+			});
+			commands.setAlias(name, "v" + std::to_string(k % VOLATILE));
+			if (!commands.removeCommand(name)) {
+				errors.fetch_add(1, std::memory_order_relaxed);
+			}
+			writes.fetch_add(1, std::memory_order_relaxed);
+		}
+	});
+
+	std::vector<std::thread> readers;
+	for (size_t r = 0; r < nbReaders; ++r) {
+		readers.emplace_back([&, r]() {
+			std::vector<VariantType> results;
+			const std::vector<VariantType> none;
+			const std::string aliases[VOLATILE] = { "v0", "v1", "v2", "v3" };
+			size_t localFound = 0, localMissing = 0, localErrors = 0;
+			auto start = std::chrono::steady_clock::now();
+			for (size_t i = 0; i < READS; ++i) {
+				stable.call(args, results);
+				localErrors += std::get<int>(results[0]) != 42;
+				const size_t k = (i + r) % VOLATILE;
+				try {
+					commands.callCommand(std::string_view(aliases[k]), none, results);
+					localErrors += std::get<int>(results[0]) != int(k);
+					++localFound;
+				} catch (const CommandNotFoundException&) {
+					++localMissing;
+				}
+			}
+			readNs.fetch_add(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count(),
+				std::memory_order_relaxed);
+			found.fetch_add(localFound, std::memory_order_relaxed);
+			missing.fetch_add(localMissing, std::memory_order_relaxed);
+			errors.fetch_add(localErrors, std::memory_order_relaxed);
+		});
+	}
+	for (auto& reader : readers) {
+		reader.join();
+	}
+	stop.store(true, std::memory_order_relaxed);
+	writer.join();
+
+	const double contended = double(readNs.load()) / double(nbReaders * READS * 2);
+	LOG(Info) << "callCommand by name, no writer:        " << quiet.nsPerCall << " ns/call, " << quiet.allocations << " allocations";
+	LOG(Info) << "Reads with concurrent writer:          " << contended << " ns/call (" << nbReaders << " readers, "
+		<< writes.load() << " add/alias/remove cycles)";
+	LOG(Info) << "Volatile commands found/missing:       " << found.load() << "/" << missing.load();
+
+	// Enregistrement de nombreuses commandes : une publication par commande, ou une seule pour tout le lot
+	constexpr size_t REGISTERED = 1000;
+	size_t registered = 0;
+	auto registerCommands = [&](bool batched) {
+		BenchCommands target;
+		if (batched) {
+			target.beginCommands();
+		}
+		Measure added = measure(REGISTERED, [&](size_t i) {
+			target.addCommand("command_" + std::to_string(i), "Commande enregistrée", 0, 0, [](const CommandArgs&, std::vector<VariantType>&) {});
+		});
+		if (batched) {
+			target.endCommands();
+		}
+		registered += target.getCommands().size();
+		return added;
+	};
+	Measure single = registerCommands(false);
+	Measure batched = registerCommands(true);
+	LOG(Info) << "addCommand, one publication each:      " << single.nsPerCall << " ns/command";
+	LOG(Info) << "addCommand, batched publication:       " << batched.nsPerCall << " ns/command";
+
+	if (errors.load() != 0 || commands.getCommands().size() != 4 || registered != 2 * (REGISTERED + 4)) {
+		LOG(Error) << errors.load() << " inconsistent reads or writes";
+		return 1;
+	}
+	return 0;
+}
+
+int benchScript(PluginsManager& manager) {
+	constexpr size_t LINES = 1000000;
+
+	const std::string_view sample =
+		"# Commentaire\n"
+		"Plugin2.add 1 2\n"
+		"Plugin2.mul 2.5 4   # commentaire en fin de ligne\n"
+		"Plugin2.add -1.5e2 0.5\n"
+		"\n"
+		"Plugin1.level = \"Debug\"\n"
+		"Plugin1.level\n"
+		"Plugin1.level = Info\n";
+	std::ostringstream output;
+	ScriptRunner checked(manager, output);
+	checked.runBuffer(sample, "<sample>");
+	if (checked.getStats().errors != 0 || output.str() != "3\n10\n-149.5\nDebug\n") {
+		LOG(Error) << "Unexpected script output: " << output.str();
+		return 1;
+	}
+
+	std::string script;
+	script.reserve(LINES * 20);
+	const std::string_view lines[] = { "Plugin2.add 1 2\n", "Plugin2.mul 2.5 4\n", "Plugin1.level = Info\n", "# Commentaire\n" };
+	for (size_t i = 0; i < LINES; ++i) {
+		script += lines[i % std::size(lines)];
+	}
+
+	std::ostream discard(nullptr);
+	ScriptRunner runner(manager, discard);
+	size_t before = allocations.load(std::memory_order_relaxed);
+	auto start = std::chrono::steady_clock::now();
+	runner.runBuffer(script, "<bench>");
+	auto elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+	const ScriptStats& stats = runner.getStats();
+
+	LOG(Info) << "Script: " << stats.lines << " lines in " << elapsed * 1000 << " ms, " << stats.lines / elapsed / 1e6 << " million lines/s";
+	LOG(Info) << "Script: " << stats.commands << " commands, " << stats.variables << " variables, " << stats.resolved << " distinct lines resolved, "
+		<< allocations.load(std::memory_order_relaxed) - before << " allocations";
+	if (stats.errors != 0) {
+		LOG(Error) << stats.errors << " script lines failed";
+		return 1;
+	}
+	return 0;
+}
+
+int benchObservers() {
+	constexpr size_t ITERATIONS = 1000000;
+	constexpr size_t UPDATES = 100000;
+
+	BenchPlugin plugin;
+	plugin.addVariable("message", "Message lu à chaque appel", std::string("Hello World, this message does not fit in a small string"));
+
+	// Relire la variable à chaque utilisation, comme le faisait Plugin1, ou garder une copie mise à jour par un observateur
+	size_t length = 0;
+	Measure polling = measure(ITERATIONS, [&](size_t) {
+		length += std::get<std::string>(plugin.getVariable("message")).size();
+	});
+	std::string cached = std::get<std::string>(plugin.getVariable("message"));
+	VariableObserver observer = plugin.observeVariable("message", [&](const VariableChange& change) {
+		cached = std::get<std::string>(change.newValue);
+	});
+	Measure observing = measure(ITERATIONS, [&](size_t) {
+		length += cached.size();
+	});
+	plugin.setVariable("message", std::string("Updated"));
+	bool correct = cached == "Updated";
+	plugin.unobserveVariable(observer);
+	plugin.setVariable("message", std::string("Not observed"));
+	correct &= cached == "Updated";
+
+	// Notifications différées : des modifications rapides sont fusionnées
+	ThreadPool executor(2);	// Un thread de travail, plus le thread appelant
+	std::atomic<size_t> notifications{0};
+	std::atomic<int64_t> last{-1};
+	int64_t first = -1;
+	plugin.observeVariable("scale", [&](const VariableChange& change) {
+		if (notifications.fetch_add(1) == 0) {
+			first = std::get<int64_t>(change.oldValue);
+		}
+		last.store(std::get<int64_t>(change.newValue));
+	}, NotificationMode::Deferred, &executor);
+	Measure updates = measure(UPDATES, [&](size_t i) {
+		plugin.setVariable("scale", int64_t(i + 2));
+	});
+	auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+	while (last.load() != int64_t(UPDATES + 1) && std::chrono::steady_clock::now() < deadline) {
+		std::this_thread::yield();
+	}
+	plugin.unobserveAll();
+	correct &= last.load() == int64_t(UPDATES + 1) && first == 1;
+
+	LOG(Info) << "getVariable on each use:            " << polling.nsPerCall << " ns/use, " << polling.allocations << " allocations";
+	LOG(Info) << "Copy refreshed by an observer:      " << observing.nsPerCall << " ns/use, " << observing.allocations << " allocations";
+	LOG(Info) << "setVariable with deferred observer: " << updates.nsPerCall << " ns/update, " << UPDATES << " updates coalesced into "
+		<< notifications.load() << " notifications";
+	LOG(Debug) << "Checksum: " << length;
+
+	if (!correct) {
+		LOG(Error) << "Observers did not receive the expected values";
+		return 1;
+	}
+	return 0;
+}
+
+int benchVariables() {
+	constexpr size_t ITERATIONS = 1000000;
+
+	BenchPlugin plugin;
+	for (int i = 0; i < 32; ++i) {
+		plugin.addVariable("padding_" + std::to_string(i), "Variable ajoutée avant celles qui sont lues", int32_t(i));
+	}
+	plugin.addVariable("message", "Message lu à chaque appel", std::string("Hello World, this message does not fit in a small string"));
+	plugin.addVariable("counter", "Compteur", int64_t(0));
+
+	size_t length = 0;
+	int64_t sum = 0;
+	Measure byName = measure(ITERATIONS, [&](size_t) {
+		length += std::get<std::string>(plugin.getVariable("message")).size();
+	});
+	VariableHandle<> message = plugin.getVariableHandle("message");
+	Measure untyped = measure(ITERATIONS, [&](size_t) {
+		length += message.view().size();
+	});
+	VariableHandle<std::string> typedMessage = plugin.getVariableHandle<std::string>("message");
+	Measure typed = measure(ITERATIONS, [&](size_t) {
+		length += typedMessage.get().size();
+	});
+
+	Measure setByName = measure(ITERATIONS, [&](size_t i) {
+		plugin.setVariable("counter", int64_t(i));
+	});
+	VariableHandle<int64_t> counter = plugin.getVariableHandle<int64_t>("counter");
+	Measure setTyped = measure(ITERATIONS, [&](size_t i) {
+		counter.set(int64_t(i));
+		sum += counter.get();
+	});
+
+	// Une variable garde son type : les conversions sans perte sont acceptées, les autres refusées
+	bool correct = plugin.setVariable("counter", int32_t(7)) && counter.get() == 7
+		&& !plugin.setVariable("counter", std::string("7")) && !plugin.setVariable("counter", 1.5)
+		&& !plugin.getVariableHandle<int32_t>("counter").ok() && !plugin.getVariableHandle("missing").ok();
+
+	LOG(Info) << "getVariable(name), by value:      " << byName.nsPerCall << " ns/read, " << byName.allocations << " allocations";
+	LOG(Info) << "VariableHandle<>::view():         " << untyped.nsPerCall << " ns/read, " << untyped.allocations << " allocations";
+	LOG(Info) << "VariableHandle<std::string>::get: " << typed.nsPerCall << " ns/read, " << typed.allocations << " allocations";
+	LOG(Info) << "setVariable(name, int64_t):       " << setByName.nsPerCall << " ns/write, " << setByName.allocations << " allocations";
+	LOG(Info) << "VariableHandle<int64_t>::set:     " << setTyped.nsPerCall << " ns/write, " << setTyped.allocations << " allocations";
+	LOG(Debug) << "Checksum: " << length + sum;
+
+	if (!correct) {
+		LOG(Error) << "Variable types were not preserved";
+		return 1;
+	}
+	return 0;
+}
+
+namespace {
+
+// Référence : toutes les lectures et écritures de variables passent par un même verrou
+class MutexVariables : public BenchPlugin {
+public:
+	VariantType getVariable(const std::string& name) const {
+		std::lock_guard<std::mutex> lock(_mutex);
+		return BenchPlugin::getVariable(name);
+	}
+
+	bool setVariable(const std::string& name, const VariantType& value) {
+		std::lock_guard<std::mutex> lock(_mutex);
+		return BenchPlugin::setVariable(name, value);
+	}
+
+private:
+	mutable std::mutex _mutex;
+};
+
+struct ConcurrentResult {
+	double nsPerRead;
+	size_t writes;
+	size_t errors;
+};
+
+// Des lecteurs lisent "counter" et "message" pendant qu'un écrivain les modifie sans arrêt
+template<typename Plugin, typename Read>
+ConcurrentResult runConcurrent(Plugin& plugin, size_t nbReaders, size_t reads, Read read) {
+	const std::string messages[2] = { "short", "a message long enough to be allocated on the heap, never torn" };
+	std::atomic<bool> stop{false};
+	std::atomic<size_t> writes{0};
+	std::atomic<size_t> errors{0};
+	std::atomic<int64_t> readNs{0};
+
+	std::thread writer([&]() {
+		for (int64_t i = 1; !stop.load(std::memory_order_relaxed); ++i) {
+			plugin.setVariable("counter", i);
+			if ((i & 15) == 0) {
+				plugin.setVariable("message", messages[(i >> 4) & 1]);
+			}
+			writes.fetch_add(1, std::memory_order_relaxed);
+		}
+	});
+	std::vector<std::thread> readers;
+	for (size_t r = 0; r < nbReaders; ++r) {
+		readers.emplace_back([&]() {
+			int64_t previous = 0;
+			size_t localErrors = 0;
+			auto start = std::chrono::steady_clock::now();
+			for (size_t i = 0; i < reads; ++i) {
+				auto [counter, message] = read(plugin);
+				// Le compteur ne recule jamais et le message est toujours l'un des deux, entier
+				localErrors += counter < previous || (message != messages[0] && message != messages[1]);
+				previous = counter;
+			}
+			readNs.fetch_add(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count());
+			errors.fetch_add(localErrors);
+		});
+	}
+	for (auto& reader : readers) {
+		reader.join();
+	}
+	stop.store(true);
+	writer.join();
+	return { double(readNs.load()) / double(nbReaders * reads), writes.load(), errors.load() };
+}
+
+} // namespace
+
+int benchConcurrentVariables() {
+	constexpr size_t READS = 200000;
+	const size_t nbReaders = std::max<size_t>(2, std::min<size_t>(8, std::thread::hardware_concurrency()));
+	const std::string initial = "short";
+
+	MutexVariables locked;
+	locked.addVariable("counter", "Compteur", int64_t(0));
+	locked.addVariable("message", "Message", initial);
+	ConcurrentResult mutex = runConcurrent(locked, nbReaders, READS, [](const MutexVariables& plugin) {
+		return std::make_pair(std::get<int64_t>(plugin.getVariable("counter")), std::get<std::string>(plugin.getVariable("message")));
+	});
+
+	BenchPlugin concurrent;
+	concurrent.addVariable("counter", "Compteur", int64_t(0));
+	concurrent.addVariable("message", "Message", initial);
+	concurrent.enableConcurrentAccess();
+	ConcurrentResult byName = runConcurrent(concurrent, nbReaders, READS, [](const BenchPlugin& plugin) {
+		return std::make_pair(std::get<int64_t>(plugin.getVariable("counter")), std::get<std::string>(plugin.getVariable("message")));
+	});
+	VariableHandle<int64_t> counter = concurrent.getVariableHandle<int64_t>("counter");
+	VariableHandle<std::string> message = concurrent.getVariableHandle<std::string>("message");
+	ConcurrentResult byHandle = runConcurrent(concurrent, nbReaders, READS, [&](const BenchPlugin&) {
+		return std::make_pair(counter.load(), message.load());
+	});
+
+	LOG(Info) << nbReaders << " reader threads, 1 writer thread";
+	LOG(Info) << "Mutex-wrapped getVariable:      " << mutex.nsPerRead << " ns/read pair, " << mutex.writes << " writes";
+	LOG(Info) << "Concurrent mode, getVariable:   " << byName.nsPerRead << " ns/read pair, " << byName.writes << " writes";
+	LOG(Info) << "Concurrent mode, handle load(): " << byHandle.nsPerRead << " ns/read pair, " << byHandle.writes << " writes";
+
+	if (mutex.errors + byName.errors + byHandle.errors != 0) {
+		LOG(Error) << byName.errors + byHandle.errors << " torn or out of order reads in concurrent mode, " << mutex.errors << " with the mutex";
+		return 1;
+	}
+	return 0;
+}
+
+int benchSnapshot() {
+	constexpr int NB_VARIABLES = 20000;
+	const fs::path file = fs::temp_directory_path() / ("bench_variables." + std::to_string(getpid()) + ".snapshot");
+
+	auto valueOf = [](int i, int64_t offset) -> VariantType {
+		switch (i % 3) {
+			case 0: return int64_t(i) + offset;
+			case 1: return double(i) / 4 + double(offset);
+			default: return "value_" + std::to_string(i + offset);
+		}
+	};
+
+	BenchPlugin plugin;
+	for (int i = 0; i < NB_VARIABLES; ++i) {
+		plugin.addVariable("var_" + std::to_string(i), "Variable enregistrée", valueOf(i, 0));
+	}
+
+	auto start = std::chrono::steady_clock::now();
+	VariablesSnapshotWriter writer;
+	writer.addPlugin("BenchPlugin", plugin);
+	bool saved = writer.save(file);
+	auto saveTime = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start);
+
+	for (int i = 0; i < NB_VARIABLES; ++i) {
+		plugin.setVariable("var_" + std::to_string(i), valueOf(i, 1));
+	}
+
+	start = std::chrono::steady_clock::now();
+	VariablesSnapshot snapshot;
+	std::string error;
+	std::vector<std::string> mismatches;
+	size_t restored = 0;
+	if (saved && snapshot.open(file, error)) {
+		restored = snapshot.restore("BenchPlugin", plugin, mismatches);
+	}
+	auto restoreTime = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start);
+
+	// scale est aussi restaurée
+	bool correct = saved && error.empty() && restored == NB_VARIABLES + 1 && mismatches.empty();;
+	for (int i = 0; correct && i < NB_VARIABLES; ++i) {
+		correct = plugin.getVariable("var_" + std::to_string(i)) == valueOf(i, 0);
+	}
+
+	// Nouvelle version du plugin : une variable renommée, une autre qui a changé de type, les autres supprimées
+	BenchPlugin changed;
+	changed.addVariable("var_0", "Variable conservée", int64_t(-1));
+	changed.addVariable("var_one", "Ancienne var_1", 0.0);
+	changed.addVariable("var_2", "Devenue un entier", int64_t(-1));
+	std::vector<std::string> changes;
+	size_t kept = snapshot.restore("BenchPlugin", changed, changes);
+	bool reported = kept == 2 && std::get<int64_t>(changed.getVariable("var_0")) == 0
+		&& std::get<int64_t>(changed.getVariable("var_2")) == -1
+		&& std::count_if(changes.begin(), changes.end(), [](const std::string& m) { return m.starts_with("BenchPlugin.var_1:"); }) == 1
+		&& std::count_if(changes.begin(), changes.end(), [](const std::string& m) { return m.starts_with("BenchPlugin.var_2: saved as"); }) == 1;
+
+	LOG(Info) << NB_VARIABLES << " variables, " << writer.size() << " bytes";
+	LOG(Info) << "Save:    " << saveTime.count() << " ms";
+	LOG(Info) << "Restore: " << restoreTime.count() << " ms (" << restored << " variables, " << mismatches.size() << " mismatches)";
+	LOG(Info) << "Changed plugin: " << kept << " restored, " << changes.size() << " mismatches reported";
+	fs::remove(file);
+
+	if (!correct || !reported) {
+		LOG(Error) << (correct ? "Mismatches were not reported" : "Restored values differ from the saved ones: " + error);
+		return 1;
+	}
+	return 0;
+}
+
+int benchConfig() {
+	constexpr int NB_PLUGINS = 50;
+	constexpr int NB_VARIABLES = 1000;
+	const fs::path file = fs::temp_directory_path() / ("bench_config." + std::to_string(getpid()) + ".ini");
+
+	// Un type par variable, fixé par sa valeur initiale
+	auto initialOf = [](int v) -> VariantType {
+		switch (v % 4) {
+			case 0: return int32_t(0);
+			case 1: return 0.0;
+			case 2: return false;
+			default: return std::string();
+		}
+	};
+	auto valueOf = [](int p, int v) -> VariantType {
+		switch (v % 4) {
+			case 0: return int32_t(p * NB_VARIABLES + v) * (v % 8 ? 1 : -1);
+			case 1: return double(v) / 8 + p;
+			case 2: return (p + v) % 3 == 0;
+			default: return v % 7 == 3 ? "say \"hi\" #" + std::to_string(v) : "value_" + std::to_string(p) + "_" + std::to_string(v);
+		}
+	};
+
+	std::vector<std::unique_ptr<BenchPlugin>> plugins;
+	std::vector<std::string> names;
+	for (int p = 0; p < NB_PLUGINS; ++p) {
+		plugins.push_back(std::make_unique<BenchPlugin>());
+		names.push_back("Config" + std::to_string(p));
+		for (int v = 0; v < NB_VARIABLES; ++v) {
+			plugins.back()->addVariable("var_" + std::to_string(v), "Variable configurée", initialOf(v));
+		}
+	}
+
+	// Plugins pairs en sections, impairs en "Plugin.variable", avec des commentaires et des erreurs aux lignes connues
+	std::vector<uint32_t> errorLines;
+	{
+		std::ofstream out(file);
+		uint32_t line = 0;
+		auto write = [&](const std::string& text) {
+			out << text << '\n';
+			++line;
+		};
+		write("# Configuration de test");
+		for (int p = 0; p < NB_PLUGINS; ++p) {
+			const bool section = p % 2 == 0;
+			write("");
+			if (section) {
+				write("[" + names[p] + "]   ; section");
+			}
+			const std::string prefix = section ? "" : names[p] + ".";
+			for (int v = 0; v < NB_VARIABLES; ++v) {
+				VariantType value = valueOf(p, v);
+				std::string text;
+				if (auto* str = std::get_if<std::string>(&value)) {
+					if (str->find('"') != std::string::npos) {
+						text = "\"";
+						for (char c : *str) {
+							text += c == '"' ? "\\\"" : std::string(1, c);
+						}
+						text += "\"";
+					} else {
+						text = *str;
+					}
+				} else if (auto* b = std::get_if<bool>(&value)) {
+					text = *b ? (v % 3 ? "true" : "yes") : (v % 3 ? "false" : "off");
+				} else {
+					text = VariantToString(value);
+				}
+				write(prefix + "var_" + std::to_string(v) + " = " + text + (v % 10 == 0 ? "   # commentaire" : ""));
+			}
+		}
+		write("Config0.missing = 1");
+		errorLines.push_back(line);
+		write("Config1.var_0 = abc");
+		errorLines.push_back(line);
+		write("ligne sans affectation");
+		errorLines.push_back(line);
+		write("Config2.var_3 = \"sans fin");
+		errorLines.push_back(line);
+	}
+
+	auto start = std::chrono::steady_clock::now();
+	ConfigFile config;
+	std::string error;
+	bool opened = config.open(file, error);
+	auto parseTime = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start);
+	std::vector<std::string> errors = config.getErrors();
+	size_t applied = 0;
+	start = std::chrono::steady_clock::now();
+	for (int p = 0; p < NB_PLUGINS; ++p) {
+		applied += config.apply(names[p], *plugins[p], errors);
+	}
+	auto applyTime = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start);
+
+	bool correct = opened && config.size() == size_t(NB_PLUGINS * NB_VARIABLES + 2) && applied == size_t(NB_PLUGINS * NB_VARIABLES);
+	for (int p = 0; correct && p < NB_PLUGINS; ++p) {
+		for (int v = 0; correct && v < NB_VARIABLES; ++v) {
+			correct = plugins[p]->getVariable("var_" + std::to_string(v)) == valueOf(p, v);
+		}
+	}
+	// Chaque erreur est signalée une fois, avec sa ligne
+	bool reported = errors.size() == errorLines.size();
+	for (uint32_t line : errorLines) {
+		const std::string where = file.string() + ":" + std::to_string(line) + ":";
+		reported &= std::count_if(errors.begin(), errors.end(), [&](const std::string& e) { return e.starts_with(where); }) == 1;
+	}
+
+	// Aujourd'hui : lecture ligne par ligne avec copies, conversion sans connaître le type, puis setVariable une par une
+	start = std::chrono::steady_clock::now();
+	{
+		std::ifstream in(file);
+		std::string line, section;
+		while (std::getline(in, line)) {
+			std::string text = line.substr(0, line.find(" #"));
+			text.erase(text.find_last_not_of(' ') + 1);
+			if (text.empty() || text[0] == '#') {
+				continue;
+			}
+			if (text[0] == '[') {
+				section = text.substr(1, text.find(']') - 1);
+				continue;
+			}
+			size_t equal = text.find(" = ");
+			if (equal == std::string::npos) {
+				continue;
+			}
+			std::string key = text.substr(0, equal);
+			std::string plugin = section;
+			if (size_t dot = key.find('.'); dot != std::string::npos) {
+				plugin = key.substr(0, dot);
+				key = key.substr(dot + 1);
+			}
+			std::string value = text.substr(equal + 3);
+			if (value == "yes" || value == "off") {
+				value = value == "yes" ? "true" : "false";
+			}
+			auto it = std::find(names.begin(), names.end(), plugin);
+			if (it != names.end()) {
+				plugins[it - names.begin()]->setVariable(key, ScriptRunner::parseLiteral(value));
+			}
+		}
+	}
+	auto naiveTime = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start);
+
+	LOG(Info) << config.size() << " entries, " << fs::file_size(file) << " bytes";
+	LOG(Info) << "Line by line, setVariable each: " << naiveTime.count() << " ms";
+	LOG(Info) << "ConfigFile: parse " << parseTime.count() << " ms, apply " << applyTime.count() << " ms (" << applied << " variables, " << errors.size() << " errors)";
+	fs::remove(file);
+
+	if (!correct || !reported) {
+		LOG(Error) << (correct ? "Configuration errors were not reported with their line" : "Configured values differ from the file: " + error);
+		for (const std::string& e : errors) {
+			LOG(Debug) << e;
+		}
+		return 1;
+	}
+	return 0;
+}
+
+namespace {
+
+// Plugin local qui refuse les valeurs négatives et compte les notifications groupées
+class ValidatedPlugin : public BenchPlugin {
+public:
+	size_t commits = 0;
+
+protected:
+	bool validateVariables(const std::vector<VariableChange>& changes, std::string& reason) override {
+		for (const VariableChange& change : changes) {
+			if (const int64_t* value = std::get_if<int64_t>(&change.newValue); value && *value < 0) {
+				reason = change.name + " must not be negative";
+				return false;
+			}
+		}
+		return true;
+	}
+
+	void variablesCommitted(const std::vector<VariableChange>&) override {
+		commits++;
+	}
+};
+
+} // namespace
+
+int benchTransaction(PluginsManager& manager) {
+	constexpr size_t NB_VARIABLES = 500;
+	constexpr size_t RECONFIGURATIONS = 200;
+	constexpr size_t COMMITS = 20000;
+
+	// Un seul plugin : setVariable une par une ou setVariables en une fois
+	ValidatedPlugin plugin;
+	std::vector<std::pair<std::string, VariantType>> values;
+	for (size_t i = 0; i < NB_VARIABLES; ++i) {
+		plugin.addVariable("var_" + std::to_string(i), "Variable de configuration", int64_t(0));
+		values.emplace_back("var_" + std::to_string(i), int64_t(0));
+	}
+	size_t notifications = 0;
+	plugin.observeVariables([&](std::span<const VariableChange>) { notifications++; });
+
+	Measure separate = measure(RECONFIGURATIONS, [&](size_t i) {
+		for (auto& [name, value] : values) {
+			plugin.setVariable(name, int64_t(i + 1));
+		}
+	});
+	const size_t separateNotifications = notifications;
+	notifications = 0;
+	Measure grouped = measure(RECONFIGURATIONS, [&](size_t i) {
+		for (auto& [name, value] : values) {
+			value = int64_t(RECONFIGURATIONS + i + 1);
+		}
+		plugin.setVariables(values);
+	});
+	const size_t commits = plugin.commits;
+
+	// Une seule valeur refusée : rien n'est modifié
+	values.back().second = int64_t(-1);
+	bool correct = !plugin.setVariables(values) && std::get<int64_t>(plugin.getVariable("var_0")) == int64_t(2 * RECONFIGURATIONS)
+		&& !plugin.setVariables({ { "var_0", int64_t(1) }, { "missing", int64_t(1) } }) && plugin.commits == commits;
+
+	// Plusieurs variables d'un plugin géré : Plugin1 refuse un niveau de log inconnu
+	VariablesTransaction rejected;
+	rejected.set("Plugin1", "message", std::string("rejected"));
+	rejected.set("Plugin1", "level", std::string("Verbose"));
+	try {
+		manager.commitVariables(rejected);
+		correct = false;
+	} catch (const VariablesTransactionException& e) {
+		LOG(Debug) << e.what();
+	}
+	correct &= std::get<std::string>(manager.getVariable("Plugin1", "message")) != "rejected";
+
+	VariablesTransaction transaction;
+	transaction.set("Plugin1", "message", std::string("Debug 0"));
+	transaction.set("Plugin1", "level", std::string("Debug"));
+	manager.commitVariables(transaction);
+
+	// Une transaction réutilisée : set remplace la valeur déjà ajoutée
+	const std::string levels[] = { "Debug", "Info" };
+	auto commitPair = [&](size_t i) {
+		transaction.set("Plugin1", "message", levels[i % 2] + " " + std::to_string(i));
+		transaction.set("Plugin1", "level", levels[i % 2]);
+		manager.commitVariables(transaction);
+	};
+	Measure committed = measure(COMMITS, commitPair);
+	Measure individual = measure(COMMITS, [&](size_t i) {
+		manager.setVariable("Plugin1", "message", levels[i % 2] + " " + std::to_string(i));
+		manager.setVariable("Plugin1", "level", levels[i % 2]);
+	});
+
+	// Lecteurs concurrents : le message commence toujours par le niveau qui l'accompagne
+	for (auto& managed : manager) {
+		if (managed.info.name == "Plugin1" && managed.instance) {
+			managed.instance->enableConcurrentAccess();
+		}
+	}
+	auto readPair = [&]() {
+		return std::make_pair(std::get<std::string>(manager.getVariable("Plugin1", "message")),
+			std::get<std::string>(manager.getVariable("Plugin1", "level")));
+	};
+	std::atomic<bool> done{false};
+	std::atomic<size_t> reads{0}, torn{0}, tornWithout{0};
+	std::vector<std::thread> readers;
+	for (size_t t = 0; t < 2; ++t) {
+		readers.emplace_back([&]() {
+			while (!done.load(std::memory_order_acquire)) {
+				auto [message, level] = manager.readVariables(readPair);
+				torn += !message.starts_with(level);
+				auto [rawMessage, rawLevel] = readPair();
+				tornWithout += !rawMessage.starts_with(rawLevel);
+				reads++;
+			}
+		});
+	}
+	for (size_t i = 0; i < COMMITS; ++i) {
+		commitPair(i);
+	}
+	done.store(true, std::memory_order_release);
+	for (std::thread& reader : readers) {
+		reader.join();
+	}
+
+	VariablesTransaction reset;
+	reset.set("Plugin1", "message", std::string("Hello World"));
+	reset.set("Plugin1", "level", std::string("Info"));
+	manager.commitVariables(reset);
+
+	LOG(Info) << NB_VARIABLES << " variables, " << RECONFIGURATIONS << " reconfigurations";
+	LOG(Info) << "setVariable one by one: " << separate.nsPerCall / 1000 << " us/reconfiguration, " << separateNotifications << " observer notifications";
+	LOG(Info) << "setVariables:           " << grouped.nsPerCall / 1000 << " us/reconfiguration, " << notifications << " observer notifications, " << commits << " grouped notifications";
+	LOG(Info) << "Plugin1, 2 variables:   " << committed.nsPerCall << " ns/commit, " << individual.nsPerCall << " ns for 2 setVariable";
+	LOG(Info) << reads.load() << " concurrent reads: " << torn.load() << " torn with readVariables, " << tornWithout.load() << " without";
+
+	if (!correct || torn != 0) {
+		LOG(Error) << (correct ? "readVariables saw a partially applied transaction" : "A rejected transaction modified variables");
+		return 1;
+	}
+	return 0;
+}
+
+namespace {
+
+// Correspondance avec un motif, par retour arrière sur le dernier '*' : référence pour vérifier l'index
+bool globMatch(std::string_view pattern, std::string_view name) {
+	size_t p = 0, n = 0, star = std::string_view::npos, resume = 0;
+	while (n < name.size()) {
+		if (p < pattern.size() && (pattern[p] == '?' || pattern[p] == name[n])) {
+			++p;
+			++n;
+		} else if (p < pattern.size() && pattern[p] == '*') {
+			star = p++;
+			resume = n;
+		} else if (star != std::string_view::npos) {
+			p = star + 1;
+			n = ++resume;
+		} else {
+			return false;
+		}
+	}
+	while (p < pattern.size() && pattern[p] == '*') {
+		++p;
+	}
+	return p == pattern.size();
+}
+
+} // namespace
+
+int benchNames(PluginsManager& manager) {
+	constexpr size_t NB_PLUGINS = 100;
+	constexpr size_t NB_VARIABLES = 100;
+	constexpr size_t QUERIES = 200;
+
+	// Plugins locaux : 100 variables et la commande scaled_sum chacun
+	std::vector<std::unique_ptr<BenchPlugin>> plugins;
+	std::vector<std::string> names;
+	for (size_t p = 0; p < NB_PLUGINS; ++p) {
+		plugins.push_back(std::make_unique<BenchPlugin>());
+		names.push_back("Sensor" + std::to_string(p));
+		for (size_t v = 0; v < NB_VARIABLES; ++v) {
+			plugins.back()->addVariable((v % 10 == 0 ? "level_" : "var_") + std::to_string(v), "Variable", int32_t(0));
+		}
+	}
+
+	auto start = std::chrono::steady_clock::now();
+	NamespaceIndex index;
+	for (size_t p = 0; p < NB_PLUGINS; ++p) {
+		plugins[p]->forEachVariableName([&](const std::string& name) {
+			index.add(names[p], name, NameKind::Variable, uint32_t(p));
+		});
+		plugins[p]->forEachCommand([&](const std::string& name) {
+			index.add(names[p], name, NameKind::Command, uint32_t(p));
+		});
+	}
+	index.build();
+	auto buildTime = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start);
+
+	// Aujourd'hui : les listes de chaque plugin sont copiées puis filtrées
+	auto scan = [&](auto&& accept) {
+		size_t found = 0;
+		for (size_t p = 0; p < NB_PLUGINS; ++p) {
+			for (const std::string& variable : plugins[p]->getVariables()) {
+				found += accept(names[p] + "." + variable);
+			}
+			for (const std::string& command : plugins[p]->getCommands()) {
+				found += accept(names[p] + "." + command);
+			}
+		}
+		return found;
+	};
+
+	bool correct = true;
+	const std::string_view prefixes[] = { "", "Sensor1", "Sensor42.", "Sensor42.var_4", "Sensor7.scaled_sum", "Sensor7.scaled_sumX", "Unknown" };
+	for (std::string_view prefix : prefixes) {
+		size_t expected = scan([&](const std::string& name) { return name.starts_with(prefix); });
+		correct &= index.forEachPrefix(prefix, NameKind::All, [](const NameEntry&) {}) == expected;
+	}
+	const std::string_view patterns[] = { "*", "Sensor*.level_*", "*.scaled_sum", "Sensor?.var_1?", "*4*2*", "Sensor1*", "*.nothing", "Sensor5.var_55" };
+	for (std::string_view pattern : patterns) {
+		size_t expected = scan([&](const std::string& name) { return globMatch(pattern, name); });
+		std::string previous;
+		size_t found = index.forEachMatch(pattern, NameKind::All, [&](const NameEntry& entry) {
+			correct &= globMatch(pattern, entry.name) && previous < entry.name;
+			previous = entry.name;
+		});
+		correct &= found == expected;
+	}
+
+	size_t checksum = 0;
+	Measure scanPrefix = measure(QUERIES, [&](size_t) {
+		checksum += scan([](const std::string& name) { return name.starts_with("Sensor42."); });
+	});
+	Measure indexPrefix = measure(QUERIES, [&](size_t) {
+		checksum += index.forEachPrefix("Sensor42.", NameKind::All, [](const NameEntry&) {});
+	});
+	Measure scanGlob = measure(QUERIES, [&](size_t) {
+		checksum += scan([](const std::string& name) { return globMatch("Sensor*.level_*", name); });
+	});
+	Measure indexGlob = measure(QUERIES, [&](size_t) {
+		checksum += index.forEachMatch("Sensor*.level_*", NameKind::All, [](const NameEntry&) {});
+	});
+
+	// Plugins gérés : variable et commande de Plugin1
+	std::vector<std::string> found;
+	manager.findNames("Plugin*.level", [&](const NameEntry& entry) { found.emplace_back(entry.name); });
+	size_t commands = manager.forEachName("Plugin1.", [](const NameEntry&) {}, NameKind::Command);
+	correct &= found == std::vector<std::string>{ "Plugin1.level" } && commands == manager.getPlugin(manager.getHandle("Plugin1"))->instance->getCommands().size();
+
+	LOG(Info) << index.size() << " names, index built in " << buildTime.count() << " us";
+	LOG(Info) << "Prefix \"Sensor42.\", copy and filter:          " << scanPrefix.nsPerCall / 1000 << " us/query, " << scanPrefix.allocations / QUERIES << " allocations";
+	LOG(Info) << "Prefix \"Sensor42.\", NamespaceIndex:           " << indexPrefix.nsPerCall / 1000 << " us/query, " << indexPrefix.allocations / QUERIES << " allocations";
+	LOG(Info) << "Pattern \"Sensor*.level_*\", copy and filter:   " << scanGlob.nsPerCall / 1000 << " us/query, " << scanGlob.allocations / QUERIES << " allocations";
+	LOG(Info) << "Pattern \"Sensor*.level_*\", NamespaceIndex:    " << indexGlob.nsPerCall / 1000 << " us/query, " << indexGlob.allocations / QUERIES << " allocations";
+	LOG(Debug) << "Checksum: " << checksum;
+
+	if (!correct) {
+		LOG(Error) << "NamespaceIndex results differ from a full scan";
+		return 1;
+	}
+	return 0;
+}
+
+int benchDerived(PluginsManager& manager) {
+	constexpr size_t READS = 200000;
+	constexpr size_t CHAIN = 50;
+	bool correct = true;
+
+	// Message formaté à partir de deux variables, comme Plugin1.formatted
+	BenchPlugin plugin;
+	plugin.addVariable("message", "Message", std::string("Hello World"));
+	plugin.addVariable("level", "Niveau", std::string("Info"));
+	size_t computations = 0;
+	auto format = [&](const std::vector<VariantType>& inputs) {
+		computations++;
+		return VariantType("[" + std::get<std::string>(inputs[0]) + "] " + std::get<std::string>(inputs[1]));
+	};
+	correct &= plugin.addDerivedVariable("formatted", "Message formaté", { "level", "message" }, format);
+	correct &= !plugin.setVariable("formatted", std::string("read only"));
+
+	// Aujourd'hui : les entrées sont relues et le message reformaté à chaque lecture
+	size_t checksum = 0;
+	Measure eager = measure(READS, [&](size_t) {
+		std::vector<VariantType> inputs{ plugin.getVariable("level"), plugin.getVariable("message") };
+		checksum += std::get<std::string>(format(inputs)).size();
+	});
+	computations = 0;
+	Measure lazy = measure(READS, [&](size_t) {
+		checksum += std::get<std::string>(plugin.getVariable("formatted")).size();
+	});
+	correct &= computations == 0;
+
+	// Beaucoup de modifications, peu de lectures : un calcul par lecture qui suit une modification
+	Measure writes = measure(READS, [&](size_t i) {
+		plugin.setVariable("message", std::string(i % 2 ? "Hello" : "World"));
+		if (i % 100 == 99) {
+			checksum += std::get<std::string>(plugin.getVariable("formatted")).size();
+		}
+	});
+	correct &= computations == READS / 100;
+	correct &= std::get<std::string>(plugin.getVariable("formatted")) == "[Info] Hello";
+
+	// Chaîne de variables dérivées : une modification marque toute la chaîne, une lecture la recalcule une fois
+	plugin.addVariable("base", "Entrée de la chaîne", int64_t(0));
+	size_t chainComputations = 0;
+	for (size_t i = 0; i < CHAIN; ++i) {
+		correct &= plugin.addDerivedVariable("chain_" + std::to_string(i), "Maillon", { i ? "chain_" + std::to_string(i - 1) : "base" },
+			[&](const std::vector<VariantType>& inputs) {
+				chainComputations++;
+				return VariantType(std::get<int64_t>(inputs[0]) + 1);
+			});
+	}
+	chainComputations = 0;
+	const std::string last = "chain_" + std::to_string(CHAIN - 1);
+	for (int64_t i = 1; i <= 1000; ++i) {
+		plugin.setVariable("base", i);
+	}
+	correct &= chainComputations == 0;
+	correct &= std::get<int64_t>(plugin.getVariable(last)) == 1000 + int64_t(CHAIN) && chainComputations == CHAIN;
+	Measure chainRead = measure(READS / 100, [&](size_t i) {
+		plugin.setVariable("base", int64_t(i));
+		checksum += std::get<int64_t>(plugin.getVariable(last));
+	});
+
+	// Cycles refusés, redéfinition valide propagée aux variables qui en dépendent
+	auto plusOne = [](const std::vector<VariantType>& inputs) { return VariantType(std::get<int64_t>(inputs[0]) + 1); };
+	correct &= !plugin.redefineVariable("chain_0", { last }, plusOne);
+	correct &= !plugin.redefineVariable("chain_0", { "chain_0" }, plusOne);
+	correct &= !plugin.redefineVariable("base", { "chain_0" }, plusOne);
+	correct &= plugin.redefineVariable("chain_0", { "base" }, [](const std::vector<VariantType>& inputs) {
+		return VariantType(std::get<int64_t>(inputs[0]) + 100);
+	});
+	plugin.setVariable("base", int64_t(0));
+	correct &= std::get<int64_t>(plugin.getVariable(last)) == 99 + int64_t(CHAIN);
+
+	// Entrée d'un autre objet : la variable garde sa dernière valeur quand il disparaît
+	{
+		auto source = std::make_unique<BenchPlugin>();
+		correct &= plugin.addDerivedVariable("double_scale", "Double de scale d'un autre plugin", { VariableSource(*source, "scale") },
+			[](const std::vector<VariantType>& inputs) { return VariantType(std::get<int64_t>(inputs[0]) * 2); });
+		source->setVariable("scale", int64_t(21));
+		correct &= std::get<int64_t>(plugin.getVariable("double_scale")) == 42;
+		source.reset();
+		correct &= std::get<int64_t>(plugin.getVariable("double_scale")) == 42;
+	}
+
+	// Mode concurrent : lectures depuis plusieurs threads pendant les modifications
+	plugin.enableConcurrentAccess();
+	std::atomic<bool> stop{false};
+	std::atomic<size_t> inconsistent{0};
+	std::vector<std::thread> readers;
+	for (int t = 0; t < 3; ++t) {
+		readers.emplace_back([&]() {
+			while (!stop.load(std::memory_order_relaxed)) {
+				std::string text = std::get<std::string>(plugin.getVariable("formatted"));
+				if (text != "[Info] Hello" && text != "[Info] World") {
+					inconsistent.fetch_add(1, std::memory_order_relaxed);
+				}
+			}
+		});
+	}
+	for (size_t i = 0; i < READS / 10; ++i) {
+		plugin.setVariable("message", std::string(i % 2 ? "Hello" : "World"));
+	}
+	stop = true;
+	for (auto& reader : readers) {
+		reader.join();
+	}
+	correct &= inconsistent == 0 && std::get<std::string>(plugin.getVariable("formatted")) == "[Info] Hello";
+
+	// Plugins gérés : variable de Plugin2 calculée à partir de Plugin1.formatted
+	correct &= manager.addDerivedVariable("Plugin2", "formatted_length", "Longueur du message formaté de Plugin1", { "Plugin1.formatted" },
+		[](const std::vector<VariantType>& inputs) { return VariantType(int64_t(std::get<std::string>(inputs[0]).size())); });
+	manager.setVariable("Plugin1", "message", std::string("abc"));
+	correct &= std::get<std::string>(manager.getVariable("Plugin1", "formatted")) == "[Info] abc";
+	correct &= std::get<int64_t>(manager.getVariable("Plugin2", "formatted_length")) == 10;
+
+	LOG(Info) << "Read formatted message, recomputed on every read: " << eager.nsPerCall << " ns/read, " << eager.allocations / READS << " allocations";
+	LOG(Info) << "Read formatted message, derived variable:         " << lazy.nsPerCall << " ns/read, " << lazy.allocations / READS << " allocations";
+	LOG(Info) << "Set input, read every 100 sets:                   " << writes.nsPerCall << " ns/set, " << READS / 100 << " computations for " << READS << " sets";
+	LOG(Info) << "Set input then read end of a " << CHAIN << "-variable chain:   " << chainRead.nsPerCall / 1000 << " us";
+	LOG(Debug) << "Checksum: " << checksum;
+
+	if (!correct) {
+		LOG(Error) << "Derived variables returned a wrong value or were recomputed too often";
+		return 1;
+	}
+	return 0;
+}
@@ -0,0 +1,99 @@
+/**
+ * @file Benchmarks.hpp
+ * @author ClemtoClem
+ * @date 17/10/2026
+ */
+
+#ifndef BENCHMARKS_HPP
+#define BENCHMARKS_HPP
+
+class PluginsManager;
+
+/**
+ * @brief Mesurer le coût d'un appel de commande (option --bench-commands)
+ * Compare l'appel historique, qui renvoie un vecteur, à l'appel par CommandHandle qui réutilise le vecteur
+ * des résultats, et compte les allocations faites pendant les appels.
+ * @return Code de retour du programme, non nul si l'appel sans allocation a alloué
+ */
+int benchCommands();
+
+/**
+ * @brief Mesurer un pipeline de commandes de Plugin2 (option --bench-pipeline)
+ * Compare des appels individuels par nom au même calcul compilé en pipeline, exécuté en séquence puis en parallèle.
+ * @param[in] manager Gestionnaire dont les plugins sont initialisés
+ * @return Code de retour du programme, non nul si les résultats diffèrent ou si un lot invalide est accepté
+ */
+int benchPipeline(PluginsManager& manager);
+
+/**
+ * @brief Appeler des commandes depuis plusieurs threads pendant qu'un autre en ajoute et en supprime (option --bench-registry)
+ * @return Code de retour du programme, non nul si un appel a renvoyé un résultat incohérent
+ */
+int benchRegistry();
+
+/**
+ * @brief Mesurer l'exécution d'un script de commandes et de variables (option --bench-script)
+ * Vérifie d'abord les résultats d'un court script, puis exécute un script d'un million de lignes sans écrire la sortie.
+ * @param[in] manager Gestionnaire dont les plugins sont initialisés
+ * @return Code de retour du programme, non nul si une ligne est en erreur ou si un résultat diffère
+ */
+int benchScript(PluginsManager& manager);
+
+/**
+ * @brief Comparer la relecture d'une variable à un observateur, et fusionner des notifications différées (option --bench-observers)
+ * @return Code de retour du programme, non nul si un observateur n'a pas reçu les valeurs attendues
+ */
+int benchObservers();
+
+/**
+ * @brief Comparer les lectures et écritures de variables par nom et par VariableHandle (option --bench-variables)
+ * @return Code de retour du programme, non nul si une variable a changé de type
+ */
+int benchVariables();
+
+/**
+ * @brief Lire des variables depuis plusieurs threads pendant qu'un autre les modifie (option --bench-concurrent-variables)
+ * Compare le mode concurrent, sans verrou pour les lecteurs, à un VariablesListener protégé par un mutex.
+ * @return Code de retour du programme, non nul si une lecture a vu une valeur incohérente
+ */
+int benchConcurrentVariables();
+
+/**
+ * @brief Enregistrer puis restaurer 20000 variables depuis un instantané binaire (option --bench-snapshot)
+ * Vérifie aussi que les variables renommées ou dont le type a changé sont signalées.
+ * @return Code de retour du programme, non nul si une valeur n'a pas été restaurée
+ */
+int benchSnapshot();
+
+/**
+ * @brief Lire et appliquer un fichier de configuration de 50000 variables (option --bench-config)
+ * Compare à une lecture ligne par ligne avec copies, et vérifie les valeurs et les erreurs signalées avec leur ligne.
+ * @return Code de retour du programme, non nul si une valeur n'a pas été appliquée ou une erreur pas signalée
+ */
+int benchConfig();
+
+/**
+ * @brief Modifier des variables une par une ou par transaction (option --bench-transaction)
+ * Vérifie aussi qu'une transaction refusée ne modifie rien et que readVariables ne voit jamais de transaction à moitié appliquée.
+ * @param[in] manager Gestionnaire dont les plugins sont initialisés
+ * @return Code de retour du programme, non nul si une vérification a échoué
+ */
+int benchTransaction(PluginsManager& manager);
+
+/**
+ * @brief Rechercher des noms de variables et de commandes par préfixe et par motif (option --bench-names)
+ * Compare l'index en arbre radix à la copie puis au filtrage des listes de chaque plugin, et vérifie ses résultats.
+ * @param[in] manager Gestionnaire dont les plugins sont initialisés
+ * @return Code de retour du programme, non nul si l'index et le parcours complet diffèrent
+ */
+int benchNames(PluginsManager& manager);
+
+/**
+ * @brief Lire des variables dérivées, recalculées seulement après une modification de leurs entrées (option --bench-derived)
+ * Compare au recalcul à chaque lecture, et vérifie la propagation dans une chaîne, le refus des cycles et les entrées d'un autre plugin.
+ * @param[in] manager Gestionnaire dont les plugins sont initialisés
+ * @return Code de retour du programme, non nul si une valeur est fausse ou si une variable a été recalculée inutilement
+ */
+int benchDerived(PluginsManager& manager);
+
+#endif // BENCHMARKS_HPP
@@ -0,0 +1,114 @@
+#include <sstream>
+#include "CommandStatsReport.hpp"
+#include "Json.hpp"
+
+namespace {
+	constexpr double QUANTILES[] = { 0.5, 0.9, 0.99, 0.999 };
+	constexpr const char* QUANTILE_NAMES[] = { "p50_ns", "p90_ns", "p99_ns", "p999_ns" };
+
+	// Étiquettes Prometheus : les guillemets, antislashs et retours à la ligne sont échappés
+	void writeLabel(std::ostringstream& out, const std::string& value) {
+		for (char c : value) {
+			if (c == '"' || c == '\\') {
+				out << '\\' << c;
+			} else if (c == '\n') {
+				out << "\\n";
+			} else {
+				out << c;
+			}
+		}
+	}
+
+	void writeLabels(std::ostringstream& out, const std::string& plugin, const std::string& command) {
+		out << "{plugin=\"";
+		writeLabel(out, plugin);
+		out << "\",command=\"";
+		writeLabel(out, command);
+		out << '"';
+	}
+}
+
+std::string toJson(const PluginCommandStats& plugins) {
+	std::ostringstream out;
+	out << "{\"enabled\": " << (COMMAND_STATS ? "true" : "false") << ", \"plugins\": [";
+	for (size_t p = 0; p < plugins.size(); ++p) {
+		out << (p ? ", " : "") << "{\"name\": ";
+		writeJsonString(out, plugins[p].first);
+		out << ", \"commands\": [";
+		const auto& commands = plugins[p].second;
+		for (size_t c = 0; c < commands.size(); ++c) {
+			const CommandStatsSnapshot& stats = commands[c];
+			out << (c ? ", " : "") << "{\"name\": ";
+			writeJsonString(out, stats.command);
+			out << ", \"calls\": " << stats.calls << ", \"argument_errors\": " << stats.argumentErrors
+				<< ", \"exceptions\": " << stats.exceptions << ", \"total_ns\": " << stats.totalNs << ", \"max_ns\": " << stats.maxNs;
+			for (size_t q = 0; q < std::size(QUANTILES); ++q) {
+				out << ", \"" << QUANTILE_NAMES[q] << "\": " << stats.percentile(QUANTILES[q]);
+			}
+			out << '}';
+		}
+		out << "]}";
+	}
+	out << "]}";
+	return out.str();
+}
+
+std::string toPrometheus(const PluginCommandStats& plugins) {
+	std::ostringstream out;
+	out << "# HELP plugin_command_calls_total Number of command calls, errors included.\n"
+		<< "# TYPE plugin_command_calls_total counter\n";
+	for (const auto& [plugin, commands] : plugins) {
+		for (const CommandStatsSnapshot& stats : commands) {
+			out << "plugin_command_calls_total";
+			writeLabels(out, plugin, stats.command);
+			out << "} " << stats.calls << '\n';
+		}
+	}
+
+	out << "# HELP plugin_command_errors_total Number of failed command calls.\n"
+		<< "# TYPE plugin_command_errors_total counter\n";
+	for (const auto& [plugin, commands] : plugins) {
+		for (const CommandStatsSnapshot& stats : commands) {
+			out << "plugin_command_errors_total";
+			writeLabels(out, plugin, stats.command);
+			out << ",kind=\"arguments\"} " << stats.argumentErrors << '\n';
+			out << "plugin_command_errors_total";
+			writeLabels(out, plugin, stats.command);
+			out << ",kind=\"exception\"} " << stats.exceptions << '\n';
+		}
+	}
+
+	out << "# HELP plugin_command_latency_seconds Command call latency.\n"
+		<< "# TYPE plugin_command_latency_seconds histogram\n";
+	for (const auto& [plugin, commands] : plugins) {
+		for (const CommandStatsSnapshot& stats : commands) {
+			// Les intervalles de l'histogramme commencent aux puissances de 2 : les cumuls y sont exacts.
+			// Les durées au-delà de la dernière borne (LatencyHistogram::OVERFLOW_BUCKET) ne comptent que dans +Inf
+			uint64_t cumulative = 0;
+			size_t bucket = 0;
+			for (unsigned exponent = LatencyHistogram::SUB_BITS; exponent <= LatencyHistogram::MAX_EXPONENT; ++exponent) {
+				size_t end = (exponent - LatencyHistogram::SUB_BITS + 1) * LatencyHistogram::SUB_BUCKETS;
+				for (; bucket < end && bucket < stats.buckets.size(); ++bucket) {
+					cumulative += stats.buckets[bucket];
+				}
+				out << "plugin_command_latency_seconds_bucket";
+				writeLabels(out, plugin, stats.command);
+				out << ",le=\"" << static_cast<double>(uint64_t(1) << exponent) * 1e-9 << "\"} " << cumulative << '\n';
+			}
+			uint64_t count = 0;
+			for (uint64_t value : stats.buckets) {
+				count += value;
+			}
+			out << "plugin_command_latency_seconds_bucket";
+			writeLabels(out, plugin, stats.command);
+			out << ",le=\"+Inf\"} " << count << '\n';
+			out << "plugin_command_latency_seconds_sum";
+			writeLabels(out, plugin, stats.command);
+			out << "} " << static_cast<double>(stats.totalNs) * 1e-9 << '\n';
+			out << "plugin_command_latency_seconds_count";
+			writeLabels(out, plugin, stats.command);
+			out << "} " << count << '\n';
+		}
+	}
+	return out.str();
+}
@@ -0,0 +1,34 @@
+/**
+ * @file CommandStatsReport.hpp
+ * @author ClemtoClem
+ * @date 17/10/2026
+ */
+
+#ifndef COMMANDSTATSREPORT_HPP
+#define COMMANDSTATSREPORT_HPP
+
+#include <string>
+#include <utility>
+#include <vector>
+#include "../../common/src/CommandStats.hpp"
+
+using PluginCommandStats = std::vector<std::pair<std::string, std::vector<CommandStatsSnapshot>>>;	///< Nom du plugin -> statistiques de ses commandes
+
+/**
+ * @brief Fonction pour écrire les statistiques des commandes en JSON
+ * Pour chaque commande : appels, erreurs, durées totale et maximale, et centiles 50, 90, 99 et 99.9 en nanosecondes.
+ * @param[in] plugins Statistiques par plugin
+ * @return Rapport JSON
+ */
+std::string toJson(const PluginCommandStats& plugins);
+
+/**
+ * @brief Fonction pour écrire les statistiques des commandes au format texte de Prometheus
+ * Compteurs plugin_command_calls_total et plugin_command_errors_total, histogramme plugin_command_latency_seconds
+ * dont les bornes sont les puissances de 2 en nanosecondes.
+ * @param[in] plugins Statistiques par plugin
+ * @return Métriques Prometheus
+ */
+std::string toPrometheus(const PluginCommandStats& plugins);
+
+#endif // COMMANDSTATSREPORT_HPP
@@ -0,0 +1,322 @@
+#include <algorithm>
+#include <array>
+#include <charconv>
+#include <cstring>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "ConfigFile.hpp"
+
+namespace {
+	// Boucles simples plutôt que find_first_not_of : appelées plusieurs fois par ligne, sur quelques caractères
+	bool isBlank(char c) {
+		return c == ' ' || c == '\t' || c == '\r';
+	}
+
+	std::string_view trim(std::string_view text) {
+		size_t first = 0, last = text.size();
+		while (first < last && isBlank(text[first])) {
+			++first;
+		}
+		while (last > first && isBlank(text[last - 1])) {
+			--last;
+		}
+		return text.substr(first, last - first);
+	}
+
+	bool isComment(std::string_view text) {
+		return !text.empty() && (text.front() == '#' || text.front() == ';');
+	}
+
+	std::string unescape(std::string_view text) {
+		std::string result;
+		result.reserve(text.size());
+		for (size_t i = 0; i < text.size(); ++i) {
+			if (text[i] != '\\' || i + 1 == text.size()) {
+				result.push_back(text[i]);
+				continue;
+			}
+			switch (text[++i]) {
+				case 'n': result.push_back('\n'); break;
+				case 't': result.push_back('\t'); break;
+				default: result.push_back(text[i]); break;	// \" et \\ notamment
+			}
+		}
+		return result;
+	}
+
+	template<typename T>
+	bool parseNumber(std::string_view text, T& value) {
+		// from_chars n'accepte pas le signe '+'
+		if (!text.empty() && text.front() == '+') {
+			text.remove_prefix(1);
+		}
+		if (text.empty()) {
+			return false;
+		}
+		const char* end = text.data() + text.size();
+		std::from_chars_result result;
+		if constexpr (std::is_integral_v<T>) {
+			if (text.size() > 2 && text[0] == '0' && (text[1] == 'x' || text[1] == 'X')) {
+				result = std::from_chars(text.data() + 2, end, value, 16);
+			} else {
+				result = std::from_chars(text.data(), end, value);
+			}
+		} else {
+			result = std::from_chars(text.data(), end, value);
+		}
+		return result.ec == std::errc() && result.ptr == end;
+	}
+
+	bool parseBool(std::string_view text, bool& value) {
+		if (text == "true" || text == "yes" || text == "on" || text == "1") {
+			value = true;
+			return true;
+		}
+		if (text == "false" || text == "no" || text == "off" || text == "0") {
+			value = false;
+			return true;
+		}
+		return false;
+	}
+
+	/**
+	 * @brief Valeur par défaut de chaque type de VariantType, le type d'une variable étant connu par sa position
+	 */
+	const VariantType& defaultValue(size_t index) {
+		static const auto defaults = []<typename... Ts>(std::variant<Ts...>*) {
+			return std::array<VariantType, sizeof...(Ts)>{ VariantType(std::in_place_type<Ts>)... };
+		}(static_cast<VariantType*>(nullptr));
+		return defaults[index];
+	}
+}
+
+ConfigFile::~ConfigFile() {
+	close();
+}
+
+void ConfigFile::close() {
+	if (_map) {
+		munmap(_map, _mapSize);
+		_map = nullptr;
+	}
+	_mapSize = 0;
+	_data = {};
+	_entries.clear();
+	_plugins.clear();
+	_order.clear();
+	_errors.clear();
+}
+
+bool ConfigFile::open(const fs::path& file, std::string& error) {
+	// Un second fichier remplace le premier
+	close();
+	int fd = ::open(file.c_str(), O_RDONLY | O_CLOEXEC);
+	if (fd < 0) {
+		error = std::string("cannot open file: ") + strerror(errno);
+		return false;
+	}
+	struct stat st;
+	if (fstat(fd, &st) != 0) {
+		::close(fd);
+		error = std::string("cannot read file: ") + strerror(errno);
+		return false;
+	}
+	_name = file.string();
+	_mapSize = static_cast<size_t>(st.st_size);
+	if (_mapSize >= NONE) {
+		::close(fd);
+		error = "file too large";
+		return false;
+	}
+	if (_mapSize == 0) {
+		::close(fd);
+		return true;	// Fichier vide : rien à configurer
+	}
+	_map = mmap(nullptr, _mapSize, PROT_READ, MAP_PRIVATE, fd, 0);
+	::close(fd);
+	if (_map == MAP_FAILED) {
+		_map = nullptr;
+		error = std::string("cannot map file: ") + strerror(errno);
+		return false;
+	}
+	madvise(_map, _mapSize, MADV_SEQUENTIAL);
+	_data = std::string_view(static_cast<const char*>(_map), _mapSize);
+	parse();
+	return true;
+}
+
+void ConfigFile::parse() {
+	std::string_view data = _data;
+	std::string_view section;
+	// Les affectations d'un même plugin se suivent en général : pas de recherche tant qu'il ne change pas
+	std::string_view current;
+	Group* group = nullptr;
+	auto add = [&](std::string_view plugin, const Entry& entry) {
+		if (!group || plugin != current) {
+			auto it = _plugins.find(plugin);
+			if (it == _plugins.end()) {
+				it = _plugins.emplace(std::string(plugin), Group{ NONE, NONE, 0 }).first;
+				_order.emplace_back(plugin);
+			}
+			current = plugin;
+			group = &it->second;
+		}
+		const uint32_t index = static_cast<uint32_t>(_entries.size());
+		_entries.push_back(entry);
+		if (group->last != NONE) {
+			_entries[group->last].next = index;
+		} else {
+			group->first = index;
+		}
+		group->last = index;
+		group->count++;
+	};
+	// Au plus une affectation par ligne
+	_entries.reserve(std::count(data.begin(), data.end(), '\n') + 1);
+
+	uint32_t line = 0;
+	while (!data.empty()) {
+		++line;
+		const size_t eol = data.find('\n');
+		std::string_view text = trim(data.substr(0, eol));
+		data.remove_prefix(eol == std::string_view::npos ? data.size() : eol + 1);
+		if (text.empty() || isComment(text)) {
+			continue;
+		}
+
+		if (text.front() == '[') {
+			const size_t close = text.find(']');
+			section = close == std::string_view::npos ? std::string_view() : trim(text.substr(1, close - 1));
+			std::string_view rest = close == std::string_view::npos ? std::string_view() : trim(text.substr(close + 1));
+			if (section.empty() || section.find('.') != std::string_view::npos || (!rest.empty() && !isComment(rest))) {
+				_errors.push_back(where(line) + ": invalid section header '" + std::string(text) + "'");
+				section = {};
+			}
+			continue;
+		}
+
+		const size_t equal = text.find('=');
+		if (equal == std::string_view::npos) {
+			_errors.push_back(where(line) + ": expected 'variable = value'");
+			continue;
+		}
+		std::string_view key = trim(text.substr(0, equal));
+		std::string_view value = trim(text.substr(equal + 1));
+		auto offset = [&](std::string_view text) { return static_cast<uint32_t>(text.data() - _data.data()); };
+		Entry entry{ 0, 0, 0, line, NONE, 0, false };
+		if (!value.empty() && value.front() == '"') {
+			size_t close = 1;
+			while (close < value.size() && value[close] != '"') {
+				close += value[close] == '\\' ? 2 : 1;
+			}
+			if (close >= value.size()) {
+				_errors.push_back(where(line) + ": unterminated string");
+				continue;
+			}
+			std::string_view rest = trim(value.substr(close + 1));
+			if (!rest.empty() && !isComment(rest)) {
+				_errors.push_back(where(line) + ": unexpected '" + std::string(rest) + "' after the string");
+				continue;
+			}
+			value = value.substr(1, close - 1);
+			entry.quoted = true;
+		} else {
+			// Un commentaire en fin de ligne est précédé d'une espace : "a#b" reste une valeur
+			size_t comment = 0;
+			while (comment < value.size() && !((value[comment] == '#' || value[comment] == ';') && (comment == 0 || isBlank(value[comment - 1])))) {
+				++comment;
+			}
+			value = trim(value.substr(0, comment));
+		}
+		entry.value = offset(value);
+		entry.valueLength = static_cast<uint32_t>(value.size());
+
+		std::string_view plugin = section;
+		if (const size_t dot = key.find('.'); dot != std::string_view::npos) {
+			plugin = key.substr(0, dot);
+			key = key.substr(dot + 1);
+		}
+		if (plugin.empty() || key.empty()) {
+			_errors.push_back(where(line) + (section.empty() ? ": expected 'Plugin.variable' outside a section" : ": invalid variable name"));
+			continue;
+		}
+		if (key.size() > UINT16_MAX) {
+			_errors.push_back(where(line) + ": variable name too long");
+			continue;
+		}
+		entry.variable = offset(key);
+		entry.variableLength = static_cast<uint16_t>(key.size());
+		add(plugin, entry);
+	}
+}
+
+uint32_t ConfigFile::getLine(std::string_view plugin) const {
+	auto it = _plugins.find(plugin);
+	return it != _plugins.end() ? _entries[it->second.first].line : 0;
+}
+
+size_t ConfigFile::apply(std::string_view plugin, VariablesListener& variables, std::vector<std::string>& errors) const {
+	auto it = _plugins.find(plugin);
+	if (it == _plugins.end()) {
+		return 0;
+	}
+	auto reject = [&](const Entry& entry, const std::string& reason) {
+		errors.push_back(where(entry.line) + ": " + std::string(plugin) + "." + std::string(variableOf(entry)) + ": " + reason);
+	};
+
+	std::vector<std::pair<VariableHandle<>, VariantType>> values;
+	values.reserve(it->second.count);
+	// Un fichier suit en général l'ordre de déclaration des variables : chaque recherche part de la précédente
+	VariableHandle<> previous;
+	for (uint32_t index = it->second.first; index != NONE; index = _entries[index].next) {
+		const Entry& entry = _entries[index];
+		const std::string_view text = valueOf(entry);
+		VariableHandle<> handle = variables.getVariableHandle(variableOf(entry), previous);
+		if (!handle.ok()) {
+			reject(entry, "unknown variable");
+			continue;
+		}
+		previous = handle;
+		if (handle.derived()) {
+			reject(entry, "derived variable, it cannot be set");
+			continue;
+		}
+		// Conversion directe dans le type de la variable : "42" donne un uint8_t comme un double
+		VariantType value = defaultValue(handle.type());
+		bool parsed = std::visit([&](auto& v) {
+			using T = std::decay_t<decltype(v)>;
+			if constexpr (std::is_same_v<T, std::string>) {
+				v = entry.quoted ? unescape(text) : std::string(text);
+				return true;
+			} else if constexpr (std::is_same_v<T, bool>) {
+				return !entry.quoted && parseBool(text, v);
+			} else if constexpr (std::is_arithmetic_v<T>) {
+				return !entry.quoted && parseNumber(text, v);
+			} else {
+				return false;	// Une adresse ne se configure pas
+			}
+		}, value);
+		if (!parsed) {
+			reject(entry, "'" + std::string(text) + "' is not a valid " + VariantIndexName(handle.type()));
+			continue;
+		}
+		values.emplace_back(handle, std::move(value));
+	}
+	const size_t count = values.size();
+	if (count == 0) {
+		return 0;
+	}
+
+	// Un seul lot par plugin, avec les variables déjà trouvées : validation d'ensemble et une seule notification groupée
+	PreparedVariables prepared;
+	std::string error;
+	if (!variables.prepareVariables(std::move(values), prepared, error)) {
+		errors.push_back(where(_entries[it->second.first].line) + ": configuration of plugin '" + std::string(plugin) + "' rejected: " + error);
+		return 0;
+	}
+	variables.applyVariables(prepared);
+	variables.notifyVariables(prepared);
+	return count;
+}
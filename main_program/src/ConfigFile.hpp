@@ -0,0 +1,148 @@
+/**
+ * @file ConfigFile.hpp
+ * @author ClemtoClem
+ * @date 17/10/2026
+ */
+
+#ifndef CONFIG_FILE_HPP
+#define CONFIG_FILE_HPP
+
+#include <chrono>
+#include <filesystem>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "../../common/src/StringHash.hpp"
+#include "../../common/src/VariablesListener.hpp"
+
+namespace fs = std::filesystem;
+
+/**
+ * @brief Résultat de l'application d'un fichier de configuration
+ */
+struct ConfigReport {
+	size_t plugins = 0;						///< Plugins configurés
+	size_t applied = 0;						///< Variables affectées
+	size_t pending = 0;						///< Plugins pas encore activés, configurés à leur activation
+	std::vector<std::string> errors;		///< Lignes ignorées, "fichier:ligne: raison"
+	std::chrono::nanoseconds duration{0};	///< Durée de la lecture et de l'application
+};
+
+/**
+ * @brief Fichier de configuration des variables des plugins, projeté en mémoire
+ *
+ * Format texte, une affectation par ligne :
+ * @code
+ * # Commentaire (ou ;)
+ * Plugin1.message = "Bonjour"	# Plugin.variable = valeur
+ *
+ * [Plugin1]					# Section : les noms suivants sont ceux des variables de Plugin1
+ * level = Warning
+ * @endcode
+ * Le fichier est lu en une seule passe, sans copie : les noms et les valeurs restent des positions dans la projection.
+ * Une valeur n'est convertie qu'à l'application, directement dans le type de la variable (std::from_chars pour
+ * les nombres, true/false, yes/no, on/off ou 1/0 pour les booléens, guillemets facultatifs pour les chaînes).
+ */
+class ConfigFile {
+public:
+	ConfigFile() = default;
+	~ConfigFile();
+
+	ConfigFile(const ConfigFile&) = delete;
+	ConfigFile& operator=(const ConfigFile&) = delete;
+
+	/**
+	 * @brief Projeter un fichier en mémoire et l'analyser
+	 * Les lignes mal formées sont ignorées et signalées dans getErrors(). Le fichier ouvert avant est d'abord fermé.
+	 * @param[in] file Fichier de configuration
+	 * @param[out] error Raison de l'échec
+	 * @return true si le fichier a été lu, false s'il n'a pas pu être ouvert
+	 */
+	bool open(const fs::path& file, std::string& error);
+
+	/**
+	 * @brief Libérer la projection et oublier les affectations lues
+	 */
+	void close();
+
+	/**
+	 * @brief Lignes mal formées, "fichier:ligne: raison"
+	 */
+	const std::vector<std::string>& getErrors() const noexcept { return _errors; }
+
+	/**
+	 * @brief Nombre d'affectations lues
+	 */
+	size_t size() const noexcept { return _entries.size(); }
+
+	/**
+	 * @brief Savoir si le fichier configure un plugin
+	 * @param[in] plugin Nom du plugin
+	 * @return true si au moins une variable du plugin est affectée
+	 */
+	bool contains(std::string_view plugin) const { return _plugins.find(plugin) != _plugins.end(); }
+
+	/**
+	 * @brief Noms des plugins configurés, dans l'ordre de leur première affectation
+	 */
+	const std::vector<std::string>& getPlugins() const noexcept { return _order; }
+
+	/**
+	 * @brief Ligne de la première affectation d'un plugin, pour les messages
+	 * @param[in] plugin Nom du plugin
+	 * @return Numéro de ligne, 0 si le plugin n'est pas configuré
+	 */
+	uint32_t getLine(std::string_view plugin) const;
+
+	/**
+	 * @brief Appliquer d'un seul bloc les valeurs d'un plugin à ses variables (VariablesListener::prepareVariables)
+	 * Une variable inconnue, dérivée ou dont la valeur ne convient pas à son type est ignorée et signalée.
+	 * Si le plugin refuse l'ensemble (validateVariables), rien n'est modifié.
+	 * @param[in] plugin Nom du plugin
+	 * @param[in,out] variables Variables du plugin
+	 * @param[out] errors Affectations non appliquées, "fichier:ligne: raison"
+	 * @return Nombre de variables affectées
+	 */
+	size_t apply(std::string_view plugin, VariablesListener& variables, std::vector<std::string>& errors) const;
+
+private:
+	static constexpr uint32_t NONE = UINT32_MAX;
+
+	/**
+	 * @brief Affectation, en positions dans le fichier : 24 octets au lieu de deux string_view
+	 */
+	struct Entry {
+		uint32_t variable;			///< Position du nom de la variable
+		uint32_t value;				///< Position de la valeur, sans les guillemets ; séquences d'échappement pas encore traitées
+		uint32_t valueLength;
+		uint32_t line;
+		uint32_t next;				///< Affectation suivante du même plugin dans _entries, NONE pour la dernière
+		uint16_t variableLength;
+		bool quoted;
+	};
+
+	/**
+	 * @brief Affectations d'un plugin, chaînées dans _entries dans l'ordre du fichier
+	 */
+	struct Group {
+		uint32_t first;
+		uint32_t last;
+		uint32_t count;
+	};
+
+	void* _map = nullptr;
+	size_t _mapSize = 0;
+	std::string_view _data;					///< Contenu du fichier, dans la projection
+	std::string _name;						///< Nom du fichier, pour les messages
+	std::vector<Entry> _entries;			///< Toutes les affectations, une allocation pour tout le fichier
+	StringMap<Group> _plugins;
+	std::vector<std::string> _order;
+	std::vector<std::string> _errors;
+
+	void parse();
+	std::string_view variableOf(const Entry& entry) const { return _data.substr(entry.variable, entry.variableLength); }
+	std::string_view valueOf(const Entry& entry) const { return _data.substr(entry.value, entry.valueLength); }
+	std::string where(uint32_t line) const { return _name + ":" + std::to_string(line); }
+};
+
+#endif // CONFIG_FILE_HPP
@@ -0,0 +1,18 @@
+#include <cstdio>
+#include "Json.hpp"
+
+void writeJsonString(std::ostream& out, std::string_view text) {
+	out << '"';
+	for (unsigned char c : text) {
+		if (c == '"' || c == '\\') {
+			out << '\\' << c;
+		} else if (c < 0x20) {
+			char escaped[8];
+			std::snprintf(escaped, sizeof(escaped), "\\u%04x", c);
+			out << escaped;
+		} else {
+			out << c;
+		}
+	}
+	out << '"';
+}
@@ -0,0 +1,20 @@
+/**
+ * @file Json.hpp
+ * @author ClemtoClem
+ * @date 17/10/2026
+ */
+
+#ifndef JSON_HPP
+#define JSON_HPP
+
+#include <ostream>
+#include <string_view>
+
+/**
+ * @brief Fonction pour écrire une chaîne JSON, entre guillemets et échappée
+ * @param[in] out Flux de sortie
+ * @param[in] text Texte à écrire
+ */
+void writeJsonString(std::ostream& out, std::string_view text);
+
+#endif // JSON_HPP
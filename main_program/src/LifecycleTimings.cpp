@@ -0,0 +1,75 @@
+#include <algorithm>
+#include <sstream>
+#include "Json.hpp"
+#include "LifecycleTimings.hpp"
+
+namespace {
+	constexpr const char* PHASE_NAMES[] = {
+		"dlopen", "dlsym", "create", "isCompatible", "setInstances", "init", "shutdown", "destroy", "dlclose"
+	};
+	static_assert(std::size(PHASE_NAMES) == static_cast<size_t>(LifecyclePhase::Count));
+
+	void writeMs(std::ostringstream& out, std::chrono::nanoseconds duration) {
+		out << std::chrono::duration<double, std::milli>(duration).count();
+	}
+
+	void writePhases(std::ostringstream& out, const LifecycleTimings& timings) {
+		out << '{';
+		for (size_t i = 0; i < timings.phases.size(); ++i) {
+			out << (i ? ", " : "") << '"' << PHASE_NAMES[i] << "\": ";
+			writeMs(out, timings.phases[i]);
+		}
+		out << '}';
+	}
+}
+
+const char* toString(LifecyclePhase phase) noexcept {
+	size_t index = static_cast<size_t>(phase);
+	return index < std::size(PHASE_NAMES) ? PHASE_NAMES[index] : "unknown";
+}
+
+std::chrono::nanoseconds LifecycleTimings::total() const noexcept {
+	std::chrono::nanoseconds sum{0};
+	for (auto duration : phases) {
+		sum += duration;
+	}
+	return sum;
+}
+
+std::string toJson(const std::vector<std::pair<std::string, LifecycleTimings>>& plugins, size_t slowest) {
+	LifecycleTimings sum;
+	std::vector<size_t> order(plugins.size());
+	for (size_t i = 0; i < plugins.size(); ++i) {
+		order[i] = i;
+		for (size_t p = 0; p < sum.phases.size(); ++p) {
+			sum.phases[p] += plugins[i].second.phases[p];
+		}
+	}
+	std::stable_sort(order.begin(), order.end(), [&](size_t a, size_t b) {
+		return plugins[a].second.total() > plugins[b].second.total();
+	});
+	order.resize(std::min(slowest, order.size()));
+
+	std::ostringstream out;
+	out << "{\"total_ms\": ";
+	writeMs(out, sum.total());
+	out << ", \"phases_ms\": ";
+	writePhases(out, sum);
+	out << ", \"slowest\": [";
+	for (size_t i = 0; i < order.size(); ++i) {
+		out << (i ? ", " : "");
+		writeJsonString(out, plugins[order[i]].first);
+	}
+	out << "], \"plugins\": [";
+	for (size_t i = 0; i < plugins.size(); ++i) {
+		out << (i ? ", " : "") << "{\"name\": ";
+		writeJsonString(out, plugins[i].first);
+		out << ", \"total_ms\": ";
+		writeMs(out, plugins[i].second.total());
+		out << ", \"phases_ms\": ";
+		writePhases(out, plugins[i].second);
+		out << '}';
+	}
+	out << "]}";
+	return out.str();
+}
@@ -0,0 +1,87 @@
+/**
+ * @file LifecycleTimings.hpp
+ * @author ClemtoClem
+ * @date 17/10/2026
+ */
+
+#ifndef LIFECYCLETIMINGS_HPP
+#define LIFECYCLETIMINGS_HPP
+
+#include <array>
+#include <chrono>
+#include <string>
+#include <vector>
+
+/**
+ * @brief Étapes du cycle de vie d'un plugin mesurées par PluginsManager
+ */
+enum class LifecyclePhase : size_t {
+	Dlopen,
+	Dlsym,
+	Create,
+	IsCompatible,
+	SetInstances,
+	Init,
+	Shutdown,
+	Destroy,
+	Dlclose,
+	Count
+};
+
+/**
+ * @brief Fonction pour convertir une étape en chaîne de caractères
+ * @param[in] phase Étape du cycle de vie
+ * @return Nom de l'étape, tel qu'il apparaît dans le rapport JSON
+ */
+const char* toString(LifecyclePhase phase) noexcept;
+
+/**
+ * @brief Durées des étapes du cycle de vie d'un plugin (horloge monotone)
+ * Chaque étape garde sa dernière mesure : après un rechargement à chaud ou une réactivation,
+ * ce sont les durées de la nouvelle instance qui sont conservées.
+ */
+struct LifecycleTimings {
+	std::array<std::chrono::nanoseconds, static_cast<size_t>(LifecyclePhase::Count)> phases{};
+
+	std::chrono::nanoseconds& operator[](LifecyclePhase phase) noexcept { return phases[static_cast<size_t>(phase)]; }
+	std::chrono::nanoseconds operator[](LifecyclePhase phase) const noexcept { return phases[static_cast<size_t>(phase)]; }
+
+	/**
+	 * @brief Durée cumulée de toutes les étapes
+	 */
+	std::chrono::nanoseconds total() const noexcept;
+};
+
+/**
+ * @brief Mesure RAII d'une étape : la durée est ajoutée à la destination à la sortie du bloc
+ */
+class PhaseTimer {
+public:
+	explicit PhaseTimer(std::chrono::nanoseconds& target) noexcept
+		: _target(target), _start(std::chrono::steady_clock::now()) {}
+	~PhaseTimer() { _target += std::chrono::steady_clock::now() - _start; }
+
+	PhaseTimer(const PhaseTimer&) = delete;
+	PhaseTimer& operator=(const PhaseTimer&) = delete;
+
+private:
+	std::chrono::nanoseconds& _target;
+	std::chrono::steady_clock::time_point _start;
+};
+
+/**
+ * @brief Fonction pour écrire un rapport JSON des durées du cycle de vie
+ *
+ * @code
+ * {"total_ms": 1.92, "phases_ms": {"dlopen": 0.81, ...},
+ *  "slowest": ["Plugin2", "Plugin1"],
+ *  "plugins": [{"name": "Plugin1", "total_ms": 0.74, "phases_ms": {"dlopen": 0.40, ...}}, ...]}
+ * @endcode
+ *
+ * @param[in] plugins Noms et durées des plugins, dans l'ordre du rapport
+ * @param[in] slowest Nombre de plugins les plus lents à lister
+ * @return Rapport JSON
+ */
+std::string toJson(const std::vector<std::pair<std::string, LifecycleTimings>>& plugins, size_t slowest);
+
+#endif // LIFECYCLETIMINGS_HPP
@@ -1,11 +1,15 @@
 #include <iostream>
 #include <sstream>
+#include <fstream>
 #include <filesystem>
 #include <dlfcn.h>
+#include <unistd.h>
 #include "../../common/src/Logger.hpp"
 #include "../../common/src/ResourcesManager.hpp"
 #include "../../common/src/PluginInterface.hpp"
 #include "PluginsManager.hpp"
+#include "Benchmarks.hpp"
+#include "ScriptRunner.hpp"
 
 namespace fs = std::filesystem;
 
@@ -26,16 +30,146 @@ int main(int argc, char *argv[]) {
 
 	ResourcesManager::createInstance();
 
+	int exitCode = 0;
 	try {
 
 		const std::string pluginDir = "./plugins";
 		const Version mainVersion = {1, 0, 0};
 	
+		bool parallelLoad = false;
+		bool hotReload = false;
+		bool lazy = false;
+		std::string timingsReport;
+		bool benchmarkPipeline = false;
+		bool benchmarkScript = false;
+		bool benchmarkTransaction = false;
+		bool benchmarkNames = false;
+		bool benchmarkDerived = false;
+		std::string script;
+		std::string commandStatsReport;
+		std::string variablesFile;
+		std::string configFile;
+		for (int i = 1; i < argc; ++i) {
+			if (std::string(argv[i]) == "--parallel-load") {
+				parallelLoad = true;
+			} else if (std::string(argv[i]) == "--hot-reload") {
+				hotReload = true;
+			} else if (std::string(argv[i]) == "--lazy") {
+				lazy = true;
+			} else if (std::string(argv[i]) == "--timings" && i + 1 < argc) {
+				timingsReport = argv[++i];
+			} else if (std::string(argv[i]) == "--command-stats" && i + 1 < argc) {
+				commandStatsReport = argv[++i];
+			} else if (std::string(argv[i]) == "--variables" && i + 1 < argc) {
+				variablesFile = argv[++i];
+			} else if (std::string(argv[i]) == "--config" && i + 1 < argc) {
+				configFile = argv[++i];
+			} else if (std::string(argv[i]) == "--bench-pipeline") {
+				benchmarkPipeline = true;
+			} else if (std::string(argv[i]) == "--script" && i + 1 < argc) {
+				script = argv[++i];
+			} else if (std::string(argv[i]) == "--bench-script") {
+				benchmarkScript = true;
+			} else if (std::string(argv[i]) == "--bench-transaction") {
+				benchmarkTransaction = true;
+			} else if (std::string(argv[i]) == "--bench-names") {
+				benchmarkNames = true;
+			} else if (std::string(argv[i]) == "--bench-derived") {
+				benchmarkDerived = true;
+			} else if (std::string(argv[i]) == "--bench-commands") {
+				int result = benchCommands();
+				ResourcesManager::destroyInstance();
+				Logger::destroyInstance();
+				return result;
+			} else if (std::string(argv[i]) == "--bench-registry") {
+				int result = benchRegistry();
+				ResourcesManager::destroyInstance();
+				Logger::destroyInstance();
+				return result;
+			} else if (std::string(argv[i]) == "--bench-observers") {
+				int result = benchObservers();
+				ResourcesManager::destroyInstance();
+				Logger::destroyInstance();
+				return result;
+			} else if (std::string(argv[i]) == "--bench-variables") {
+				int result = benchVariables();
+				ResourcesManager::destroyInstance();
+				Logger::destroyInstance();
+				return result;
+			} else if (std::string(argv[i]) == "--bench-concurrent-variables") {
+				int result = benchConcurrentVariables();
+				ResourcesManager::destroyInstance();
+				Logger::destroyInstance();
+				return result;
+			} else if (std::string(argv[i]) == "--bench-snapshot") {
+				int result = benchSnapshot();
+				ResourcesManager::destroyInstance();
+				Logger::destroyInstance();
+				return result;
+			} else if (std::string(argv[i]) == "--bench-config") {
+				int result = benchConfig();
+				ResourcesManager::destroyInstance();
+				Logger::destroyInstance();
+				return result;
+			}
+		}
+	
 		PluginsManager manager(pluginDir, mainVersion);
-		manager.loadPlugins();
+		manager.setManifestCache(pluginDir + "/.manifest_cache");
+		manager.setLazyActivation(lazy);
+		if (parallelLoad) {
+			manager.loadPluginsParallel();
+		} else {
+			manager.loadPlugins();
+		}
 		manager.initPlugins(argc, argv);
+		// Les variables sont créées par init : la configuration puis l'instantané, plus récent, sont appliqués juste après
+		if (!configFile.empty()) {
+			ConfigReport report = manager.loadConfig(configFile);
+			LOG(Info) << report.applied << " variables of " << report.plugins << " plugins configured in "
+				<< std::chrono::duration<double, std::milli>(report.duration).count() << " ms ("
+				<< report.pending << " pending, " << report.errors.size() << " ignored).";
+		}
+		if (!variablesFile.empty() && fs::exists(variablesFile)) {
+			SnapshotReport report = manager.restoreVariables(variablesFile);
+			LOG(Info) << report.restored << " variables of " << report.plugins << " plugins restored in "
+				<< std::chrono::duration<double, std::milli>(report.duration).count() << " ms ("
+				<< report.pending << " pending, " << report.mismatches.size() << " mismatches).";
+		}
+		if (benchmarkPipeline) {
+			exitCode = benchPipeline(manager);
+		}
+		if (benchmarkScript && benchScript(manager) != 0) {
+			exitCode = 1;
+		}
+		if (benchmarkTransaction && benchTransaction(manager) != 0) {
+			exitCode = 1;
+		}
+		if (benchmarkNames && benchNames(manager) != 0) {
+			exitCode = 1;
+		}
+		if (benchmarkDerived && benchDerived(manager) != 0) {
+			exitCode = 1;
+		}
+		if (!script.empty()) {
+			// "-" lit l'entrée standard, avec une invite si c'est un terminal
+			ScriptRunner runner(manager, std::cout);
+			bool read = true;
+			if (script == "-") {
+				runner.runStream(std::cin, isatty(STDIN_FILENO));
+			} else {
+				read = runner.runFile(script);
+			}
+			if (!read || runner.getStats().errors != 0) {
+				exitCode = 1;
+			}
+		}
 
 		for (auto& plugin : manager) {
+			if (!plugin.instance) {
+				LOG(Info) << "Plugin '" << plugin.info.name << "' is not activated yet.";
+				continue;
+			}
 			LOG(Info) << plugin.instance->getInfoToString();
 			LOG(Info) << "Description: " << plugin.instance->getDescription();
 			LOG(Info) << "Variables: " << to_string(plugin.instance->getVariables());
@@ -44,8 +178,39 @@ int main(int argc, char *argv[]) {
 
 		LOG(Info) << "....";
 
+		if (hotReload && manager.startHotReload()) {
+			LOG(Info) << "Hot reload enabled, press Enter to quit.";
+			std::string line;
+			std::getline(std::cin, line);
+			manager.stopHotReload();
+		}
+
+		// Les statistiques des commandes disparaissent avec les plugins : elles sont écrites avant l'arrêt
+		if (!commandStatsReport.empty()) {
+			std::ofstream report(commandStatsReport);
+			report << manager.getCommandStatsReport(fs::path(commandStatsReport).extension() == ".prom");
+			if (!report) {
+				LOG(Error) << "Cannot write command statistics to " << commandStatsReport;
+			}
+		}
+
+		if (!variablesFile.empty()) {
+			manager.saveVariables(variablesFile);
+		}
+
 		manager.shutdownPlugins();
 		manager.unloadPlugins();
+
+		for (const auto& [name, timings] : manager.getSlowestPlugins(3)) {
+			LOG(Debug) << "Plugin '" << name << "' lifecycle: " << std::chrono::duration<double, std::milli>(timings.total()).count() << " ms.";
+		}
+		if (!timingsReport.empty()) {
+			std::ofstream report(timingsReport);
+			report << manager.getTimingsReport() << std::endl;
+			if (!report) {
+				LOG(Error) << "Cannot write timings report to " << timingsReport;
+			}
+		}
 	} catch (const std::exception& e) {
 		LOG(Error) << "Exception: " << e.what();
 		return 1;
@@ -55,5 +220,5 @@ int main(int argc, char *argv[]) {
 	ResourcesManager::destroyInstance();
 	Logger::destroyInstance();
 
-	return 0;
+	return exitCode;
 }
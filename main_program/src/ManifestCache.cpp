@@ -0,0 +1,231 @@
+#include <climits>
+#include <cstring>
+#include <fstream>
+#include <elf.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "ManifestCache.hpp"
+
+namespace {
+	constexpr uint32_t CACHE_MAGIC = 0x43434D50; // "PMCC"
+	constexpr uint32_t CACHE_VERSION = 1;
+
+	bool statFile(const fs::path& path, uint64_t& size, int64_t& mtime) {
+		struct stat st;
+		if (stat(path.c_str(), &st) != 0) {
+			return false;
+		}
+		size = static_cast<uint64_t>(st.st_size);
+		mtime = static_cast<int64_t>(st.st_mtim.tv_sec) * 1000000000 + st.st_mtim.tv_nsec;
+		return true;
+	}
+
+	template<typename T>
+	void writeValue(std::ofstream& out, const T& value) {
+		out.write(reinterpret_cast<const char*>(&value), sizeof(T));
+	}
+
+	template<typename T>
+	bool readValue(std::ifstream& in, T& value) {
+		return static_cast<bool>(in.read(reinterpret_cast<char*>(&value), sizeof(T)));
+	}
+
+	// Plage [offset, offset + length) contenue dans [0, limit), sans débordement pour des valeurs lues dans un fichier corrompu
+	bool inside(uint64_t offset, uint64_t length, uint64_t limit) noexcept {
+		return offset <= limit && length <= limit - offset;
+	}
+}
+
+bool ManifestCache::readManifest(const fs::path& plugin, PluginManifest& manifest, std::string& error) {
+	int fd = open(plugin.c_str(), O_RDONLY | O_CLOEXEC);
+	if (fd < 0) {
+		error = std::string("cannot open file: ") + strerror(errno);
+		return false;
+	}
+	struct stat st;
+	if (fstat(fd, &st) != 0 || st.st_size < static_cast<off_t>(sizeof(Elf64_Ehdr))) {
+		close(fd);
+		error = "not an ELF file";
+		return false;
+	}
+	const size_t size = static_cast<size_t>(st.st_size);
+	void* map = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+	close(fd);
+	if (map == MAP_FAILED) {
+		error = std::string("cannot map file: ") + strerror(errno);
+		return false;
+	}
+	const auto* data = static_cast<const uint8_t*>(map);
+
+	bool found = false;
+	error = "no '" PLUGIN_MANIFEST_SYMBOL "' symbol";
+	const auto* header = reinterpret_cast<const Elf64_Ehdr*>(data);
+	if (memcmp(header->e_ident, ELFMAG, SELFMAG) != 0 || header->e_ident[EI_CLASS] != ELFCLASS64
+		|| header->e_shentsize != sizeof(Elf64_Shdr) || header->e_shoff % alignof(Elf64_Shdr) != 0
+		|| !inside(header->e_shoff, uint64_t(header->e_shnum) * sizeof(Elf64_Shdr), size)) {
+		error = "unsupported ELF file";
+	} else {
+		const auto* sections = reinterpret_cast<const Elf64_Shdr*>(data + header->e_shoff);
+		for (size_t s = 0; s < header->e_shnum && !found; ++s) {
+			if (sections[s].sh_type != SHT_DYNSYM || sections[s].sh_link >= header->e_shnum) {
+				continue;
+			}
+			const Elf64_Shdr& symtab = sections[s];
+			const Elf64_Shdr& strtab = sections[symtab.sh_link];
+			if (!inside(symtab.sh_offset, symtab.sh_size, size) || symtab.sh_offset % alignof(Elf64_Sym) != 0
+				|| !inside(strtab.sh_offset, strtab.sh_size, size)) {
+				error = "invalid symbol table";
+				break;
+			}
+			const auto* symbols = reinterpret_cast<const Elf64_Sym*>(data + symtab.sh_offset);
+			const char* names = reinterpret_cast<const char*>(data + strtab.sh_offset);
+			for (size_t i = 0; i < symtab.sh_size / sizeof(Elf64_Sym); ++i) {
+				const Elf64_Sym& symbol = symbols[i];
+				if (symbol.st_name >= strtab.sh_size
+					|| std::string_view(names + symbol.st_name, strnlen(names + symbol.st_name, strtab.sh_size - symbol.st_name)) != PLUGIN_MANIFEST_SYMBOL) {
+					continue;
+				}
+				if (symbol.st_shndx == SHN_UNDEF || symbol.st_shndx >= header->e_shnum || symbol.st_size < sizeof(PluginManifest)) {
+					error = "invalid '" PLUGIN_MANIFEST_SYMBOL "' symbol";
+					break;
+				}
+				// Un manifeste en .bss serait rempli à l'exécution : il doit être initialisé à la compilation
+				const Elf64_Shdr& section = sections[symbol.st_shndx];
+				if (section.sh_type == SHT_NOBITS) {
+					error = "'" PLUGIN_MANIFEST_SYMBOL "' is not constant-initialized";
+					break;
+				}
+				// Le symbole doit être dans sa section, et la section dans le fichier
+				if (!inside(section.sh_offset, section.sh_size, size) || symbol.st_value < section.sh_addr
+					|| !inside(symbol.st_value - section.sh_addr, sizeof(PluginManifest), section.sh_size)) {
+					error = "'" PLUGIN_MANIFEST_SYMBOL "' is out of file bounds";
+					break;
+				}
+				size_t offset = section.sh_offset + (symbol.st_value - section.sh_addr);
+				memcpy(&manifest, data + offset, sizeof(PluginManifest));
+				if (isValidManifest(manifest)) {
+					found = true;
+				} else {
+					error = "unsupported manifest format";
+				}
+				break;
+			}
+		}
+	}
+
+	munmap(map, size);
+	return found;
+}
+
+bool ManifestCache::lookup(const fs::path& plugin, PluginManifest& manifest) {
+	uint64_t size = 0;
+	int64_t mtime = 0;
+	if (!statFile(plugin, size, mtime)) {
+		return false;
+	}
+
+	auto it = _entries.find(plugin.native());
+	if (it != _entries.end() && it->second.size == size && it->second.mtime == mtime) {
+		_hits++;
+		it->second.seen = true;
+		manifest = it->second.manifest;
+		return it->second.found;
+	}
+
+	_misses++;
+	Entry entry = { size, mtime, false, true, {} };
+	std::string error;
+	entry.found = readManifest(plugin, entry.manifest, error);
+	_entries.insert_or_assign(plugin.native(), entry);
+	_dirty = true;
+	manifest = entry.manifest;
+	return entry.found;
+}
+
+bool ManifestCache::load(const fs::path& file) {
+	std::ifstream in(file, std::ios::binary | std::ios::ate);
+	if (!in.is_open()) {
+		return false;
+	}
+	const std::streamoff fileSize = in.tellg();
+	in.seekg(0);
+	uint32_t magic = 0, version = 0, manifestSize = 0, count = 0;
+	if (!readValue(in, magic) || !readValue(in, version) || !readValue(in, manifestSize) || !readValue(in, count)
+		|| magic != CACHE_MAGIC || version != CACHE_VERSION || manifestSize != sizeof(PluginManifest)) {
+		return false;
+	}
+
+	// Les tailles lues viennent d'un fichier qui peut être abîmé : elles sont bornées par ce qu'il reste à lire,
+	// et un cache illisible est simplement ignoré
+	constexpr std::streamoff ENTRY_SIZE = sizeof(uint32_t) + sizeof(Entry::size) + sizeof(Entry::mtime) + sizeof(uint8_t) + sizeof(PluginManifest);
+	auto remaining = [&]() { return fileSize - static_cast<std::streamoff>(in.tellg()); };
+	_entries.clear();
+	if (count > remaining() / ENTRY_SIZE) {
+		return false;
+	}
+	try {
+		for (uint32_t i = 0; i < count; ++i) {
+			uint32_t length = 0;
+			if (!readValue(in, length) || length > PATH_MAX || length > remaining()) {
+				_entries.clear();
+				return false;
+			}
+			std::string path(length, '\0');
+			Entry entry = {};
+			uint8_t found = 0;
+			if (!in.read(path.data(), length) || !readValue(in, entry.size) || !readValue(in, entry.mtime)
+				|| !readValue(in, found) || !readValue(in, entry.manifest)) {
+				_entries.clear();
+				return false;
+			}
+			entry.found = found != 0;
+			_entries.emplace(std::move(path), entry);
+		}
+	} catch (const std::exception&) {
+		_entries.clear();
+		return false;
+	}
+	_dirty = false;
+	return true;
+}
+
+bool ManifestCache::save(const fs::path& file) {
+	size_t stale = std::erase_if(_entries, [](const auto& item) { return !item.second.seen; });
+	if (!_dirty && stale == 0) {
+		return true;
+	}
+
+	// Écriture dans un fichier temporaire puis renommage : un démarrage concurrent ne lit jamais un cache tronqué
+	fs::path tmp = file;
+	tmp += ".tmp";
+	{
+		std::ofstream out(tmp, std::ios::binary | std::ios::trunc);
+		if (!out.is_open()) {
+			return false;
+		}
+		writeValue(out, CACHE_MAGIC);
+		writeValue(out, CACHE_VERSION);
+		writeValue(out, static_cast<uint32_t>(sizeof(PluginManifest)));
+		writeValue(out, static_cast<uint32_t>(_entries.size()));
+		for (const auto& [path, entry] : _entries) {
+			writeValue(out, static_cast<uint32_t>(path.size()));
+			out.write(path.data(), path.size());
+			writeValue(out, entry.size);
+			writeValue(out, entry.mtime);
+			writeValue(out, static_cast<uint8_t>(entry.found));
+			writeValue(out, entry.manifest);
+		}
+		if (!out) {
+			return false;
+		}
+	}
+	std::error_code ec;
+	fs::rename(tmp, file, ec);
+	if (ec) {
+		return false;
+	}
+	_dirty = false;
+	return true;
+}
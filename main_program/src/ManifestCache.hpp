@@ -0,0 +1,75 @@
+/**
+ * @file ManifestCache.hpp
+ * @author ClemtoClem
+ * @date 17/10/2026
+ */
+
+#ifndef MANIFESTCACHE_HPP
+#define MANIFESTCACHE_HPP
+
+#include <filesystem>
+#include <string>
+#include "../../common/src/PluginManifest.hpp"
+#include "../../common/src/StringHash.hpp"
+
+namespace fs = std::filesystem;
+
+/**
+ * @brief Cache des manifestes de plugins
+ *
+ * Le manifeste d'un plugin est lu directement dans la table des symboles dynamiques de son fichier ELF,
+ * sans dlopen. Le résultat est mémorisé par chemin, taille et date de modification, et peut être
+ * enregistré sur disque pour que les démarrages suivants n'aient même pas à ouvrir les fichiers inchangés.
+ */
+class ManifestCache {
+public:
+	/**
+	 * @brief Charger le cache depuis un fichier
+	 * @param[in] file Fichier du cache
+	 * @return true si le cache a été chargé, false si le fichier est absent, d'un autre format ou abîmé (le cache reste vide)
+	 */
+	bool load(const fs::path& file);
+
+	/**
+	 * @brief Enregistrer le cache s'il a été modifié, sans les entrées des fichiers disparus
+	 * @param[in] file Fichier du cache
+	 * @return true si le cache est à jour sur disque, false sinon
+	 */
+	bool save(const fs::path& file);
+
+	/**
+	 * @brief Récupérer le manifeste d'un plugin, depuis le cache si le fichier n'a pas changé
+	 * @param[in] plugin Fichier .so du plugin
+	 * @param[out] manifest Manifeste du plugin
+	 * @return true si le plugin exporte un manifeste valide, false sinon
+	 */
+	bool lookup(const fs::path& plugin, PluginManifest& manifest);
+
+	size_t hits() const noexcept { return _hits; }
+	size_t misses() const noexcept { return _misses; }
+
+	/**
+	 * @brief Lire le manifeste d'un plugin dans son fichier ELF, sans le charger
+	 * @param[in] plugin Fichier .so du plugin
+	 * @param[out] manifest Manifeste du plugin
+	 * @param[out] error Raison de l'échec
+	 * @return true si un manifeste valide a été trouvé, false sinon
+	 */
+	static bool readManifest(const fs::path& plugin, PluginManifest& manifest, std::string& error);
+
+private:
+	struct Entry {
+		uint64_t size;				///< Taille du fichier
+		int64_t mtime;				///< Date de modification du fichier en nanosecondes
+		bool found;					///< Le fichier exporte un manifeste valide
+		bool seen;					///< Le fichier a été consulté depuis le chargement du cache
+		PluginManifest manifest;
+	};
+
+	StringMap<Entry> _entries;
+	size_t _hits = 0;
+	size_t _misses = 0;
+	bool _dirty = false;
+};
+
+#endif // MANIFESTCACHE_HPP
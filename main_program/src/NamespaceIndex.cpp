@@ -0,0 +1,129 @@
+#include <algorithm>
+#include <stdexcept>
+#include "NamespaceIndex.hpp"
+
+void NamespaceIndex::add(std::string_view plugin, std::string_view member, NameKind kind, uint32_t pluginId) {
+	// La vue est fixée par build() : _names peut encore être réallouée
+	_offsets.push_back(static_cast<uint32_t>(_names.size()));
+	_names.append(plugin);
+	_names.push_back('.');
+	_names.append(member);
+	_entries.push_back({ {}, pluginId, static_cast<uint32_t>(plugin.size()), kind });
+}
+
+void NamespaceIndex::build() {
+	for (size_t i = 0; i < _entries.size(); ++i) {
+		const size_t next = i + 1 < _offsets.size() ? _offsets[i + 1] : _names.size();
+		_entries[i].name = std::string_view(_names.data() + _offsets[i], next - _offsets[i]);
+	}
+	_offsets.clear();
+	_offsets.shrink_to_fit();
+	std::sort(_entries.begin(), _entries.end(), [](const NameEntry& a, const NameEntry& b) {
+		return a.name != b.name ? a.name < b.name : a.kind < b.kind;
+	});
+	_nodes.clear();
+	_nodes.push_back({ 0, 0, 0, 0, 0, 0, 0 });
+	fill(0, 0, static_cast<uint32_t>(_entries.size()), 0);
+}
+
+void NamespaceIndex::fill(uint32_t node, uint32_t begin, uint32_t end, size_t depth) {
+	// Noms triés : ceux qui se terminent ici viennent en premier, puis un groupe par caractère suivant
+	uint32_t exact = begin;
+	while (exact < end && _entries[exact].name.size() == depth) {
+		++exact;
+	}
+	auto groupEnd = [&](uint32_t first) {
+		const char c = _entries[first].name[depth];
+		uint32_t last = first;
+		while (last < end && _entries[last].name[depth] == c) {
+			++last;
+		}
+		return last;
+	};
+	uint32_t nbChildren = 0;
+	for (uint32_t first = exact; first < end; first = groupEnd(first)) {
+		++nbChildren;
+	}
+
+	const uint32_t firstChild = static_cast<uint32_t>(_nodes.size());
+	_nodes[node].firstChild = firstChild;
+	_nodes[node].nbChildren = nbChildren;
+	_nodes[node].begin = begin;
+	_nodes[node].end = end;
+	_nodes[node].nbExact = exact - begin;
+	_nodes.resize(firstChild + nbChildren);
+
+	uint32_t child = firstChild;
+	for (uint32_t first = exact; first < end; ++child) {
+		const uint32_t last = groupEnd(first);
+		// Le plus long préfixe commun du groupe est celui de son premier et de son dernier nom
+		std::string_view a = _entries[first].name;
+		std::string_view b = _entries[last - 1].name;
+		size_t common = depth + 1;
+		while (common < a.size() && common < b.size() && a[common] == b[common]) {
+			++common;
+		}
+		_nodes[child].label = static_cast<uint32_t>(a.data() - _names.data() + depth);
+		_nodes[child].labelLength = static_cast<uint32_t>(common - depth);
+		fill(child, first, last, common);
+		first = last;
+	}
+}
+
+std::pair<uint32_t, uint32_t> NamespaceIndex::prefixRange(std::string_view prefix) const noexcept {
+	if (_nodes.empty()) {
+		return { 0, 0 };
+	}
+	uint32_t index = 0;
+	while (!prefix.empty()) {
+		const Node& node = _nodes[index];
+		auto first = _nodes.begin() + node.firstChild;
+		auto last = first + node.nbChildren;
+		// Même ordre que le tri des noms : caractères comparés comme unsigned char
+		auto child = std::lower_bound(first, last, static_cast<unsigned char>(prefix.front()), [this](const Node& n, unsigned char c) {
+			return static_cast<unsigned char>(_names[n.label]) < c;
+		});
+		if (child == last || _names[child->label] != prefix.front()) {
+			return { 0, 0 };
+		}
+		std::string_view label(_names.data() + child->label, child->labelLength);
+		if (prefix.size() <= label.size()) {
+			// Le préfixe se termine au milieu de l'arête : tout le sous-arbre convient
+			return label.starts_with(prefix) ? std::make_pair(child->begin, child->end) : std::make_pair(0u, 0u);
+		}
+		if (!prefix.starts_with(label)) {
+			return { 0, 0 };
+		}
+		prefix.remove_prefix(label.size());
+		index = static_cast<uint32_t>(child - _nodes.begin());
+	}
+	return { _nodes[index].begin, _nodes[index].end };
+}
+
+NamespaceIndex::Glob::Glob(std::string_view pattern) : chars{}, stars(0) {
+	if (pattern.size() > MAX_PATTERN) {
+		throw std::invalid_argument("Pattern longer than " + std::to_string(MAX_PATTERN) + " characters: " + std::string(pattern));
+	}
+	uint64_t any = 0;
+	for (size_t i = 0; i < pattern.size(); ++i) {
+		const uint64_t bit = uint64_t(1) << i;
+		if (pattern[i] == '*') {
+			stars |= bit;
+		} else if (pattern[i] == '?') {
+			any |= bit;
+		} else {
+			chars[static_cast<unsigned char>(pattern[i])] |= bit;
+		}
+	}
+	if (any) {
+		for (uint64_t& mask : chars) {
+			mask |= any;
+		}
+	}
+	accept = uint64_t(1) << pattern.size();
+	rest = 0;
+	for (size_t i = pattern.size(); i-- > 0 && pattern[i] == '*';) {
+		rest |= uint64_t(1) << i;
+	}
+	start = closure(1);
+}
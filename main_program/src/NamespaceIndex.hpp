@@ -0,0 +1,188 @@
+/**
+ * @file NamespaceIndex.hpp
+ * @author ClemtoClem
+ * @date 17/10/2026
+ */
+
+#ifndef NAMESPACE_INDEX_HPP
+#define NAMESPACE_INDEX_HPP
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+/**
+ * @brief Nature d'un nom de l'espace de noms, combinable pour filtrer les recherches
+ */
+enum class NameKind : uint8_t {
+	Variable = 1,
+	Command = 2,
+	All = Variable | Command
+};
+
+constexpr bool hasKind(NameKind kinds, NameKind kind) noexcept {
+	return (static_cast<uint8_t>(kinds) & static_cast<uint8_t>(kind)) != 0;
+}
+
+/**
+ * @brief Nom d'une variable ou d'une commande, "Plugin.membre"
+ * Les vues pointent dans l'index qui les a produites et restent valides tant qu'il existe.
+ */
+struct NameEntry {
+	std::string_view name;		///< Nom complet
+	uint32_t pluginId;			///< Identifiant du plugin (PluginHandle::id)
+	uint32_t pluginLength;		///< Longueur du nom du plugin dans name
+	NameKind kind;
+
+	std::string_view plugin() const noexcept { return name.substr(0, pluginLength); }
+	std::string_view member() const noexcept { return name.substr(pluginLength + 1); }
+};
+
+/**
+ * @brief Index immuable des noms "Plugin.variable" et "Plugin.commande", en arbre radix
+ *
+ * Les noms sont copiés dans une seule chaîne et triés : les noms d'un sous-arbre forment une plage contiguë.
+ * Une recherche par préfixe descend l'arbre puis parcourt la plage, sans copie ni allocation.
+ * Une recherche par motif (`*` pour une suite de caractères quelconque, `?` pour un caractère) avance un automate
+ * sur les étiquettes des arêtes et abandonne les sous-arbres qui ne peuvent plus correspondre ; dès que le reste du
+ * motif n'est fait que de `*`, tout le sous-arbre correspond. Les motifs sont limités à MAX_PATTERN caractères.
+ */
+class NamespaceIndex {
+public:
+	static constexpr size_t MAX_PATTERN = 63;	///< Un bit d'état par caractère du motif
+
+	/**
+	 * @brief Ajouter un nom, avant build()
+	 * @param[in] plugin Nom du plugin
+	 * @param[in] member Nom de la variable ou de la commande
+	 * @param[in] kind Variable ou commande
+	 * @param[in] pluginId Identifiant du plugin
+	 */
+	void add(std::string_view plugin, std::string_view member, NameKind kind, uint32_t pluginId);
+
+	/**
+	 * @brief Construire l'arbre, après le dernier add()
+	 */
+	void build();
+
+	size_t size() const noexcept { return _entries.size(); }
+
+	/**
+	 * @brief Noms dans l'ordre lexicographique
+	 */
+	const std::vector<NameEntry>& entries() const noexcept { return _entries; }
+
+	/**
+	 * @brief Parcourir les noms qui commencent par un préfixe
+	 * @param[in] prefix Préfixe, vide pour tous les noms
+	 * @param[in] kinds Natures des noms parcourus
+	 * @param[in] visitor Fonction appelée avec chaque NameEntry, dans l'ordre lexicographique
+	 * @return Nombre de noms parcourus
+	 */
+	template<typename F>
+	size_t forEachPrefix(std::string_view prefix, NameKind kinds, F&& visitor) const {
+		auto [begin, end] = prefixRange(prefix);
+		return visit(begin, end, kinds, visitor);
+	}
+
+	/**
+	 * @brief Parcourir les noms qui correspondent à un motif, par exemple "Plugin*.level"
+	 * @param[in] pattern Motif, `*` et `?` comme jokers
+	 * @param[in] kinds Natures des noms parcourus
+	 * @param[in] visitor Fonction appelée avec chaque NameEntry, dans l'ordre lexicographique
+	 * @return Nombre de noms parcourus
+	 * @throw std::invalid_argument si le motif dépasse MAX_PATTERN caractères
+	 */
+	template<typename F>
+	size_t forEachMatch(std::string_view pattern, NameKind kinds, F&& visitor) const {
+		Glob glob(pattern);
+		return _nodes.empty() ? 0 : match(0, glob, glob.start, kinds, visitor);
+	}
+
+	/**
+	 * @brief Empreinte de l'état des plugins au moment de la construction, pour savoir si l'index est à jour
+	 */
+	std::vector<uint64_t>& stamps() noexcept { return _stamps; }
+	const std::vector<uint64_t>& stamps() const noexcept { return _stamps; }
+
+private:
+	struct Node {
+		uint32_t label;			///< Position de l'étiquette de l'arête dans _names
+		uint32_t labelLength;
+		uint32_t firstChild;	///< Enfants contigus dans _nodes, triés par premier caractère
+		uint32_t nbChildren;
+		uint32_t begin;			///< Plage des noms du sous-arbre dans _entries
+		uint32_t end;
+		uint32_t nbExact;		///< Noms qui se terminent sur ce noeud, au début de la plage
+	};
+
+	/**
+	 * @brief Automate d'un motif : le bit i est actif quand les i premiers caractères du motif ont été reconnus
+	 */
+	struct Glob {
+		uint64_t chars[256];	///< Positions qui acceptent chaque caractère (le caractère lui-même ou `?`)
+		uint64_t stars;			///< Positions des `*`
+		uint64_t accept;		///< Motif entièrement reconnu
+		uint64_t rest;			///< Positions après lesquelles il ne reste que des `*` : tout suffixe convient
+		uint64_t start;
+
+		explicit Glob(std::string_view pattern);
+
+		uint64_t closure(uint64_t states) const noexcept {
+			for (uint64_t next; (next = states | ((states & stars) << 1)) != states;) {
+				states = next;
+			}
+			return states;
+		}
+
+		uint64_t advance(uint64_t states, char c) const noexcept {
+			return closure(((states & chars[static_cast<unsigned char>(c)]) << 1) | (states & stars));
+		}
+	};
+
+	std::string _names;					///< Tous les noms, bout à bout
+	std::vector<NameEntry> _entries;
+	std::vector<Node> _nodes;			///< Racine en position 0
+	std::vector<uint64_t> _stamps;
+	std::vector<uint32_t> _offsets;		///< Position de chaque nom dans _names, jusqu'à build()
+
+	void fill(uint32_t node, uint32_t begin, uint32_t end, size_t depth);
+	std::pair<uint32_t, uint32_t> prefixRange(std::string_view prefix) const noexcept;
+
+	template<typename F>
+	size_t visit(uint32_t begin, uint32_t end, NameKind kinds, F& visitor) const {
+		size_t count = 0;
+		for (uint32_t i = begin; i < end; ++i) {
+			if (hasKind(kinds, _entries[i].kind)) {
+				visitor(_entries[i]);
+				count++;
+			}
+		}
+		return count;
+	}
+
+	template<typename F>
+	size_t match(uint32_t index, const Glob& glob, uint64_t states, NameKind kinds, F& visitor) const {
+		const Node& node = _nodes[index];
+		if (states & glob.rest) {
+			return visit(node.begin, node.end, kinds, visitor);
+		}
+		size_t count = 0;
+		if (states & glob.accept) {
+			count += visit(node.begin, node.begin + node.nbExact, kinds, visitor);
+		}
+		for (uint32_t child = node.firstChild; child < node.firstChild + node.nbChildren; ++child) {
+			uint64_t next = states;
+			for (uint32_t i = 0; next && i < _nodes[child].labelLength; ++i) {
+				next = glob.advance(next, _names[_nodes[child].label + i]);
+			}
+			if (next) {
+				count += match(child, glob, next, kinds, visitor);
+			}
+		}
+		return count;
+	}
+};
+
+#endif // NAMESPACE_INDEX_HPP
@@ -1,156 +1,1913 @@
 #include <iostream>
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <thread>
+#include <queue>
+#include <unordered_map>
+#include <set>
+#include <poll.h>
+#include <unistd.h>
+#include <cstring>
+#include <sys/inotify.h>
 #include "../../common/src/Logger.hpp"
 #include "PluginsManager.hpp"
+#include "ThreadPool.hpp"
 
 PluginsManager::PluginsManager(const std::string& dir, const Version& mainVersion)
-	: _pluginsDir(dir), _mainVersion(mainVersion) {
+	: _pluginsDir(dir), _mainVersion(mainVersion), _nbThreads(0), _nextId(0), _argc(0), _argv(nullptr), _initialized(false), _watching(false), _lazyDefault(false),
+	  _executorThreads(0), _executorCapacity(1024) {
 	if (!fs::exists(_pluginsDir)) {
 		throw std::runtime_error("Plugins directory does not exist");
 	}
+	// Threads de distribution démarrés par le programme principal, jamais par le code d'un plugin
+	_events.start();
 }
 
 PluginsManager::~PluginsManager() {
+	stopHotReload();
 	unloadPlugins();
+	delete _names.load(std::memory_order_relaxed);
 }
 
-void PluginsManager::loadPlugins() {
-	size_t loadedPlugins = 0;
-	size_t totalPlugins = 0;
+namespace {
+	// Rejette les plugins dont une dépendance est absente ou elle-même rejetée, jusqu'à stabilité
+	std::vector<bool> rejectMissingDependencies(const std::vector<const PluginInfo*>& infos) {
+		std::unordered_map<std::string, size_t> byName;
+		for (size_t i = 0; i < infos.size(); ++i) {
+			byName.emplace(infos[i]->name, i);
+		}
+		std::vector<bool> rejected(infos.size(), false);
+		for (bool changed = true; changed; ) {
+			changed = false;
+			for (size_t i = 0; i < infos.size(); ++i) {
+				if (rejected[i]) continue;
+				for (const auto& dependency : infos[i]->dependencies) {
+					auto it = byName.find(dependency);
+					if (it == byName.end() || rejected[it->second]) {
+						LOG(Error) << "Plugin '" << infos[i]->name << "' depends on missing plugin '" << dependency << "'";
+						rejected[i] = true;
+						changed = true;
+						break;
+					}
+				}
+			}
+		}
+		return rejected;
+	}
+}
+
+void PluginsManager::setManifestCache(const fs::path& file) {
+	_manifestCacheFile = file;
+	if (!_manifests.load(file)) {
+		LOG(Debug) << "No usable manifest cache at " << file;
+	}
+}
+
+std::vector<fs::path> PluginsManager::findPluginFiles() {
+	std::vector<fs::path> files;
 	for (const auto& entry : fs::directory_iterator(_pluginsDir)) {
 		if (entry.path().extension() == ".so") {
-			totalPlugins++;
-			if (loadPlugin(entry.path()))
-				loadedPlugins++;
+			files.push_back(entry.path());
+		}
+	}
+	// L'ordre de directory_iterator n'est pas défini, on le fixe pour garder des logs reproductibles
+	std::sort(files.begin(), files.end());
+	return files;
+}
+
+bool PluginsManager::isLazy(const std::string& pluginName) const {
+	auto it = _lazyOverrides.find(pluginName);
+	return it != _lazyOverrides.end() ? it->second : _lazyDefault;
+}
+
+std::vector<fs::path> PluginsManager::filterPluginFiles(const std::vector<fs::path>& files, size_t& deferred) {
+	struct Candidate {
+		fs::path path;
+		bool hasManifest;
+		PluginInfo info;
+	};
+	std::vector<Candidate> candidates;
+	bool allManifests = true;
+	for (const auto& path : files) {
+		PluginManifest manifest;
+		Candidate candidate = { path, _manifests.lookup(path, manifest), {} };
+		if (candidate.hasManifest) {
+			candidate.info = toPluginInfo(manifest);
+			// Même règle que PluginInterface::isCompatible, appliquée sans créer l'instance
+			if (candidate.info.mainVersion.major != _mainVersion.major) {
+				LOG(Error) << "Plugin '" << candidate.info.name << "' is not compatible with main program version.";
+				continue;
+			}
+		}
+		allManifests = allManifests && candidate.hasManifest;
+		candidates.push_back(std::move(candidate));
+	}
+	if (!_manifestCacheFile.empty() && !_manifests.save(_manifestCacheFile)) {
+		LOG(Warning) << "Cannot write manifest cache " << _manifestCacheFile;
+	}
+	LOG(Debug) << "Manifest cache: " << _manifests.hits() << " hits, " << _manifests.misses() << " misses.";
+
+	// Si tous les manifestes sont connus, les dépendances manquantes et l'ordre sont établis avant dlopen
+	if (allManifests) {
+		std::vector<const PluginInfo*> infos;
+		for (const auto& candidate : candidates) {
+			infos.push_back(&candidate.info);
+		}
+		std::vector<bool> rejected = rejectMissingDependencies(infos);
+		for (size_t i = candidates.size(); i-- > 0; ) {
+			if (rejected[i]) {
+				candidates.erase(candidates.begin() + i);
+			}
+		}
+		std::stable_sort(candidates.begin(), candidates.end(), [](const Candidate& a, const Candidate& b) {
+			return a.info.priority < b.info.priority;
+		});
+	}
+
+	// Plugins différés : le manifeste suffit à les enregistrer, sans dlopen
+	std::vector<bool> lazy(candidates.size(), false);
+	bool anyLazy = false;
+	for (size_t i = 0; i < candidates.size(); ++i) {
+		lazy[i] = candidates[i].hasManifest && isLazy(candidates[i].info.name);
+		anyLazy = anyLazy || lazy[i];
+	}
+	if (anyLazy && !allManifests) {
+		LOG(Warning) << "Lazy activation requires a manifest in every plugin, all plugins are loaded at startup.";
+		lazy.assign(candidates.size(), false);
+	}
+	if (anyLazy && allManifests) {
+		// Les dépendances (directes ou non) d'un plugin chargé au démarrage le sont aussi
+		std::unordered_map<std::string, size_t> byName;
+		std::vector<size_t> stack;
+		for (size_t i = 0; i < candidates.size(); ++i) {
+			byName.emplace(candidates[i].info.name, i);
+			if (!lazy[i]) {
+				stack.push_back(i);
+			}
+		}
+		while (!stack.empty()) {
+			size_t i = stack.back();
+			stack.pop_back();
+			for (const auto& dependency : candidates[i].info.dependencies) {
+				size_t j = byName[dependency];
+				if (lazy[j]) {
+					lazy[j] = false;
+					stack.push_back(j);
+				}
+			}
+		}
+	}
+
+	deferred = 0;
+	std::vector<fs::path> filtered;
+	for (size_t i = 0; i < candidates.size(); ++i) {
+		if (lazy[i]) {
+			Plugin plugin = { nullptr, nullptr, std::move(candidates[i].info), std::move(candidates[i].path), _nextId++ };
+			plugin.lazy = true;
+			_plugins.push_back(std::move(plugin));
+			deferred++;
+		} else {
+			filtered.push_back(std::move(candidates[i].path));
 		}
 	}
+	return filtered;
+}
 
-	// Trier les plugins par priorité
-	std::sort(_plugins.begin(), _plugins.end(), [](const Plugin& a, const Plugin& b) {
+size_t PluginsManager::sortPlugins() {
+	// Tri stable : à priorité égale les plugins gardent l'ordre des fichiers
+	std::stable_sort(_plugins.begin(), _plugins.end(), [](const Plugin& a, const Plugin& b) {
 		return a.info.priority < b.info.priority;
 	});
+	size_t nbRejected = resolveDependencies();
+	rebuildIndex();
+	return nbRejected;
+}
 
-	LOG(Info) << loadedPlugins << "/" << totalPlugins << " plugins loaded and sorted by priority.";
+void PluginsManager::rebuildIndex() {
+	_index.clear();
+	_index.reserve(_plugins.size());
+	_slots.assign(_nextId, SIZE_MAX);
+	for (size_t i = 0; i < _plugins.size(); ++i) {
+		_index.emplace(_plugins[i].info.name, i);
+		_slots[_plugins[i].id] = i;
+	}
 }
 
-bool PluginsManager::loadPlugin(const fs::path& path) {
-	void* handle = dlopen(path.c_str(), RTLD_LAZY);
+size_t PluginsManager::resolveDependencies() {
+	const size_t n = _plugins.size();
+	std::unordered_map<std::string, size_t> byName;
+	std::vector<const PluginInfo*> infos;
+	for (size_t i = 0; i < n; ++i) {
+		byName.emplace(_plugins[i].info.name, i);
+		infos.push_back(&_plugins[i].info);
+	}
+	std::vector<bool> rejected = rejectMissingDependencies(infos);
+
+	// Tri topologique (Kahn), à égalité on garde l'ordre de priorité déjà établi
+	std::vector<size_t> nbDependencies(n, 0);
+	std::vector<std::vector<size_t>> dependents(n);
+	for (size_t i = 0; i < n; ++i) {
+		if (rejected[i]) continue;
+		for (const auto& dependency : _plugins[i].info.dependencies) {
+			nbDependencies[i]++;
+			dependents[byName[dependency]].push_back(i);
+		}
+	}
+	std::priority_queue<size_t, std::vector<size_t>, std::greater<size_t>> ready;
+	for (size_t i = 0; i < n; ++i) {
+		if (!rejected[i] && nbDependencies[i] == 0) {
+			ready.push(i);
+		}
+	}
+	std::vector<size_t> order;
+	while (!ready.empty()) {
+		size_t i = ready.top();
+		ready.pop();
+		order.push_back(i);
+		for (size_t dependent : dependents[i]) {
+			if (--nbDependencies[dependent] == 0) {
+				ready.push(dependent);
+			}
+		}
+	}
+
+	// Ce qui reste appartient à un cycle ou dépend d'un cycle
+	std::string cycle;
+	for (size_t i = 0; i < n; ++i) {
+		if (!rejected[i] && nbDependencies[i] > 0) {
+			rejected[i] = true;
+			cycle += (cycle.empty() ? "'" : ", '") + _plugins[i].info.name + "'";
+		}
+	}
+	if (!cycle.empty()) {
+		LOG(Error) << "Dependency cycle detected between plugins: " << cycle;
+	}
+
+	size_t nbRejected = 0;
+	std::vector<Plugin> sorted;
+	sorted.reserve(order.size());
+	for (size_t i : order) {
+		sorted.push_back(std::move(_plugins[i]));
+	}
+	for (size_t i = 0; i < n; ++i) {
+		if (rejected[i]) {
+			releasePlugin(_plugins[i]);
+			nbRejected++;
+		}
+	}
+	_plugins = std::move(sorted);
+	return nbRejected;
+}
+
+PluginsManager::DependencyGraph PluginsManager::buildDependencyGraph() const {
+	DependencyGraph graph;
+	graph.dependencies.resize(_plugins.size());
+	graph.dependents.resize(_plugins.size());
+	std::unordered_map<std::string, size_t> byName;
+	for (size_t i = 0; i < _plugins.size(); ++i) {
+		byName.emplace(_plugins[i].info.name, i);
+	}
+	for (size_t i = 0; i < _plugins.size(); ++i) {
+		for (const auto& dependency : _plugins[i].info.dependencies) {
+			auto it = byName.find(dependency);
+			if (it != byName.end()) {
+				graph.dependencies[i].push_back(it->second);
+				graph.dependents[it->second].push_back(i);
+			}
+		}
+	}
+	return graph;
+}
+
+void PluginsManager::loadPlugins() {
+	std::lock_guard<std::mutex> lock(_writeMutex);
+	auto start = std::chrono::steady_clock::now();
+	size_t loadedPlugins = 0;
+	size_t deferred = 0;
+	std::vector<fs::path> files = findPluginFiles();
+	for (const auto& path : filterPluginFiles(files, deferred)) {
+		if (loadPlugin(path))
+			loadedPlugins++;
+	}
+	loadedPlugins += deferred;
+
+	// Trier les plugins par priorité et par dépendances
+	loadedPlugins -= sortPlugins();
+
+	auto elapsed = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start);
+	LOG(Info) << loadedPlugins << "/" << files.size() << " plugins loaded and sorted by priority in " << elapsed.count() << " ms"
+		<< (deferred ? " (" + std::to_string(deferred) + " deferred until first use)." : ".");
+}
+
+void PluginsManager::loadPluginsParallel(size_t nbThreads) {
+	std::lock_guard<std::mutex> lock(_writeMutex);
+	auto start = std::chrono::steady_clock::now();
+	std::vector<fs::path> files = findPluginFiles();
+	size_t deferred = 0;
+	std::vector<fs::path> candidates = filterPluginFiles(files, deferred);
+	std::vector<PluginLoadResult> results(candidates.size());
+	for (size_t i = 0; i < candidates.size(); ++i) {
+		results[i].path = candidates[i];
+	}
+
+	if (nbThreads == 0) {
+		nbThreads = std::max(1u, std::thread::hardware_concurrency());
+	}
+	nbThreads = std::min(nbThreads, std::max<size_t>(candidates.size(), 1));
+
+	// Chaque thread prend le prochain fichier libre, les plugins lents n'attendent pas les autres
+	std::atomic<size_t> next{0};
+	auto worker = [&]() {
+		for (size_t i = next.fetch_add(1); i < results.size(); i = next.fetch_add(1)) {
+			openPlugin(results[i]);
+		}
+	};
+	std::vector<std::thread> workers;
+	for (size_t t = 1; t < nbThreads; ++t) {
+		workers.emplace_back(worker);
+	}
+	worker();
+	for (auto& thread : workers) {
+		thread.join();
+	}
+
+	// Fusion dans l'ordre des fichiers : mêmes logs et même ordre final que le chargement séquentiel
+	size_t loadedPlugins = deferred;
+	std::chrono::nanoseconds serialTime{0};
+	for (auto& result : results) {
+		serialTime += result.duration;
+		if (commitPlugin(result))
+			loadedPlugins++;
+	}
+
+	loadedPlugins -= sortPlugins();
+
+	auto elapsed = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start);
+	auto serial = std::chrono::duration<double, std::milli>(serialTime);
+	LOG(Info) << loadedPlugins << "/" << files.size() << " plugins loaded and sorted by priority in " << elapsed.count()
+		<< " ms with " << nbThreads << " threads (serial load time " << serial.count() << " ms, speedup x"
+		<< (elapsed.count() > 0 ? serial.count() / elapsed.count() : 1.0) << ")"
+		<< (deferred ? ", " + std::to_string(deferred) + " deferred until first use." : ".");
+}
+
+void PluginsManager::openPlugin(PluginLoadResult& result) const {
+	auto start = std::chrono::steady_clock::now();
+	result.plugin = { nullptr, nullptr, {}, result.path, PluginHandle::INVALID };
+	result.error.clear();
+
+	auto fail = [&](const std::string& error) {
+		result.error = error;
+		result.duration = std::chrono::steady_clock::now() - start;
+	};
+
+	result.timings = {};
+	LifecycleTimings& timings = result.timings;
+	void* handle;
+	{
+		PhaseTimer timer(timings[LifecyclePhase::Dlopen]);
+		handle = dlopen(result.path.c_str(), RTLD_LAZY);
+	}
 	if (!handle) {
-		LOG(Error) << "Cannot open library: " << dlerror();
-		return false;
+		return fail(std::string("Cannot open library: ") + dlerror());
 	}
 
-	create_t* create_plugin = reinterpret_cast<create_t*>(dlsym(handle, "create"));
-	const char* dlsym_error = dlerror();
+	create_t* create_plugin;
+	destroy_t* destroy_plugin;
+	const char* dlsym_error;
+	{
+		PhaseTimer timer(timings[LifecyclePhase::Dlsym]);
+		create_plugin = reinterpret_cast<create_t*>(dlsym(handle, "create"));
+		dlsym_error = dlerror();
+		destroy_plugin = dlsym_error ? nullptr : reinterpret_cast<destroy_t*>(dlsym(handle, "destroy"));
+	}
 	if (dlsym_error) {
-		LOG(Error) << "Cannot load symbol create: " << dlsym_error;
+		fail(std::string("Cannot load symbol create: ") + dlsym_error);
 		dlclose(handle);
-		return false;
+		return;
 	}
-
-	destroy_t* destroy_plugin = reinterpret_cast<destroy_t*>(dlsym(handle, "destroy"));
 	dlsym_error = dlerror();
 	if (dlsym_error) {
-		LOG(Error) << "Cannot load symbol destroy: " << dlsym_error;
+		fail(std::string("Cannot load symbol destroy: ") + dlsym_error);
 		dlclose(handle);
-		return false;
+		return;
 	}
 
-	PluginInterface* instance = create_plugin();
+	PluginInterface* instance;
+	{
+		PhaseTimer timer(timings[LifecyclePhase::Create]);
+		instance = create_plugin();
+	}
 	if (!instance) {
-		LOG(Error) << "Failed to create plugin instance.";
+		fail("Failed to create plugin instance.");
 		dlclose(handle);
-		return false;
+		return;
 	}
 
-	if (!instance->isCompatible(_mainVersion)) {
-		LOG(Error) << "Plugin '" << instance->getInfo().name << "' is not compatible with main program version.";
+	bool compatible;
+	{
+		PhaseTimer timer(timings[LifecyclePhase::IsCompatible]);
+		compatible = instance->isCompatible(_mainVersion);
+	}
+	if (!compatible) {
+		fail("Plugin '" + instance->getInfo().name + "' is not compatible with main program version.");
 		destroy_plugin(instance);
 		dlclose(handle);
+		return;
+	}
+
+	result.plugin = { handle, instance, instance->getInfo(), result.path, PluginHandle::INVALID };
+	result.duration = std::chrono::steady_clock::now() - start;
+}
+
+bool PluginsManager::commitPlugin(PluginLoadResult& result) {
+	if (!result.error.empty()) {
+		LOG(Error) << result.error;
 		return false;
 	}
 
-	instance->setInstances(&Logger::getInstance(), &ResourcesManager::getInstance());
+	// Fait par le thread appelant : setInstances modifie les singletons du plugin
+	{
+		PhaseTimer timer(result.timings[LifecyclePhase::SetInstances]);
+		result.plugin.instance->setInstances(&Logger::getInstance(), &ResourcesManager::getInstance(), &_events);
+	}
+	recordTimings(result.plugin.info.name, result.timings, LifecyclePhase::Dlopen, LifecyclePhase::SetInstances);
 
-	Plugin plugin = { handle, instance, instance->getInfo() };
-	_plugins.push_back(std::move(plugin));
+	result.plugin.id = _nextId++;
+	_plugins.push_back(std::move(result.plugin));
 
-	//LOG(Info) << "Loading " << path.filename() << " name: " << instance->getInfoToString();
+	//LOG(Info) << "Loading " << result.path.filename() << " name: " << _plugins.back().instance->getInfoToString();
 	return true;
 }
 
+bool PluginsManager::loadPlugin(const fs::path& path) {
+	PluginLoadResult result;
+	result.path = path;
+	openPlugin(result);
+	return commitPlugin(result);
+}
+
 void PluginsManager::initPlugins(int argc, char* argv[]) {
+	// Conservés pour initialiser les plugins rechargés à chaud
+	_argc = argc;
+	_argv = argv;
+	_initialized.store(true, std::memory_order_release);
 	if (_plugins.empty()) {
 		return;
 	}
+	auto start = std::chrono::steady_clock::now();
+	const size_t n = _plugins.size();
+	DependencyGraph graph = buildDependencyGraph();
+	std::unique_ptr<std::atomic<size_t>[]> remaining(new std::atomic<size_t>[n]);
+	std::unique_ptr<std::atomic<bool>[]> skipped(new std::atomic<bool>[n]);
+	std::vector<int> status(n, 0);
+	std::vector<std::string> errors(n);
+	std::vector<std::chrono::nanoseconds> durations(n, std::chrono::nanoseconds(0));
+	for (size_t i = 0; i < n; ++i) {
+		remaining[i] = graph.dependencies[i].size();
+		skipped[i] = false;
+	}
+
+	ThreadPool pool(_nbThreads);
+	std::function<void(size_t)> run = [&](size_t i) {
+		// Les plugins différés s'initialisent eux-mêmes à leur activation
+		if (!skipped[i].load() && !_plugins[i].lazy) {
+			auto begin = std::chrono::steady_clock::now();
+			try {
+				status[i] = _plugins[i].instance->init(argc, argv);
+			} catch (const std::exception& e) {
+				status[i] = -1;
+				errors[i] = e.what();
+			} catch (...) {
+				status[i] = -1;
+				errors[i] = "unknown exception";
+			}
+			durations[i] = std::chrono::steady_clock::now() - begin;
+		}
+		// Le dernier prérequis terminé libère le plugin dépendant
+		bool failed = skipped[i].load() || status[i] != 0;
+		for (size_t dependent : graph.dependents[i]) {
+			if (failed) {
+				skipped[dependent] = true;
+			}
+			if (remaining[dependent].fetch_sub(1) == 1) {
+				pool.submit([&run, dependent]() { run(dependent); });
+			}
+		}
+	};
+	for (size_t i = 0; i < n; ++i) {
+		if (graph.dependencies[i].empty()) {
+			pool.submit([&run, i]() { run(i); });
+		}
+	}
+	pool.wait();
+
 	size_t initializedPlugins = 0;
-	for (auto& plugin : _plugins) {
-		if (plugin.instance->init(argc, argv) != 0) {
-			LOG(Error) << "Failed to initialize plugin '" << plugin.info.name << "'";
+	size_t deferred = 0;
+	std::chrono::nanoseconds totalInit{0};
+	for (size_t i = 0; i < n; ++i) {
+		totalInit += durations[i];
+		if (_plugins[i].lazy) {
+			deferred++;
+			continue;
+		}
+		LifecycleTimings timings;
+		timings[LifecyclePhase::Init] = durations[i];
+		recordTimings(_plugins[i].info.name, timings, LifecyclePhase::Init, LifecyclePhase::Init);
+		if (skipped[i]) {
+			LOG(Error) << "Plugin '" << _plugins[i].info.name << "' not initialized: a dependency failed to initialize";
+		} else if (status[i] != 0) {
+			LOG(Error) << "Failed to initialize plugin '" << _plugins[i].info.name << "'" << (errors[i].empty() ? "" : ": " + errors[i]);
 		} else {
 			initializedPlugins++;
 		}
 	}
-	LOG(Info) << initializedPlugins << "/" << _plugins.size() << " plugins initialized.";
+	auto elapsed = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start);
+	LOG(Info) << initializedPlugins << "/" << (n - deferred) << " plugins initialized in " << elapsed.count() << " ms with "
+		<< pool.size() << " threads (sum of init times " << std::chrono::duration<double, std::milli>(totalInit).count() << " ms).";
 }
 
 void PluginsManager::shutdownPlugins() {
+	waitAsyncCommands();
+	_events.flush();
 	if (_plugins.empty()) {
 		return;
 	}
+	const size_t n = _plugins.size();
+	DependencyGraph graph = buildDependencyGraph();
+	std::unique_ptr<std::atomic<size_t>[]> remaining(new std::atomic<size_t>[n]);
+	std::vector<int> status(n, 0);
+	std::vector<std::string> errors(n);
+	std::vector<char> active(n, false);
+	std::vector<LifecycleTimings> timings(n);
+	for (size_t i = 0; i < n; ++i) {
+		remaining[i] = graph.dependents[i].size();
+	}
+
+	ThreadPool pool(_nbThreads);
+	std::function<void(size_t)> run = [&](size_t i) {
+		// Un plugin différé jamais activé n'a rien à arrêter
+		if (PluginInterface* instance = _plugins[i].instance) {
+			PhaseTimer timer(timings[i][LifecyclePhase::Shutdown]);
+			// Une exception ne doit pas empêcher l'arrêt des dépendances
+			try {
+				status[i] = instance->shutdown();
+			} catch (const std::exception& e) {
+				status[i] = -1;
+				errors[i] = e.what();
+			} catch (...) {
+				status[i] = -1;
+				errors[i] = "unknown exception";
+			}
+			active[i] = true;
+		}
+		// Un plugin est arrêté une fois que plus personne n'en dépend
+		for (size_t dependency : graph.dependencies[i]) {
+			if (remaining[dependency].fetch_sub(1) == 1) {
+				pool.submit([&run, dependency]() { run(dependency); });
+			}
+		}
+	};
+	for (size_t i = n; i-- > 0; ) {
+		if (graph.dependents[i].empty()) {
+			pool.submit([&run, i]() { run(i); });
+		}
+	}
+	pool.wait();
+
 	size_t shutDownPlugins = 0;
-	for (auto& plugin : _plugins) {
-		if (plugin.instance->shutdown() != 0) {
-			LOG(Error) << "Failed to shut down plugin '" << plugin.info.name << "'";
+	size_t nbActive = 0;
+	for (size_t i = 0; i < n; ++i) {
+		if (!active[i]) {
+			continue;
+		}
+		recordTimings(_plugins[i].info.name, timings[i], LifecyclePhase::Shutdown, LifecyclePhase::Shutdown);
+		nbActive++;
+		if (status[i] != 0) {
+			LOG(Error) << "Failed to shut down plugin '" << _plugins[i].info.name << "'" << (errors[i].empty() ? "" : ": " + errors[i]);
 		} else {
 			shutDownPlugins++;
 		}
 	}
-	LOG(Info) << shutDownPlugins << "/" << _plugins.size() << " plugins shut down.";
+	LOG(Info) << shutDownPlugins << "/" << nbActive << " plugins shut down.";
+}
+
+bool PluginsManager::releasePlugin(Plugin& plugin) {
+	if (!plugin.instance || !plugin.handle) {
+		return false;
+	}
+	destroy_t* destroy_plugin = reinterpret_cast<destroy_t*>(dlsym(plugin.handle, "destroy"));
+	if (!destroy_plugin) {
+		LOG(Error) << "Cannot load symbol destroy for plugin '" << plugin.info.name << "': " << dlerror();
+		return false;
+	}
+
+	// Plus aucun événement ne doit atteindre l'instance détruite
+	_events.unsubscribeAll(plugin.instance);
+
+	LifecycleTimings timings;
+	{
+		PhaseTimer timer(timings[LifecyclePhase::Destroy]);
+		destroy_plugin(plugin.instance);
+	}
+	{
+		PhaseTimer timer(timings[LifecyclePhase::Dlclose]);
+		dlclose(plugin.handle);
+	}
+	recordTimings(plugin.info.name, timings, LifecyclePhase::Destroy, LifecyclePhase::Dlclose);
+	plugin.instance = nullptr;
+	plugin.handle = nullptr;
+	return true;
 }
 
 void PluginsManager::unloadPlugins() {
+	stopHotReload();
+	waitAsyncCommands();
+	std::lock_guard<std::mutex> lock(_writeMutex);
+	std::lock_guard<std::recursive_mutex> activation(_activationMutex);
 	if (_plugins.empty()) {
 		return;
 	}
-	size_t unloadedPlugins = 0;
-	size_t nbPlugins = _plugins.size();
-	for (auto& plugin : _plugins) {
-		if (plugin.instance && plugin.handle) {
-			destroy_t* destroy_plugin = reinterpret_cast<destroy_t*>(dlsym(plugin.handle, "destroy"));
-			if (!destroy_plugin) {
-				LOG(Error) << "Cannot load symbol destroy for plugin '" << plugin.info.name << "': " << dlerror();
-				continue;
-			}
+	// Retrait des instances puis attente des appels en cours, avant toute destruction
+	std::vector<Plugin> retired;
+	for (Plugin& plugin : _plugins) {
+		if (PluginInterface* instance = plugin.instance) {
+			retired.push_back({ plugin.handle, instance, plugin.info, plugin.path, plugin.id });
+			std::atomic_ref<PluginInterface*>(plugin.instance).store(nullptr, std::memory_order_release);
+			nextGeneration(plugin);
+		}
+	}
+	_rcu.synchronize();
 
-			destroy_plugin(plugin.instance);
-			dlclose(plugin.handle);
-			plugin.instance = nullptr;
-			plugin.handle = nullptr;
+	size_t unloadedPlugins = 0;
+	size_t nbPlugins = 0;
+	// Ordre inverse : un plugin dépendant (ses variables dérivées par exemple) est détruit avant ses dépendances
+	for (auto it = retired.rbegin(); it != retired.rend(); ++it) {
+		Plugin& plugin = *it;
+		nbPlugins++;
+		if (releasePlugin(plugin)) {
 			unloadedPlugins++;
 		}
 	}
 	_plugins.clear();
+	_unloadedValues.clear();
+	rebuildIndex();
 	LOG(Info) << unloadedPlugins << "/" << nbPlugins << " plugins unloaded.";
 }
 
+PluginInterface* PluginsManager::acquire(Plugin& plugin) noexcept {
+	return std::atomic_ref<PluginInterface*>(plugin.instance).load(std::memory_order_acquire);
+}
+
+void PluginsManager::nextGeneration(Plugin& plugin) noexcept {
+	// Après la publication de l'instance : un lecteur qui voit la nouvelle génération voit aussi la nouvelle instance
+	std::atomic_ref<uint64_t>(plugin.generation).fetch_add(1, std::memory_order_release);
+}
+
+Plugin* PluginsManager::findPlugin(const std::string& pluginName) {
+	auto it = _index.find(pluginName);
+	return it != _index.end() ? &_plugins[it->second] : nullptr;
+}
+
+Plugin* PluginsManager::findPlugin(PluginHandle handle) noexcept {
+	if (handle.id >= _slots.size() || _slots[handle.id] == SIZE_MAX) {
+		return nullptr;
+	}
+	return &_plugins[_slots[handle.id]];
+}
+
+PluginHandle PluginsManager::getHandle(std::string_view pluginName) const {
+	auto it = _index.find(pluginName);
+	return it != _index.end() ? PluginHandle{ _plugins[it->second].id } : PluginHandle{};
+}
+
+const Plugin* PluginsManager::getPlugin(PluginHandle handle) const noexcept {
+	if (handle.id >= _slots.size() || _slots[handle.id] == SIZE_MAX) {
+		return nullptr;
+	}
+	return &_plugins[_slots[handle.id]];
+}
+
 void PluginsManager::setVariable(const std::string& pluginName, const std::string& varName, const VariantType& value) {
-	for (auto& plugin : _plugins) {
-		if (plugin.info.name == pluginName) {
-			plugin.instance->setVariable(varName, value);
-			return;
-		}
+	PluginHandle handle = getHandle(pluginName);
+	if (!handle.ok()) {
+		LOG(Error) << "Plugin '" << pluginName << "' not found.";
+		return;
 	}
-	LOG(Error) << "Plugin '" << pluginName << "' not found.";
+	setVariable(handle, varName, value);
 }
 
 VariantType PluginsManager::getVariable(const std::string& pluginName, const std::string& varName) {
-	for (auto& plugin : _plugins) {
-		if (plugin.info.name == pluginName) {
-			return plugin.instance->getVariable(varName);
+	PluginHandle handle = getHandle(pluginName);
+	if (!handle.ok()) {
+		LOG(Error) << "Plugin '" << pluginName << "' not found.";
+		return VariantType(); // Return a default value (empty variant) if plugin not found
+	}
+	return getVariable(handle, varName);
+}
+
+std::vector<VariantType> PluginsManager::callCommand(const std::string& pluginName, const std::string& commandOrAlias, const std::vector<VariantType>& args) {
+	PluginHandle handle = getHandle(pluginName);
+	if (!handle.ok()) {
+		LOG(Error) << "Plugin '" << pluginName << "' not found.";
+		return std::vector<VariantType>();
+	}
+	return callCommand(handle, commandOrAlias, args);
+}
+
+template<typename F>
+bool PluginsManager::withInstance(Plugin& plugin, F&& function) {
+	// L'activation a lieu hors de la section de lecture : les lecteurs ne bloquent jamais une période de grâce
+	while (activate(plugin)) {
+		auto guard = _rcu.read();
+		if (PluginInterface* instance = acquire(plugin)) {
+			if (plugin.lazy) {
+				std::atomic_ref<int64_t>(plugin.lastAccess).store(std::chrono::steady_clock::now().time_since_epoch().count(), std::memory_order_relaxed);
+			}
+			function(instance);
+			return true;
+		}
+		// Déchargé pour inactivité entre l'activation et la lecture : on recommence
+	}
+	LOG(Error) << "Plugin '" << plugin.info.name << "' is not available.";
+	return false;
+}
+
+void PluginsManager::setVariable(PluginHandle handle, const std::string& varName, const VariantType& value) {
+	if (Plugin* plugin = findPlugin(handle)) {
+		withInstance(*plugin, [&](PluginInterface* instance) { instance->setVariable(varName, value); });
+		return;
+	}
+	LOG(Error) << "Invalid plugin handle " << handle.id << ".";
+}
+
+VariantType PluginsManager::getVariable(PluginHandle handle, const std::string& varName) {
+	VariantType value;
+	if (Plugin* plugin = findPlugin(handle)) {
+		withInstance(*plugin, [&](PluginInterface* instance) { value = instance->getVariable(varName); });
+		return value;
+	}
+	LOG(Error) << "Invalid plugin handle " << handle.id << ".";
+	return value;
+}
+
+std::vector<VariantType> PluginsManager::callCommand(PluginHandle handle, const std::string& commandOrAlias, const std::vector<VariantType>& args) {
+	std::vector<VariantType> results;
+	if (Plugin* plugin = findPlugin(handle)) {
+		withInstance(*plugin, [&](PluginInterface* instance) { results = instance->callCommand(commandOrAlias, args); });
+		return results;
+	}
+	LOG(Error) << "Invalid plugin handle " << handle.id << ".";
+	return results;
+}
+
+std::vector<VariantType> PluginsManager::callCommandOrThrow(PluginHandle handle, const std::string& commandOrAlias, const std::vector<VariantType>& args) {
+	// Variante des appels asynchrones : l'échec est transmis au future au lieu d'un résultat vide
+	std::vector<VariantType> results;
+	Plugin* plugin = findPlugin(handle);
+	if (!plugin) {
+		throw PluginNotFoundException("#" + std::to_string(handle.id));
+	}
+	if (!withInstance(*plugin, [&](PluginInterface* instance) { results = instance->callCommand(commandOrAlias, args); })) {
+		throw PluginNotFoundException(plugin->info.name);
+	}
+	return results;
+}
+
+CommandExecutor& PluginsManager::getExecutor() {
+	std::lock_guard<std::mutex> lock(_executorMutex);
+	if (!_executor) {
+		size_t nbThreads = _executorThreads ? _executorThreads : std::max(1u, std::thread::hardware_concurrency());
+		// Un thread de plus que de threads de travail : la dernière file est celle du thread qui attend
+		_executor = std::make_unique<ThreadPool>(nbThreads + 1, _executorCapacity);
+	}
+	return *_executor;
+}
+
+void PluginsManager::waitAsyncCommands() {
+	ThreadPool* executor;
+	{
+		std::lock_guard<std::mutex> lock(_executorMutex);
+		executor = _executor.get();
+	}
+	if (executor) {
+		executor->wait();
+	}
+}
+
+std::future<std::vector<VariantType>> PluginsManager::callCommandAsync(const std::string& pluginName, const std::string& commandOrAlias,
+	std::vector<VariantType> args, std::optional<CancellationToken> token)
+{
+	PluginHandle handle = getHandle(pluginName);
+	if (!handle.ok()) {
+		LOG(Error) << "Plugin '" << pluginName << "' not found.";
+		std::promise<std::vector<VariantType>> promise;
+		promise.set_exception(std::make_exception_ptr(PluginNotFoundException(pluginName)));
+		return promise.get_future();
+	}
+	return callCommandAsync(handle, commandOrAlias, std::move(args), std::move(token));
+}
+
+std::future<std::vector<VariantType>> PluginsManager::callCommandAsync(PluginHandle handle, const std::string& commandOrAlias,
+	std::vector<VariantType> args, std::optional<CancellationToken> token)
+{
+	auto promise = std::make_shared<std::promise<std::vector<VariantType>>>();
+	std::future<std::vector<VariantType>> future = promise->get_future();
+	getExecutor().submit(makeCommandTask(std::move(promise), std::move(token), commandOrAlias,
+		[this, handle, commandOrAlias, args = std::move(args)]() { return callCommandOrThrow(handle, commandOrAlias, args); }));
+	return future;
+}
+
+std::vector<std::future<std::vector<VariantType>>> PluginsManager::callCommandsAsync(std::vector<CommandCall> calls,
+	std::optional<CancellationToken> token)
+{
+	std::vector<std::future<std::vector<VariantType>>> futures;
+	std::vector<CommandExecutor::Task> tasks;
+	futures.reserve(calls.size());
+	tasks.reserve(calls.size());
+	for (auto& call : calls) {
+		auto promise = std::make_shared<std::promise<std::vector<VariantType>>>();
+		futures.push_back(promise->get_future());
+		PluginHandle handle = getHandle(call.plugin);
+		if (!handle.ok()) {
+			LOG(Error) << "Plugin '" << call.plugin << "' not found.";
+			promise->set_exception(std::make_exception_ptr(PluginNotFoundException(call.plugin)));
+			continue;
+		}
+		tasks.push_back(makeCommandTask(std::move(promise), token, call.command,
+			[this, handle, command = std::move(call.command), args = std::move(call.args)]() { return callCommandOrThrow(handle, command, args); }));
+	}
+	getExecutor().submitBatch(std::move(tasks));
+	return futures;
+}
+
+CommandPipeline PluginsManager::compilePipeline(const CommandBatch& batch) {
+	CommandPipeline pipeline;
+	std::vector<size_t> levels;					// Niveau de chaque étape
+	std::vector<CommandSignature> signatures;	// Pour vérifier les branchements des étapes suivantes
+	std::vector<size_t> nbReturns;
+	pipeline._steps.reserve(batch._steps.size());
+
+	for (size_t i = 0; i < batch._steps.size(); ++i) {
+		const CommandCall& call = batch._steps[i].call;
+		const std::vector<StepInput>& inputs = batch._steps[i].inputs;
+
+		PluginHandle handle = getHandle(call.plugin);
+		Plugin* plugin = findPlugin(handle);
+		if (!plugin) {
+			throw InvalidPipelineException(i, "plugin '" + call.plugin + "' not found");
+		}
+
+		// Informations de la commande, copiées tant que l'instance est retenue
+		bool found = false;
+		size_t nbArgs = 0;
+		size_t nbDefaults = 0;
+		CommandSignature signature;
+		bool available = withInstance(*plugin, [&](PluginInterface* instance) {
+			CommandHandle command = instance->getCommandHandle(call.command);
+			if (command.ok()) {
+				found = true;
+				nbArgs = command.info().nb_args;
+				nbDefaults = command.info().default_args.size();
+				nbReturns.push_back(command.info().nb_returns);
+				signature = command.info().signature;
+			}
+		});
+		if (!available) {
+			throw InvalidPipelineException(i, "plugin '" + call.plugin + "' is not available");
+		}
+		if (!found) {
+			throw InvalidPipelineException(i, "command '" + call.plugin + "." + call.command + "' not found");
+		}
+
+		// Branchements : uniquement vers des étapes précédentes, ce qui exclut les cycles
+		size_t count = call.args.size();
+		size_t level = 0;
+		for (const StepInput& input : inputs) {
+			if (input.step >= i) {
+				throw InvalidPipelineException(i, "argument " + std::to_string(input.argument) + " uses step " + std::to_string(input.step) + ", which is not before it");
+			}
+			if (input.result >= nbReturns[input.step]) {
+				throw InvalidPipelineException(i, "step " + std::to_string(input.step) + " returns only " + std::to_string(nbReturns[input.step]) + " values");
+			}
+			count = std::max(count, input.argument + 1);
+			level = std::max(level, levels[input.step] + 1);
+		}
+		if (count > nbArgs || count + nbDefaults < nbArgs) {
+			throw InvalidPipelineException(i, "command '" + call.command + "' expects " + std::to_string(nbArgs - nbDefaults) + " to " +
+				std::to_string(nbArgs) + " arguments, " + std::to_string(count) + " provided");
+		}
+
+		// Chaque argument doit être fourni ou branché, avec un type accepté par une commande typée
+		std::vector<bool> wired(count, false);
+		for (const StepInput& input : inputs) {
+			wired[input.argument] = true;
+			if (signature.typed && signatures[input.step].typed) {
+				size_t type = signatures[input.step].returns[input.result];
+				if (!((signature.accepted[input.argument] >> type) & 1)) {
+					throw InvalidPipelineException(i, "argument " + std::to_string(input.argument) + " expects " + VariantIndexName(signature.args[input.argument]) +
+						", step " + std::to_string(input.step) + " returns " + VariantIndexName(type));
+				}
+			}
+		}
+		for (size_t argument = 0; argument < count; ++argument) {
+			if (wired[argument]) {
+				continue;
+			}
+			if (argument >= call.args.size()) {
+				throw InvalidPipelineException(i, "argument " + std::to_string(argument) + " is neither provided nor wired");
+			}
+			if (signature.typed && !signature.accepts(argument, call.args[argument])) {
+				throw InvalidPipelineException(i, "argument " + std::to_string(argument) + " expects " + VariantIndexName(signature.args[argument]) +
+					", not " + VariantTypeName(call.args[argument]));
+			}
 		}
+
+		auto slot = std::find(pipeline._plugins.begin(), pipeline._plugins.end(), handle);
+		if (slot == pipeline._plugins.end()) {
+			slot = pipeline._plugins.insert(slot, handle);
+		}
+
+		CommandPipeline::Step step;
+		step.plugin = slot - pipeline._plugins.begin();
+		step.command = call.command;
+		step.generation = CommandPipeline::UNRESOLVED;	// Résolu à la première exécution
+		step.args = call.args;
+		step.args.resize(count);
+		step.inputs = inputs;
+		step.results.reserve(nbReturns.back());
+		pipeline._steps.push_back(std::move(step));
+
+		if (level >= pipeline._levels.size()) {
+			pipeline._levels.resize(level + 1);
+		}
+		pipeline._levels[level].push_back(i);
+		levels.push_back(level);
+		signatures.push_back(std::move(signature));
+	}
+	pipeline._instances.resize(pipeline._plugins.size());
+	pipeline._generations.resize(pipeline._plugins.size());
+	pipeline._jobs.resize(pipeline._steps.size());
+	return pipeline;
+}
+
+void PluginsManager::runStep(CommandPipeline& pipeline, size_t index) {
+	CommandPipeline::Step& step = pipeline._steps[index];
+	uint64_t generation = pipeline._generations[step.plugin];
+	if (step.generation != generation) {
+		// Première exécution, ou plugin rechargé depuis la dernière : la commande est recherchée dans l'instance courante
+		step.handle = pipeline._instances[step.plugin]->getCommandHandle(step.command);
+		if (!step.handle.ok()) {
+			step.generation = CommandPipeline::UNRESOLVED;
+			throw CommandNotFoundException(step.command);
+		}
+		step.generation = generation;
+	}
+	for (const StepInput& input : step.inputs) {
+		const std::vector<VariantType>& results = pipeline._steps[input.step].results;
+		if (input.result >= results.size()) {
+			throw InvalidPipelineException(index, "step " + std::to_string(input.step) + " returned only " + std::to_string(results.size()) + " values");
+		}
+		step.args[input.argument] = results[input.result];
 	}
-	LOG(Error) << "Plugin '" << pluginName << "' not found.";
-	return VariantType(); // Return a default value (empty variant) if plugin not found
+	step.handle.call(step.args, step.results);
+}
+
+void PluginsManager::runPipeline(CommandPipeline& pipeline, bool parallel) {
+	while (true) {
+		// L'activation a lieu hors de la section de lecture, comme dans withInstance
+		for (PluginHandle handle : pipeline._plugins) {
+			Plugin* plugin = findPlugin(handle);
+			if (!plugin || !activate(*plugin)) {
+				throw std::runtime_error("Pipeline plugin " + std::to_string(handle.id) + " is not available");
+			}
+		}
+
+		// Toutes les instances sont retenues jusqu'à la fin de l'exécution
+		auto guard = _rcu.read();
+		bool acquired = true;
+		for (size_t i = 0; i < pipeline._plugins.size() && acquired; ++i) {
+			Plugin& plugin = *findPlugin(pipeline._plugins[i]);
+			// Génération lue avant l'instance : une génération à jour garantit une instance à jour
+			pipeline._generations[i] = std::atomic_ref<uint64_t>(plugin.generation).load(std::memory_order_acquire);
+			pipeline._instances[i] = acquire(plugin);
+			acquired = pipeline._instances[i] != nullptr;
+			if (acquired && plugin.lazy) {
+				std::atomic_ref<int64_t>(plugin.lastAccess).store(std::chrono::steady_clock::now().time_since_epoch().count(), std::memory_order_relaxed);
+			}
+		}
+		if (!acquired) {
+			continue;	// Déchargé pour inactivité entre l'activation et la lecture : on recommence
+		}
+
+		if (!parallel) {
+			for (size_t i = 0; i < pipeline._steps.size(); ++i) {
+				runStep(pipeline, i);
+			}
+			return;
+		}
+
+		// Niveau par niveau : le thread appelant exécute la première étape, l'exécuteur les autres
+		for (const std::vector<size_t>& level : pipeline._levels) {
+			if (level.size() == 1) {
+				runStep(pipeline, level[0]);
+				continue;
+			}
+			std::latch done(level.size() - 1);
+			CommandExecutor& executor = getExecutor();
+			for (size_t k = 1; k < level.size(); ++k) {
+				CommandPipeline::Job* job = &pipeline._jobs[level[k]];
+				*job = { this, &pipeline, level[k], &done };
+				executor.submit([job]() {
+					try {
+						job->manager->runStep(*job->pipeline, job->step);
+					} catch (...) {
+						job->pipeline->_steps[job->step].error = std::current_exception();
+					}
+					job->done->count_down();
+				});
+			}
+
+			std::exception_ptr error;
+			try {
+				runStep(pipeline, level[0]);
+			} catch (...) {
+				error = std::current_exception();
+			}
+			done.wait();
+			for (size_t index : level) {
+				if (!error) {
+					error = pipeline._steps[index].error;
+				}
+				pipeline._steps[index].error = nullptr;
+			}
+			if (error) {
+				std::rethrow_exception(error);
+			}
+		}
+		return;
+	}
+}
+
+ResolvedCommand PluginsManager::resolveCommand(PluginHandle handle, const std::string& commandOrAlias, std::span<const VariantType> args) {
+	Plugin* plugin = findPlugin(handle);
+	if (!plugin) {
+		throw PluginNotFoundException("#" + std::to_string(handle.id));
+	}
+	bool found = false;
+	size_t nbArgs = 0;
+	size_t nbDefaults = 0;
+	CommandSignature signature;
+	bool available = withInstance(*plugin, [&](PluginInterface* instance) {
+		CommandHandle command = instance->getCommandHandle(commandOrAlias);
+		if (command.ok()) {
+			found = true;
+			nbArgs = command.info().nb_args;
+			nbDefaults = command.info().default_args.size();
+			signature = command.info().signature;
+		}
+	});
+	if (!available) {
+		throw PluginNotFoundException(plugin->info.name);
+	}
+	if (!found) {
+		throw CommandNotFoundException(commandOrAlias);
+	}
+	if (args.size() > nbArgs || args.size() + nbDefaults < nbArgs) {
+		throw InvalidArgumentsException(commandOrAlias, nbArgs, nbDefaults, args.size());
+	}
+	for (size_t i = 0; signature.typed && i < args.size(); ++i) {
+		if (!signature.accepts(i, args[i])) {
+			throw CommandArgumentTypeException(commandOrAlias, i, signature.args[i], args[i].index());
+		}
+	}
+
+	ResolvedCommand command;
+	command._plugin = handle;
+	command._command = commandOrAlias;
+	return command;
+}
+
+void PluginsManager::callCommand(ResolvedCommand& command, std::span<const VariantType> args, std::vector<VariantType>& results) {
+	Plugin* plugin = findPlugin(command._plugin);
+	if (!plugin) {
+		throw PluginNotFoundException("#" + std::to_string(command._plugin.id));
+	}
+	while (true) {
+		{
+			auto guard = _rcu.read();
+			// Génération lue avant l'instance, comme dans runPipeline
+			uint64_t generation = std::atomic_ref<uint64_t>(plugin->generation).load(std::memory_order_acquire);
+			if (PluginInterface* instance = acquire(*plugin)) {
+				if (plugin->lazy) {
+					std::atomic_ref<int64_t>(plugin->lastAccess).store(std::chrono::steady_clock::now().time_since_epoch().count(), std::memory_order_relaxed);
+				}
+				if (command._generation != generation) {
+					command._handle = instance->getCommandHandle(command._command);
+					if (!command._handle.ok()) {
+						command._generation = ResolvedCommand::UNRESOLVED;
+						throw CommandNotFoundException(command._command);
+					}
+					command._generation = generation;
+				}
+				command._handle.call(args, results);
+				return;
+			}
+		}
+		// Déchargé pour inactivité : l'activation a lieu hors de la section de lecture
+		if (!activate(*plugin)) {
+			throw PluginNotFoundException(plugin->info.name);
+		}
+	}
+}
+
+bool PluginsManager::activate(Plugin& plugin) {
+	if (acquire(plugin)) {
+		return true;
+	}
+	if (!plugin.lazy) {
+		return false;
+	}
+
+	// init recevrait des arguments vides
+	if (!_initialized.load(std::memory_order_acquire)) {
+		LOG(Error) << "Cannot activate plugin '" << plugin.info.name << "' before initPlugins";
+		return false;
+	}
+
+	// Double vérification : un seul thread charge le plugin, les autres trouvent l'instance publiée
+	std::lock_guard<std::recursive_mutex> lock(_activationMutex);
+	if (acquire(plugin)) {
+		return true;
+	}
+	for (const auto& dependency : plugin.info.dependencies) {
+		Plugin* required = findPlugin(dependency);
+		if (!required || !activate(*required)) {
+			LOG(Error) << "Cannot activate plugin '" << plugin.info.name << "': dependency '" << dependency << "' is not available";
+			return false;
+		}
+	}
+
+	auto start = std::chrono::steady_clock::now();
+	PluginLoadResult result;
+	if (plugin.activations == 0) {
+		result.path = plugin.path;
+		openPlugin(result);
+	} else {
+		openPluginCopy(result, plugin.path);
+	}
+	if (!result.error.empty()) {
+		LOG(Error) << result.error;
+		return false;
+	}
+	if (result.plugin.info.name != plugin.info.name) {
+		LOG(Error) << "Library " << plugin.path.filename() << " provides plugin '" << result.plugin.info.name << "' instead of '" << plugin.info.name << "'";
+		releasePlugin(result.plugin);
+		return false;
+	}
+	recordTimings(plugin.info.name, result.timings, LifecyclePhase::Dlopen, LifecyclePhase::IsCompatible);
+	if (!initInstance(result.plugin)) {
+		releasePlugin(result.plugin);
+		return false;
+	}
+	// Configuration puis instantané, dans le même ordre qu'au démarrage. La configuration est gardée : une instance
+	// rechargée après un déchargement pour inactivité repart des valeurs par défaut de son init
+	if (_configured.contains(plugin.info.name)) {
+		std::vector<std::string> errors;
+		size_t applied = _config->apply(plugin.info.name, *result.plugin.instance, errors);
+		for (const std::string& error : errors) {
+			LOG(Warning) << "Configuration ignored: " << error;
+		}
+		LOG(Debug) << applied << " variables of plugin '" << plugin.info.name << "' configured";
+	}
+	if (auto pending = _snapshotPending.find(plugin.info.name); pending != _snapshotPending.end()) {
+		std::vector<std::string> mismatches;
+		size_t restored = _snapshot->restore(plugin.info.name, *result.plugin.instance, mismatches);
+		for (const std::string& mismatch : mismatches) {
+			LOG(Warning) << "Variable not restored: " << mismatch;
+		}
+		LOG(Debug) << restored << " variables of plugin '" << plugin.info.name << "' restored from snapshot";
+		_snapshotPending.erase(pending);
+		if (_snapshotPending.empty()) {
+			_snapshot.reset();
+		}
+	}
+	// Valeurs du dernier déchargement pour inactivité, plus récentes que le fichier de configuration et l'instantané
+	if (auto unloaded = _unloadedValues.find(plugin.info.name); unloaded != _unloadedValues.end()) {
+		for (const auto& [name, value] : unloaded->second) {
+			VariableHandle<> handle = result.plugin.instance->getVariableHandle(name);
+			if (!handle.ok() || handle.derived() || handle.type() != value.index() || !handle.set(value)) {
+				LOG(Warning) << "Variable '" << name << "' of plugin '" << plugin.info.name << "' changed since it was unloaded, value not restored";
+			}
+		}
+		_unloadedValues.erase(unloaded);
+	}
+	relinkDerived(plugin, *result.plugin.instance);
+
+	plugin.handle = result.plugin.handle;
+	plugin.activations++;
+	std::atomic_ref<int64_t>(plugin.lastAccess).store(std::chrono::steady_clock::now().time_since_epoch().count(), std::memory_order_relaxed);
+	std::atomic_ref<PluginInterface*>(plugin.instance).store(result.plugin.instance, std::memory_order_release);
+	nextGeneration(plugin);
+
+	auto elapsed = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start);
+	LOG(Info) << "Plugin '" << plugin.info.name << "' activated in " << elapsed.count() << " ms.";
+	return true;
+}
+
+size_t PluginsManager::unloadIdlePlugins(std::chrono::milliseconds timeout) {
+	std::lock_guard<std::mutex> lock(_writeMutex);
+	std::lock_guard<std::recursive_mutex> activation(_activationMutex);
+	const int64_t now = std::chrono::steady_clock::now().time_since_epoch().count();
+	const int64_t limit = std::chrono::duration_cast<std::chrono::nanoseconds>(timeout).count();
+
+	// Ordre inverse : les plugins dépendants sont déchargés avant leurs dépendances
+	size_t unloaded = 0;
+	for (size_t i = _plugins.size(); i-- > 0; ) {
+		Plugin& plugin = _plugins[i];
+		if (!plugin.lazy || !plugin.instance) {
+			continue;
+		}
+		int64_t idle = now - std::atomic_ref<int64_t>(plugin.lastAccess).load(std::memory_order_relaxed);
+		if (idle < limit) {
+			continue;
+		}
+		bool required = std::any_of(_plugins.begin(), _plugins.end(), [&](const Plugin& other) {
+			return other.instance && std::find(other.info.dependencies.begin(), other.info.dependencies.end(), plugin.info.name) != other.info.dependencies.end();
+		});
+		// Des variables dérivées d'autres plugins lisent ses variables
+		if (required || plugin.instance->hasExternalDependents()) {
+			continue;
+		}
+
+		PluginInterface* instance = plugin.instance;
+		std::atomic_ref<PluginInterface*>(plugin.instance).store(nullptr, std::memory_order_release);
+		nextGeneration(plugin);
+		_rcu.synchronize();
+
+		// Plus aucun appel en cours : les valeurs sont définitives, elles seront rendues à la prochaine activation
+		std::vector<std::pair<std::string, VariantType>> values;
+		instance->forEachVariable([&](const std::string& name, const VariantType& value) {
+			if (!instance->isDerivedVariable(name)) {
+				values.emplace_back(name, value);
+			}
+		});
+		_unloadedValues.insert_or_assign(plugin.info.name, std::move(values));
+		LifecycleTimings timings;
+		{
+			PhaseTimer timer(timings[LifecyclePhase::Shutdown]);
+			instance->shutdown();
+		}
+		recordTimings(plugin.info.name, timings, LifecyclePhase::Shutdown, LifecyclePhase::Shutdown);
+		Plugin retired = { plugin.handle, instance, plugin.info, plugin.path, PluginHandle::INVALID };
+		releasePlugin(retired);
+		plugin.handle = nullptr;
+		unloaded++;
+		LOG(Info) << "Plugin '" << plugin.info.name << "' unloaded after " << idle / 1000000 << " ms of inactivity.";
+	}
+	return unloaded;
+}
+
+bool PluginsManager::startHotReload() {
+	if (_watching) {
+		return true;
+	}
+	int fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+	if (fd < 0) {
+		LOG(Error) << "Cannot initialize inotify: " << strerror(errno);
+		return false;
+	}
+	// IN_MOVED_TO couvre les installations par renommage atomique, IN_CLOSE_WRITE les réécritures du linker
+	if (inotify_add_watch(fd, _pluginsDir.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO) < 0) {
+		LOG(Error) << "Cannot watch directory '" << _pluginsDir << "': " << strerror(errno);
+		close(fd);
+		return false;
+	}
+	_watching = true;
+	_watcher = std::thread(&PluginsManager::watchLoop, this, fd);
+	LOG(Info) << "Watching '" << _pluginsDir << "' for plugin changes.";
+	return true;
+}
+
+void PluginsManager::stopHotReload() {
+	if (!_watching.exchange(false)) {
+		return;
+	}
+	_watcher.join();
+}
+
+void PluginsManager::watchLoop(int fd) {
+	alignas(struct inotify_event) char buffer[4096];
+	while (_watching) {
+		pollfd pfd = { fd, POLLIN, 0 };
+		if (poll(&pfd, 1, 200) <= 0) {
+			continue;
+		}
+		auto detected = std::chrono::steady_clock::now();
+
+		// Un même fichier peut produire plusieurs événements, il n'est rechargé qu'une fois
+		std::set<std::string> changed;
+		ssize_t length;
+		while ((length = read(fd, buffer, sizeof(buffer))) > 0) {
+			for (char* ptr = buffer; ptr < buffer + length; ) {
+				auto* event = reinterpret_cast<struct inotify_event*>(ptr);
+				if (event->len > 0 && fs::path(event->name).extension() == ".so") {
+					changed.insert(event->name);
+				}
+				ptr += sizeof(struct inotify_event) + event->len;
+			}
+		}
+
+		std::lock_guard<std::mutex> lock(_writeMutex);
+		for (const auto& file : changed) {
+			for (auto& plugin : _plugins) {
+				if (plugin.path.filename() == file) {
+					reload(plugin, detected);
+				}
+			}
+		}
+	}
+	close(fd);
+}
+
+bool PluginsManager::reloadPlugin(const std::string& pluginName) {
+	auto requested = std::chrono::steady_clock::now();
+	std::lock_guard<std::mutex> lock(_writeMutex);
+	Plugin* plugin = findPlugin(pluginName);
+	if (!plugin) {
+		LOG(Error) << "Plugin '" << pluginName << "' not found.";
+		return false;
+	}
+	return reload(*plugin, requested);
+}
+
+void PluginsManager::recordTimings(const std::string& pluginName, const LifecycleTimings& timings, LifecyclePhase first, LifecyclePhase last) {
+	std::lock_guard<std::mutex> lock(_timingsMutex);
+	LifecycleTimings& recorded = _timings[pluginName];
+	for (size_t p = static_cast<size_t>(first); p <= static_cast<size_t>(last); ++p) {
+		recorded.phases[p] = timings.phases[p];
+	}
+}
+
+LifecycleTimings PluginsManager::getTimings(const std::string& pluginName) const {
+	std::lock_guard<std::mutex> lock(_timingsMutex);
+	auto it = _timings.find(pluginName);
+	return it != _timings.end() ? it->second : LifecycleTimings();
+}
+
+std::vector<std::pair<std::string, LifecycleTimings>> PluginsManager::getSlowestPlugins(size_t count) const {
+	std::vector<std::pair<std::string, LifecycleTimings>> plugins;
+	{
+		std::lock_guard<std::mutex> lock(_timingsMutex);
+		plugins.assign(_timings.begin(), _timings.end());
+	}
+	std::stable_sort(plugins.begin(), plugins.end(), [](const auto& a, const auto& b) {
+		return a.second.total() > b.second.total();
+	});
+	plugins.resize(std::min(count, plugins.size()));
+	return plugins;
+}
+
+std::string PluginsManager::getTimingsReport(size_t slowest) const {
+	std::lock_guard<std::mutex> lock(_timingsMutex);
+	return toJson(std::vector<std::pair<std::string, LifecycleTimings>>(_timings.begin(), _timings.end()), slowest);
+}
+
+PluginCommandStats PluginsManager::getCommandStats() {
+	PluginCommandStats stats;
+	std::lock_guard<std::mutex> lock(_writeMutex);
+	auto guard = _rcu.read();
+	for (Plugin& plugin : _plugins) {
+		// Les plugins différés non activés ne sont pas activés pour l'occasion
+		if (PluginInterface* instance = acquire(plugin)) {
+			stats.emplace_back(plugin.info.name, instance->getCommandStats());
+		}
+	}
+	return stats;
+}
+
+std::string PluginsManager::getCommandStatsReport(bool prometheus) {
+	PluginCommandStats stats = getCommandStats();
+	return prometheus ? toPrometheus(stats) : toJson(stats);
+}
+
+void PluginsManager::resetCommandStats() {
+	std::lock_guard<std::mutex> lock(_writeMutex);
+	auto guard = _rcu.read();
+	for (Plugin& plugin : _plugins) {
+		if (PluginInterface* instance = acquire(plugin)) {
+			instance->resetCommandStats();
+		}
+	}
+}
+
+void VariablesTransaction::set(const std::string& plugin, const std::string& variable, VariantType value) {
+	auto it = _index.find(plugin);
+	if (it == _index.end()) {
+		it = _index.emplace(plugin, _plugins.size()).first;
+		_plugins.push_back({ plugin, {}, {}, nullptr, nullptr, {} });
+	}
+	PluginValues& values = _plugins[it->second];
+	auto [position, added] = values.index.emplace(variable, values.values.size());
+	if (added) {
+		values.values.emplace_back(variable, std::move(value));
+		_size++;
+	} else {
+		values.values[position->second].second = std::move(value);
+	}
+}
+
+size_t PluginsManager::commitVariables(VariablesTransaction& transaction) {
+	std::unique_lock<std::mutex> lock(_commitMutex);
+
+	// Les plugins sont activés hors de la section de lecture
+	for (auto& values : transaction._plugins) {
+		Plugin* plugin = findPlugin(values.plugin);
+		if (!plugin) {
+			throw VariablesTransactionException("plugin '" + values.plugin + "' not found");
+		}
+		if (!activate(*plugin)) {
+			throw VariablesTransactionException("plugin '" + values.plugin + "' is not available");
+		}
+		values.target = plugin;
+	}
+
+	// Les instances ne peuvent pas être détruites avant la fin des notifications
+	auto guard = _rcu.read();
+	bool exclusive = false;
+	for (auto& values : transaction._plugins) {
+		values.instance = acquire(*values.target);
+		if (!values.instance) {
+			throw VariablesTransactionException("plugin '" + values.plugin + "' is not available");
+		}
+		exclusive |= !values.instance->isConcurrentAccess();
+	}
+
+	// Un plugin sans mode concurrent ne peut pas être lu pendant qu'il est modifié. Les lecteurs sont écartés avant
+	// la préparation, qui garde les verrous d'écriture : un lecteur qui recalcule une variable dérivée en a besoin.
+	std::unique_lock<std::shared_mutex> readers(_readMutex, std::defer_lock);
+	if (exclusive) {
+		readers.lock();
+	}
+	// Les verrous d'écriture pris par la préparation des plugins précédents sont rendus si un plugin échoue
+	auto fail = [&](const std::string& reason) {
+		for (auto& values : transaction._plugins) {
+			values.prepared.release();
+		}
+		throw VariablesTransactionException(reason);
+	};
+	for (auto& values : transaction._plugins) {
+		std::string error;
+		if (!values.instance->prepareVariables(values.values, values.prepared, error)) {
+			fail("plugin '" + values.plugin + "': " + error);
+		}
+	}
+
+	_commitSequence.fetch_add(1, std::memory_order_relaxed);
+	std::atomic_thread_fence(std::memory_order_release);
+	for (auto& values : transaction._plugins) {
+		values.instance->applyVariables(values.prepared);
+	}
+	_commitSequence.fetch_add(1, std::memory_order_release);
+	if (exclusive) {
+		readers.unlock();
+	}
+	lock.unlock();
+
+	// Les observateurs voient la transaction entière et peuvent en appliquer une autre
+	size_t changed = 0;
+	for (auto& values : transaction._plugins) {
+		values.instance->notifyVariables(values.prepared);
+		changed += values.prepared.changes().size();
+	}
+	return changed;
+}
+
+bool PluginsManager::addDerivedVariable(const std::string& pluginName, const std::string& varName, const std::string& description,
+	const std::vector<std::string>& inputs, DerivedFunction function)
+{
+	// Pas de rechargement ni de déchargement pendant que les instances sont liées
+	std::lock_guard<std::mutex> lock(_writeMutex);
+	std::lock_guard<std::recursive_mutex> activation(_activationMutex);
+	auto instanceOf = [this](const std::string& name) -> PluginInterface* {
+		Plugin* plugin = findPlugin(name);
+		if (!plugin || !activate(*plugin)) {
+			LOG(Error) << "Plugin '" << name << "' not found.";
+			return nullptr;
+		}
+		return acquire(*plugin);
+	};
+
+	PluginInterface* target = instanceOf(pluginName);
+	if (!target) {
+		return false;
+	}
+	std::vector<VariableSource> sources;
+	sources.reserve(inputs.size());
+	for (const std::string& input : inputs) {
+		const size_t dot = input.find('.');
+		if (dot == std::string::npos) {
+			sources.emplace_back(input);
+			continue;
+		}
+		PluginInterface* owner = instanceOf(input.substr(0, dot));
+		if (!owner) {
+			return false;
+		}
+		sources.emplace_back(*owner, input.substr(dot + 1));
+	}
+	if (!target->addDerivedVariable(varName, description, sources, function)) {
+		return false;
+	}
+	_derived.push_back({ pluginName, varName, description, inputs, std::move(function) });
+	return true;
+}
+
+void PluginsManager::relinkDerived(const Plugin& plugin, PluginInterface& instance) {
+	for (const DerivedDefinition& definition : _derived) {
+		const bool target = definition.plugin == plugin.info.name;
+		bool uses = false;
+		std::string error;
+		std::vector<VariableSource> sources;
+		sources.reserve(definition.inputs.size());
+		for (const std::string& input : definition.inputs) {
+			const size_t dot = input.find('.');
+			if (dot == std::string::npos) {
+				sources.emplace_back(input);
+				continue;
+			}
+			const std::string owner = input.substr(0, dot);
+			if (owner == plugin.info.name) {
+				uses = true;
+				sources.emplace_back(instance, input.substr(dot + 1));
+				continue;
+			}
+			Plugin* other = findPlugin(owner);
+			if (!other || !activate(*other)) {
+				error = "plugin '" + owner + "' is not available";
+				continue;
+			}
+			sources.emplace_back(*acquire(*other), input.substr(dot + 1));
+		}
+		if (!target && !uses) {
+			continue;
+		}
+
+		// La variable d'un plugin rechargé ou réactivé est ajoutée à la nouvelle instance, celle d'un autre plugin
+		// est reliée aux variables de la nouvelle instance ; un plugin inactif la recevra à son activation
+		PluginInterface* owner = &instance;
+		if (!target) {
+			Plugin* other = findPlugin(definition.plugin);
+			owner = other ? acquire(*other) : nullptr;
+			if (!owner) {
+				continue;
+			}
+		}
+		if (error.empty()) {
+			const bool linked = target ? owner->addDerivedVariable(definition.variable, definition.description, sources, definition.function)
+				: owner->redefineVariable(definition.variable, sources, definition.function);
+			if (linked) {
+				continue;
+			}
+			error = "its inputs or its function no longer match";
+		}
+		LOG(Error) << "Derived variable '" << definition.plugin << "." << definition.variable << "' cannot follow the new instance of plugin '"
+			<< plugin.info.name << "' (" << error << "), it keeps its last value";
+	}
+}
+
+namespace {
+	// Ce dont dépendent les noms d'un plugin dans l'index : son instance et ses listes de variables et de commandes
+	constexpr size_t NAMES_STAMP = 4;
+
+	std::array<uint64_t, NAMES_STAMP> namesStamp(Plugin& plugin, const PluginInterface* instance) {
+		return { plugin.id, std::atomic_ref<uint64_t>(plugin.generation).load(std::memory_order_acquire),
+			instance ? instance->getVariableListVersion() : 0, instance ? instance->getCommandListVersion() : 0 };
+	}
+}
+
+bool PluginsManager::namesCurrent(const NamespaceIndex& names) {
+	auto guard = _rcu.read();
+	const std::vector<uint64_t>& stamps = names.stamps();
+	if (stamps.size() != _plugins.size() * NAMES_STAMP) {
+		return false;
+	}
+	for (size_t i = 0; i < _plugins.size(); ++i) {
+		auto stamp = namesStamp(_plugins[i], acquire(_plugins[i]));
+		if (!std::equal(stamp.begin(), stamp.end(), stamps.begin() + i * NAMES_STAMP)) {
+			return false;
+		}
+	}
+	return true;
+}
+
+void PluginsManager::refreshNames() {
+	{
+		auto guard = _namesRcu.read();
+		const NamespaceIndex* names = _names.load(std::memory_order_acquire);
+		if (names && namesCurrent(*names)) {
+			return;
+		}
+	}
+	std::lock_guard<std::mutex> lock(_namesMutex);
+	// Seules les reconstructions, sérialisées, remplacent l'index
+	if (const NamespaceIndex* names = _names.load(std::memory_order_acquire); names && namesCurrent(*names)) {
+		return;
+	}
+
+	auto names = std::make_unique<NamespaceIndex>();
+	{
+		auto guard = _rcu.read();
+		names->stamps().reserve(_plugins.size() * NAMES_STAMP);
+		for (Plugin& plugin : _plugins) {
+			PluginInterface* instance = acquire(plugin);
+			auto stamp = namesStamp(plugin, instance);
+			names->stamps().insert(names->stamps().end(), stamp.begin(), stamp.end());
+			if (!instance) {
+				continue;
+			}
+			instance->forEachVariableName([&](const std::string& name) {
+				names->add(plugin.info.name, name, NameKind::Variable, plugin.id);
+			});
+			instance->forEachCommand([&](const std::string& name) {
+				names->add(plugin.info.name, name, NameKind::Command, plugin.id);
+			});
+		}
+	}
+	names->build();
+
+	const NamespaceIndex* old = _names.exchange(names.release(), std::memory_order_acq_rel);
+	_namesRcu.synchronize();
+	delete old;
+}
+
+ConfigReport PluginsManager::loadConfig(const fs::path& file) {
+	auto start = std::chrono::steady_clock::now();
+	ConfigReport report;
+	std::lock_guard<std::mutex> lock(_writeMutex);
+	std::lock_guard<std::recursive_mutex> activation(_activationMutex);
+	auto guard = _rcu.read();
+
+	auto config = std::make_unique<ConfigFile>();
+	std::string error;
+	if (!config->open(file, error)) {
+		LOG(Error) << "Cannot load configuration " << file << ": " << error;
+		return report;
+	}
+	report.errors = config->getErrors();
+	_configured.clear();
+	for (Plugin& plugin : _plugins) {
+		if (!config->contains(plugin.info.name)) {
+			continue;
+		}
+		// Un plugin différé peut être déchargé puis activé de nouveau : il est configuré à chaque activation
+		if (plugin.lazy) {
+			_configured.emplace(plugin.info.name, true);
+		}
+		if (PluginInterface* instance = acquire(plugin)) {
+			report.applied += config->apply(plugin.info.name, *instance, report.errors);
+			report.plugins++;
+		} else if (plugin.lazy) {
+			report.pending++;
+		}
+	}
+	for (const std::string& name : config->getPlugins()) {
+		if (!findPlugin(name)) {
+			report.errors.push_back(file.string() + ":" + std::to_string(config->getLine(name)) + ": plugin '" + name + "' not loaded");
+		}
+	}
+	if (!_configured.empty()) {
+		_config = std::move(config);
+	} else {
+		_config.reset();
+	}
+
+	for (const std::string& ignored : report.errors) {
+		LOG(Warning) << "Configuration ignored: " << ignored;
+	}
+	report.duration = std::chrono::steady_clock::now() - start;
+	return report;
+}
+
+SnapshotReport PluginsManager::restoreVariables(const fs::path& file) {
+	auto start = std::chrono::steady_clock::now();
+	SnapshotReport report;
+	std::lock_guard<std::mutex> lock(_writeMutex);
+	std::lock_guard<std::recursive_mutex> activation(_activationMutex);
+	auto guard = _rcu.read();
+
+	auto snapshot = std::make_unique<VariablesSnapshot>();
+	std::string error;
+	if (!snapshot->open(file, error)) {
+		LOG(Error) << "Cannot restore variables from " << file << ": " << error;
+		return report;
+	}
+	_snapshotPending.clear();
+	for (Plugin& plugin : _plugins) {
+		if (!snapshot->contains(plugin.info.name)) {
+			continue;
+		}
+		if (PluginInterface* instance = acquire(plugin)) {
+			report.restored += snapshot->restore(plugin.info.name, *instance, report.mismatches);
+			report.plugins++;
+		} else if (plugin.lazy) {
+			_snapshotPending.emplace(plugin.info.name, true);
+		}
+	}
+	for (const std::string& name : snapshot->getPlugins()) {
+		if (!findPlugin(name)) {
+			report.mismatches.push_back(name + ": plugin not loaded");
+		}
+	}
+	report.pending = _snapshotPending.size();
+	if (report.pending) {
+		_snapshot = std::move(snapshot);
+	} else {
+		_snapshot.reset();
+	}
+
+	for (const std::string& mismatch : report.mismatches) {
+		LOG(Warning) << "Variable not restored: " << mismatch;
+	}
+	report.duration = std::chrono::steady_clock::now() - start;
+	return report;
+}
+
+bool PluginsManager::saveVariables(const fs::path& file) {
+	std::lock_guard<std::mutex> lock(_writeMutex);
+	std::lock_guard<std::recursive_mutex> activation(_activationMutex);
+	auto guard = _rcu.read();
+
+	VariablesSnapshotWriter writer;
+	for (Plugin& plugin : _plugins) {
+		if (PluginInterface* instance = acquire(plugin)) {
+			writer.addPlugin(plugin.info.name, *instance);
+		} else if (auto unloaded = _unloadedValues.find(plugin.info.name); unloaded != _unloadedValues.end()) {
+			// Déchargé pour inactivité : ses valeurs ont été conservées au déchargement
+			writer.addPlugin(plugin.info.name, unloaded->second);
+		} else if (_snapshot) {
+			// Plugin différé jamais activé : ses valeurs sont celles de l'instantané restauré
+			_snapshot->copySection(plugin.info.name, writer);
+		}
+	}
+	if (!writer.save(file)) {
+		LOG(Error) << "Cannot save variables to " << file;
+		return false;
+	}
+	LOG(Debug) << "Variables saved to " << file << " (" << writer.size() << " bytes)";
+	return true;
+}
+
+ReloadStats PluginsManager::getReloadStats(const std::string& pluginName) {
+	std::lock_guard<std::mutex> lock(_writeMutex);
+	auto it = _reloadStats.find(pluginName);
+	return it != _reloadStats.end() ? it->second : ReloadStats();
+}
+
+void PluginsManager::openPluginCopy(PluginLoadResult& result, const fs::path& original) const {
+	// dlopen renverrait la bibliothèque déjà chargée pour ce chemin : on ouvre une copie temporaire
+	static std::atomic<size_t> generation{0};
+	fs::path copy = fs::temp_directory_path() / (original.stem().string() + "." + std::to_string(getpid())
+		+ "." + std::to_string(++generation) + ".so");
+	std::error_code ec;
+	fs::copy_file(original, copy, fs::copy_options::overwrite_existing, ec);
+	if (ec) {
+		result.plugin = { nullptr, nullptr, {}, original, PluginHandle::INVALID };
+		result.error = "Cannot copy " + original.string() + ": " + ec.message();
+		return;
+	}
+	result.path = copy;
+	openPlugin(result);
+	fs::remove(copy, ec); // La bibliothèque reste projetée en mémoire après la suppression du fichier
+	result.path = original;
+	result.plugin.path = original;
+}
+
+bool PluginsManager::initInstance(Plugin& plugin) {
+	LifecycleTimings timings;
+	{
+		PhaseTimer timer(timings[LifecyclePhase::SetInstances]);
+		plugin.instance->setInstances(&Logger::getInstance(), &ResourcesManager::getInstance(), &_events);
+	}
+	int status = -1;
+	try {
+		PhaseTimer timer(timings[LifecyclePhase::Init]);
+		status = plugin.instance->init(_argc, _argv);
+	} catch (const std::exception& e) {
+		LOG(Error) << "Exception while initializing plugin '" << plugin.info.name << "': " << e.what();
+	}
+	recordTimings(plugin.info.name, timings, LifecyclePhase::SetInstances, LifecyclePhase::Init);
+	if (status != 0) {
+		LOG(Error) << "Failed to initialize plugin '" << plugin.info.name << "'";
+		return false;
+	}
+	return true;
+}
+
+bool PluginsManager::reload(Plugin& plugin, std::chrono::steady_clock::time_point requested) {
+	using ms = std::chrono::duration<double, std::milli>;
+	auto start = std::chrono::steady_clock::now();
+	ReloadStats& stats = _reloadStats[plugin.info.name];
+
+	std::lock_guard<std::recursive_mutex> activation(_activationMutex);
+	if (!plugin.instance) {
+		LOG(Info) << "Plugin '" << plugin.info.name << "' is not active, the new library will be used on activation.";
+		return true;
+	}
+
+	PluginLoadResult result;
+	openPluginCopy(result, plugin.path);
+	if (!result.error.empty()) {
+		LOG(Error) << result.error;
+		stats.failures++;
+		return false;
+	}
+
+	Plugin& fresh = result.plugin;
+	if (fresh.info.name != plugin.info.name) {
+		LOG(Error) << "Library " << plugin.path.filename() << " now provides plugin '" << fresh.info.name << "' instead of '" << plugin.info.name << "'";
+		releasePlugin(fresh);
+		stats.failures++;
+		return false;
+	}
+	// Le graphe des dépendances est établi au chargement : le changer demande de redémarrer
+	if (fresh.info.dependencies != plugin.info.dependencies) {
+		LOG(Error) << "Plugin '" << plugin.info.name << "' changed its dependencies, restart the program to load it";
+		releasePlugin(fresh);
+		stats.failures++;
+		return false;
+	}
+	recordTimings(fresh.info.name, result.timings, LifecyclePhase::Dlopen, LifecyclePhase::IsCompatible);
+
+	if (!initInstance(fresh)) {
+		LOG(Error) << "Keeping the previous instance of plugin '" << fresh.info.name << "'";
+		releasePlugin(fresh);
+		stats.failures++;
+		return false;
+	}
+
+	// Reprise des valeurs courantes, sauf pour les variables dérivées et celles dont le type a changé
+	PluginInterface* old = plugin.instance;
+	std::vector<std::pair<std::string, VariantType>> carried;
+	for (const auto& name : old->getVariables()) {
+		if (!fresh.instance->isVariable(name) || fresh.instance->isDerivedVariable(name) || old->isDerivedVariable(name)) {
+			continue;
+		}
+		VariantType value = old->getVariable(name);
+		if (value.index() != fresh.instance->getVariable(name).index()) {
+			LOG(Warning) << "Variable '" << name << "' of plugin '" << fresh.info.name << "' changed type, value not carried over";
+			continue;
+		}
+		fresh.instance->setVariable(name, value);
+		carried.emplace_back(name, std::move(value));
+	}
+	// Avant la destruction de l'ancienne instance, qui détacherait les variables dérivées de ses variables
+	relinkDerived(plugin, *fresh.instance);
+	auto prepared = std::chrono::steady_clock::now();
+
+	// Publication : les nouveaux appels voient la nouvelle instance, ceux en cours finissent sur l'ancienne
+	void* oldHandle = plugin.handle;
+	std::atomic_ref<PluginInterface*>(plugin.instance).store(fresh.instance, std::memory_order_release);
+	nextGeneration(plugin);
+	plugin.handle = fresh.handle;
+	auto published = std::chrono::steady_clock::now();
+
+	_rcu.synchronize();
+	auto graceEnd = std::chrono::steady_clock::now();
+
+	// Plus aucun appel n'atteint l'ancienne instance : les modifications qu'elle a reçues depuis la copie sont reportées,
+	// sauf si la nouvelle instance a déjà été modifiée depuis sa publication (sa valeur est la plus récente)
+	size_t forwarded = 0;
+	for (const auto& [name, copied] : carried) {
+		VariantType current = old->getVariable(name);
+		if (current != copied && fresh.instance->getVariable(name) == copied) {
+			fresh.instance->setVariable(name, current);
+			forwarded++;
+		}
+	}
+	if (forwarded) {
+		LOG(Debug) << forwarded << " variables of plugin '" << plugin.info.name << "' modified during the reload, forwarded to the new instance";
+	}
+
+	LifecycleTimings timings;
+	{
+		PhaseTimer timer(timings[LifecyclePhase::Shutdown]);
+		old->shutdown();
+	}
+	recordTimings(plugin.info.name, timings, LifecyclePhase::Shutdown, LifecyclePhase::Shutdown);
+	Plugin retired = { oldHandle, old, plugin.info, plugin.path, PluginHandle::INVALID };
+	releasePlugin(retired);
+
+	// plugin.info reste celui du chargement, lu sans verrou : les informations à jour sont celles de l'instance publiée
+	auto end = std::chrono::steady_clock::now();
+	stats.reloads++;
+	stats.prepare = prepared - start;
+	stats.latency = published - requested;
+	stats.gracePeriod = graceEnd - published;
+	stats.total = end - requested;
+	LOG(Info) << "Plugin '" << plugin.info.name << "' reloaded to version " << to_string(fresh.info.version) << " in " << ms(stats.total).count()
+		<< " ms (published after " << ms(stats.latency).count() << " ms, grace period " << ms(stats.gracePeriod).count() << " ms).";
+	return true;
 }
 
 template<typename T>
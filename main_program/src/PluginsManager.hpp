@@ -20,15 +20,280 @@
 #include <map>
 #include <variant>
 #include <stdexcept>
+#include <exception>
 #include <memory>
+#include <chrono>
+#include <mutex>
+#include <shared_mutex>
+#include <thread>
+#include <atomic>
+#include <latch>
 #include "../../common/src/PluginInterface.hpp"
+#include "../../common/src/Rcu.hpp"
+#include "../../common/src/StringHash.hpp"
+#include "CommandStatsReport.hpp"
+#include "ConfigFile.hpp"
+#include "LifecycleTimings.hpp"
+#include "ManifestCache.hpp"
+#include "NamespaceIndex.hpp"
+#include "ThreadPool.hpp"
+#include "VariablesSnapshot.hpp"
 
 namespace fs = std::filesystem;
 
 struct Plugin {
-	void* handle;
-	PluginInterface* instance;
-	PluginInfo info;
+	void* handle;				///< Bibliothèque de l'instance courante, lue et modifiée seulement sous PluginsManager::_activationMutex
+	PluginInterface* instance;	///< Instance courante, republiée atomiquement lors d'un rechargement à chaud, nulle si le plugin n'est pas activé
+	PluginInfo info;			///< Manifeste au chargement, jamais modifié ensuite ; après un rechargement, instance->getInfo() est à jour
+	fs::path path;				///< Fichier .so d'origine
+	uint32_t id;				///< Identifiant stable du plugin, utilisé par PluginHandle
+	bool lazy = false;			///< Plugin chargé et initialisé au premier accès
+	int64_t lastAccess = 0;		///< Date du dernier accès d'un plugin différé (horloge monotone, en nanosecondes)
+	size_t activations = 0;		///< Nombre d'activations d'un plugin différé
+	uint64_t generation = 0;	///< Incrémenté après chaque publication d'une nouvelle instance (activation, rechargement, déchargement)
+};
+
+/**
+ * @brief Référence stable vers un plugin chargé
+ * Obtenue une fois par son nom avec PluginsManager::getHandle, elle donne ensuite un accès direct au plugin
+ * sans hachage ni comparaison de chaînes. Elle reste valide après un tri ou un rechargement à chaud,
+ * et devient invalide quand le plugin est déchargé.
+ */
+struct PluginHandle {
+	static constexpr uint32_t INVALID = UINT32_MAX;
+
+	uint32_t id = INVALID;
+
+	bool ok() const noexcept { return id != INVALID; }
+	bool operator==(const PluginHandle& other) const noexcept { return id == other.id; }
+};
+
+/**
+ * @brief Mesures du dernier rechargement à chaud d'un plugin
+ * Les appelants ne sont jamais bloqués : pendant un rechargement ils continuent sur l'ancienne instance,
+ * le coût qu'ils subissent se limite à la lecture atomique du pointeur d'instance.
+ * gracePeriod mesure le temps pendant lequel des appels en cours ont retenu l'ancienne instance.
+ */
+struct ReloadStats {
+	size_t reloads = 0;						///< Nombre de rechargements réussis
+	size_t failures = 0;					///< Nombre de rechargements échoués
+	std::chrono::nanoseconds prepare{0};	///< Ouverture, création, init et reprise des variables de la nouvelle instance
+	std::chrono::nanoseconds latency{0};	///< Délai entre la demande (ou l'événement inotify) et la publication
+	std::chrono::nanoseconds gracePeriod{0};///< Attente de la fin des appels en cours sur l'ancienne instance
+	std::chrono::nanoseconds total{0};		///< Durée totale, destruction de l'ancienne instance comprise
+};
+
+/**
+ * @brief Résultat de l'ouverture d'un fichier de plugin
+ * Les threads de travail ne journalisent rien : le message est conservé ici et écrit
+ * par le thread appelant, dans l'ordre des fichiers, pour que les logs restent déterministes.
+ */
+struct PluginLoadResult {
+	fs::path path;							///< Chemin du fichier .so
+	Plugin plugin;							///< Plugin ouvert (handle et instance nuls en cas d'échec)
+	std::string error;						///< Message d'erreur, vide si le plugin a été ouvert
+	std::chrono::nanoseconds duration;		///< Durée de dlopen, dlsym, create et isCompatible
+	LifecycleTimings timings;				///< Détail de ces étapes
+};
+
+/**
+ * @brief Appel de commande d'un lot soumis avec PluginsManager::callCommandsAsync, ou étape d'un CommandBatch
+ */
+struct CommandCall {
+	std::string plugin;					///< Nom du plugin
+	std::string command;				///< Nom de la commande ou alias
+	std::vector<VariantType> args;		///< Arguments passés à la commande
+};
+
+/**
+ * @brief Exception transmise par les appels asynchrones quand le plugin demandé n'existe pas ou n'est pas disponible
+ */
+class PluginNotFoundException : public std::runtime_error {
+public:
+	PluginNotFoundException(const std::string& pluginName)
+		: std::runtime_error("Plugin not found or not available: " + pluginName) {}
+};
+
+/**
+ * @brief Branchement d'une valeur retournée par une étape précédente sur un argument
+ */
+struct StepInput {
+	size_t argument;	///< Position de l'argument à remplir
+	size_t step;		///< Étape qui produit la valeur, nécessairement ajoutée avant
+	size_t result;		///< Position de la valeur dans les résultats de cette étape
+};
+
+class InvalidPipelineException : public std::runtime_error {
+public:
+	InvalidPipelineException(size_t step, const std::string& message)
+		: std::runtime_error("Invalid pipeline step " + std::to_string(step) + ": " + message) {}
+};
+
+/**
+ * @brief Description d'un lot d'appels de commandes, à compiler avec PluginsManager::compilePipeline
+ * Une étape ne peut utiliser que les résultats des étapes ajoutées avant elle : le lot forme toujours
+ * un graphe sans cycle, exécuté dans l'ordre d'ajout.
+ */
+class CommandBatch {
+public:
+	/**
+	 * @brief Ajouter une étape
+	 * @param[in] call Plugin, commande et arguments constants
+	 * @param[in] inputs Arguments remplis par les résultats d'étapes précédentes (ils peuvent dépasser call.args)
+	 * @return Numéro de l'étape, à utiliser dans StepInput::step et CommandPipeline::results
+	 */
+	size_t add(CommandCall call, std::vector<StepInput> inputs = {}) {
+		_steps.push_back({ std::move(call), std::move(inputs) });
+		return _steps.size() - 1;
+	}
+
+	size_t size() const noexcept { return _steps.size(); }
+
+private:
+	friend class PluginsManager;
+
+	struct Step {
+		CommandCall call;
+		std::vector<StepInput> inputs;
+	};
+
+	std::vector<Step> _steps;
+};
+
+class PluginsManager;
+
+/**
+ * @brief Lot d'appels de commandes validé et résolu une fois, exécuté par PluginsManager::runPipeline
+ * Les plugins et les commandes sont recherchés à la compilation ; chaque exécution réutilise les mêmes
+ * vecteurs d'arguments et de résultats. Un pipeline ne doit pas être exécuté par deux threads à la fois.
+ */
+class CommandPipeline {
+public:
+	size_t size() const noexcept { return _steps.size(); }
+
+	/**
+	 * @brief Nombre de niveaux : les étapes d'un même niveau ne dépendent pas les unes des autres
+	 */
+	size_t levels() const noexcept { return _levels.size(); }
+
+	/**
+	 * @brief Valeurs retournées par une étape lors de la dernière exécution
+	 * @param[in] step Numéro de l'étape
+	 * @return Valeurs retournées
+	 */
+	const std::vector<VariantType>& results(size_t step) const { return _steps.at(step).results; }
+
+	/**
+	 * @brief Modifier un argument constant entre deux exécutions (entrée d'une boucle de contrôle par exemple)
+	 * Sans effet sur un argument branché, réécrit à chaque exécution. Le type est vérifié à l'appel de la commande,
+	 * comme pour tout appel : une valeur d'un autre type fait échouer runPipeline avec CommandArgumentTypeException.
+	 * @param[in] step Numéro de l'étape
+	 * @param[in] argument Position de l'argument
+	 * @param[in] value Nouvelle valeur
+	 */
+	void setArgument(size_t step, size_t argument, VariantType value) { _steps.at(step).args.at(argument) = std::move(value); }
+
+private:
+	friend class PluginsManager;
+
+	static constexpr uint64_t UNRESOLVED = UINT64_MAX;
+
+	struct Step {
+		size_t plugin;					///< Position du plugin dans _plugins
+		std::string command;
+		uint64_t generation;			///< Génération de l'instance du plugin pour laquelle handle a été résolu
+		CommandHandle handle;
+		std::vector<VariantType> args;	///< Arguments constants, les arguments branchés sont réécrits à chaque exécution
+		std::vector<StepInput> inputs;
+		std::vector<VariantType> results;
+		std::exception_ptr error;		///< Exception levée pendant une exécution parallèle
+	};
+
+	// Contexte d'une étape confiée à l'exécuteur : la tâche ne capture qu'un pointeur vers lui,
+	// assez petit pour que std::function n'alloue pas
+	struct Job {
+		PluginsManager* manager;
+		CommandPipeline* pipeline;
+		size_t step;
+		std::latch* done;
+	};
+
+	std::vector<Step> _steps;
+	std::vector<std::vector<size_t>> _levels;	///< Étapes de chaque niveau
+	std::vector<PluginHandle> _plugins;			///< Plugins utilisés, sans doublon
+	std::vector<PluginInterface*> _instances;	///< Instances des plugins retenues pendant l'exécution en cours
+	std::vector<uint64_t> _generations;			///< Et leurs générations
+	std::vector<Job> _jobs;						///< Une par étape, réutilisées d'une exécution parallèle à l'autre
+};
+
+/**
+ * @brief Commande d'un plugin résolue une fois par PluginsManager::resolveCommand, appelée sans recherche par nom
+ * Comme une étape de pipeline, la commande n'est recherchée à nouveau dans l'instance que si le plugin a été
+ * rechargé ou déchargé depuis le dernier appel. Ne doit pas être appelée par deux threads à la fois.
+ */
+class ResolvedCommand {
+public:
+	bool ok() const noexcept { return _plugin.ok(); }
+	PluginHandle plugin() const noexcept { return _plugin; }
+	const std::string& command() const noexcept { return _command; }
+
+private:
+	friend class PluginsManager;
+
+	static constexpr uint64_t UNRESOLVED = UINT64_MAX;
+
+	PluginHandle _plugin;
+	std::string _command;
+	uint64_t _generation = UNRESOLVED;	///< Génération de l'instance pour laquelle _handle a été résolu
+	CommandHandle _handle;
+};
+
+class VariablesTransactionException : public std::runtime_error {
+public:
+	VariablesTransactionException(const std::string& message)
+		: std::runtime_error("Variables transaction rejected: " + message) {}
+};
+
+/**
+ * @brief Modifications de variables de plusieurs plugins, appliquées ensemble par PluginsManager::commitVariables
+ * Les modifications sont regroupées par plugin ; une variable modifiée plusieurs fois garde la dernière valeur.
+ * Une transaction peut être appliquée plusieurs fois, en changeant ses valeurs avec set entre deux applications :
+ * elle réutilise alors ses vecteurs. Elle ne doit pas être appliquée par deux threads à la fois.
+ */
+class VariablesTransaction {
+public:
+	/**
+	 * @brief Ajouter une modification
+	 * @param[in] plugin Nom du plugin
+	 * @param[in] variable Nom de la variable
+	 * @param[in] value Nouvelle valeur
+	 */
+	void set(const std::string& plugin, const std::string& variable, VariantType value);
+
+	size_t size() const noexcept { return _size; }
+	bool empty() const noexcept { return _size == 0; }
+
+	void clear() noexcept {
+		_plugins.clear();
+		_index.clear();
+		_size = 0;
+	}
+
+private:
+	friend class PluginsManager;
+
+	struct PluginValues {
+		std::string plugin;
+		std::vector<std::pair<std::string, VariantType>> values;
+		StringMap<size_t> index;		///< Nom de la variable -> position dans values
+		Plugin* target;					///< Plugin trouvé par commitVariables
+		PluginInterface* instance;		///< Instance retenue pendant commitVariables
+		PreparedVariables prepared;		///< Réutilisées d'une validation à l'autre
+	};
+
+	std::vector<PluginValues> _plugins;
+	StringMap<size_t> _index;	///< Nom du plugin -> position dans _plugins
+	size_t _size = 0;
 };
 
 class PluginsManager {
@@ -36,29 +301,512 @@ private:
 	std::string	_pluginsDir;
 	Version		_mainVersion;
 	std::vector<Plugin> _plugins;
+	size_t		_nbThreads;
+
+	// Index des plugins, reconstruits à chaque modification de _plugins
+	StringMap<size_t>	_index;		///< Nom du plugin -> position dans _plugins
+	std::vector<size_t>	_slots;		///< Identifiant du plugin -> position dans _plugins
+	uint32_t			_nextId;
+
+	// Manifestes lus sans dlopen
+	ManifestCache		_manifests;
+	fs::path			_manifestCacheFile;
+	int			_argc;
+	char**		_argv;
+	std::atomic<bool> _initialized;	///< initPlugins a été appelée : les plugins différés peuvent être activés
+
+	// Rechargement à chaud
+	RcuDomain	_rcu;
+	std::mutex	_writeMutex;	///< Sérialise les modifications de _plugins et les rechargements
+	std::thread	_watcher;
+	std::atomic<bool> _watching;
+	std::map<std::string, ReloadStats> _reloadStats;
+
+	// Activation différée
+	bool		_lazyDefault;
+	StringMap<bool> _lazyOverrides;				///< Choix par plugin, prioritaire sur _lazyDefault
+	std::recursive_mutex _activationMutex;		///< Sérialise les activations (récursif : les dépendances sont activées d'abord)
+	StringMap<std::vector<std::pair<std::string, VariantType>>> _unloadedValues;	///< Variables des plugins déchargés pour inactivité, rendues à leur activation (sous _activationMutex)
+
+	// Instantané des variables, conservé tant que des plugins différés n'ont pas été restaurés (protégé par _activationMutex)
+	std::unique_ptr<VariablesSnapshot> _snapshot;
+	StringMap<bool> _snapshotPending;			///< Plugins différés à restaurer à leur activation
+
+	// Fichier de configuration, conservé tant que des plugins différés peuvent être activés (protégé par _activationMutex)
+	std::unique_ptr<ConfigFile> _config;
+	StringMap<bool> _configured;				///< Plugins différés configurés à chacune de leurs activations
+
+	/**
+	 * @brief Variable dérivée ajoutée par addDerivedVariable, redéfinie quand l'un de ses plugins change d'instance
+	 */
+	struct DerivedDefinition {
+		std::string plugin;
+		std::string variable;
+		std::string description;
+		std::vector<std::string> inputs;	///< "Plugin.variable" ou "variable"
+		DerivedFunction function;
+	};
+	std::vector<DerivedDefinition> _derived;	///< Sous _activationMutex
+
+	// Durées du cycle de vie, conservées après le déchargement pour le rapport final
+	std::map<std::string, LifecycleTimings> _timings;
+	mutable std::mutex _timingsMutex;
+
+	EventBus	_events;
+
+	// Transactions de variables : impair pendant qu'une transaction est appliquée (verrou de séquence)
+	std::atomic<uint64_t> _commitSequence{0};
+	std::mutex	_commitMutex;
+	std::shared_mutex _readMutex;	///< Pris par readVariables, et en exclusif par les transactions qui modifient un plugin sans mode concurrent
+
+	// Index des noms "Plugin.variable" et "Plugin.commande", reconstruit à la première recherche après un changement
+	std::atomic<const NamespaceIndex*> _names{nullptr};
+	RcuDomain	_namesRcu;
+	std::mutex	_namesMutex;		///< Sérialise les reconstructions
+
+	// Exécuteur des commandes asynchrones, créé au premier appel
+	std::unique_ptr<ThreadPool> _executor;
+	std::mutex	_executorMutex;
+	size_t		_executorThreads;
+	size_t		_executorCapacity;
+
+	/**
+	 * @brief Graphe des dépendances entre les plugins, indexé comme _plugins
+	 */
+	struct DependencyGraph {
+		std::vector<std::vector<size_t>> dependencies;	///< Plugins dont dépend chaque plugin
+		std::vector<std::vector<size_t>> dependents;	///< Plugins qui dépendent de chaque plugin
+	};
 
 	// Helper functions
+	std::vector<fs::path> findPluginFiles();
+	std::vector<fs::path> filterPluginFiles(const std::vector<fs::path>& files, size_t& deferred);
+	bool isLazy(const std::string& pluginName) const;
+	bool activate(Plugin& plugin);
+	bool initInstance(Plugin& plugin);
+	void openPluginCopy(PluginLoadResult& result, const fs::path& original) const;
+	template<typename F>
+	bool withInstance(Plugin& plugin, F&& function);
+	std::vector<VariantType> callCommandOrThrow(PluginHandle handle, const std::string& commandOrAlias, const std::vector<VariantType>& args);
+	void openPlugin(PluginLoadResult& result) const;
+	bool commitPlugin(PluginLoadResult& result);
+	size_t sortPlugins();
+	size_t resolveDependencies();
+	DependencyGraph buildDependencyGraph() const;
+	bool releasePlugin(Plugin& plugin);
+	void rebuildIndex();
 	bool loadPlugin(const fs::path& path);
+	bool reload(Plugin& plugin, std::chrono::steady_clock::time_point requested);
+	void relinkDerived(const Plugin& plugin, PluginInterface& instance);
+	void watchLoop(int fd);
+	Plugin* findPlugin(const std::string& pluginName);
+	Plugin* findPlugin(PluginHandle handle) noexcept;
+	static PluginInterface* acquire(Plugin& plugin) noexcept;
+	static void nextGeneration(Plugin& plugin) noexcept;
+	void recordTimings(const std::string& pluginName, const LifecycleTimings& timings, LifecyclePhase first, LifecyclePhase last);
+	void runStep(CommandPipeline& pipeline, size_t index);
+	bool namesCurrent(const NamespaceIndex& names);
+	void refreshNames();
 
 public:
 	PluginsManager(const std::string& dir, const Version &mainVersion);
 	~PluginsManager();
 
+	/**
+	 * @brief Activer le cache des manifestes sur disque
+	 * Les manifestes des plugins inchangés (même chemin, taille et date) sont relus depuis ce fichier
+	 * au lieu d'ouvrir leur fichier ELF. Le cache est mis à jour à la fin de chaque chargement.
+	 * @param[in] file Fichier du cache
+	 */
+	void setManifestCache(const fs::path& file);
+
+	/**
+	 * @brief Charger les plugins
+	 * Les plugins qui exportent un manifeste sont filtrés avant dlopen : les plugins incompatibles,
+	 * ou dont une dépendance manque, ne sont jamais chargés.
+	 */
 	void loadPlugins();
 
+	/**
+	 * @brief Activer ou désactiver le chargement différé de tous les plugins
+	 * Un plugin différé n'est ni ouvert ni initialisé au démarrage : il l'est une seule fois, au premier
+	 * setVariable, getVariable ou callCommand qui le concerne, même si plusieurs threads y accèdent en même temps.
+	 * Il reçoit alors les arguments passés à initPlugins ; avant initPlugins, aucun plugin n'est activé.
+	 * Nécessite que tous les plugins exportent un manifeste. Les dépendances des plugins non différés
+	 * sont toujours chargées au démarrage.
+	 * @param[in] enabled true pour différer le chargement des plugins
+	 */
+	void setLazyActivation(bool enabled) { _lazyDefault = enabled; }
+
+	/**
+	 * @brief Choisir le chargement différé pour un plugin, quel que soit le choix global
+	 * @param[in] pluginName Nom du plugin
+	 * @param[in] lazy true pour différer le chargement du plugin
+	 */
+	void setLazy(const std::string& pluginName, bool lazy = true) { _lazyOverrides.insert_or_assign(pluginName, lazy); }
+
+	/**
+	 * @brief Décharger les plugins différés inutilisés depuis un certain temps
+	 * Ils seront à nouveau chargés et initialisés au prochain accès, et retrouveront alors les valeurs de leurs variables.
+	 * @param[in] timeout Durée d'inactivité au-delà de laquelle un plugin est déchargé
+	 * @return Nombre de plugins déchargés
+	 */
+	size_t unloadIdlePlugins(std::chrono::milliseconds timeout);
+
+	/**
+	 * @brief Charger les plugins en parallèle
+	 * dlopen, dlsym, create et isCompatible sont exécutés sur un groupe de threads, puis les plugins
+	 * sont fusionnés dans l'ordre des fichiers et triés une seule fois par priorité.
+	 * Le log final indique le gain mesuré par rapport à la somme des temps de chargement individuels.
+	 * @param[in] nbThreads Nombre de threads, 0 pour utiliser le nombre de coeurs disponibles
+	 */
+	void loadPluginsParallel(size_t nbThreads = 0);
+
+	/**
+	 * @brief Définir le nombre de threads utilisés pour initialiser et arrêter les plugins
+	 * @param[in] nbThreads Nombre de threads, thread appelant compris, 0 pour le nombre de coeurs
+	 */
+	void setConcurrency(size_t nbThreads) { _nbThreads = nbThreads; }
+
+	/**
+	 * @brief Initialiser les plugins
+	 * Un plugin est initialisé dès que toutes ses dépendances le sont, en parallèle des autres plugins prêts.
+	 * Si une dépendance échoue, les plugins qui en dépendent ne sont pas initialisés.
+	 */
 	void initPlugins(int argc, char* argv[]);
 
+	/**
+	 * @brief Arrêter les plugins dans l'ordre topologique inverse
+	 * Un plugin est arrêté dès que tous les plugins qui en dépendent le sont.
+	 */
 	void shutdownPlugins();
-	
+
+	/**
+	 * @brief Décharger tous les plugins
+	 * Les instances sont retirées puis détruites après la fin des appels en cours. Aucun nouvel appel ne doit
+	 * commencer pendant le déchargement : les références aux plugins (Plugin, PluginHandle) deviennent invalides.
+	 */
 	void unloadPlugins();
 
+	/**
+	 * @brief Démarrer la surveillance du répertoire des plugins (inotify)
+	 * Quand un fichier .so déjà chargé est réécrit, seul ce plugin est rechargé.
+	 * @return true si la surveillance a démarré, false sinon
+	 */
+	bool startHotReload();
+
+	/**
+	 * @brief Arrêter la surveillance du répertoire des plugins
+	 */
+	void stopHotReload();
+
+	/**
+	 * @brief Recharger un plugin depuis son fichier .so
+	 * La nouvelle instance est initialisée, reprend les valeurs des variables de l'ancienne puis est publiée
+	 * atomiquement. L'ancienne instance est arrêtée et détruite une fois les appels en cours terminés ; les
+	 * modifications qu'elle a reçues pendant ce temps sont reportées sur la nouvelle. Une bibliothèque qui change
+	 * de nom ou de dépendances est refusée.
+	 * @param[in] pluginName Nom du plugin
+	 * @return true si le plugin a été rechargé, false sinon (l'ancienne instance reste alors en place)
+	 */
+	bool reloadPlugin(const std::string& pluginName);
+
+	/**
+	 * @brief Récupérer les mesures de rechargement d'un plugin
+	 * @param[in] pluginName Nom du plugin
+	 * @return Mesures du plugin, vides s'il n'a jamais été rechargé
+	 */
+	ReloadStats getReloadStats(const std::string& pluginName);
+
+	/**
+	 * @brief Récupérer les durées du cycle de vie d'un plugin
+	 * dlopen, dlsym, create, isCompatible, setInstances, init, shutdown, destroy et dlclose sont mesurés
+	 * avec une horloge monotone. Une étape que le plugin n'a pas encore franchie vaut zéro.
+	 * @param[in] pluginName Nom du plugin
+	 * @return Durées du plugin, nulles s'il n'a jamais été chargé
+	 */
+	LifecycleTimings getTimings(const std::string& pluginName) const;
+
+	/**
+	 * @brief Récupérer les plugins dont le cycle de vie a été le plus long
+	 * @param[in] count Nombre maximal de plugins
+	 * @return Noms et durées des plugins, du plus lent au plus rapide
+	 */
+	std::vector<std::pair<std::string, LifecycleTimings>> getSlowestPlugins(size_t count) const;
+
+	/**
+	 * @brief Générer le rapport JSON des durées du cycle de vie
+	 * Contient la durée totale, le cumul par étape, les plugins les plus lents et le détail de chaque plugin.
+	 * @param[in] slowest Nombre de plugins les plus lents à lister
+	 * @return Rapport JSON
+	 */
+	std::string getTimingsReport(size_t slowest = 5) const;
+
+	/**
+	 * @brief Récupérer les statistiques des commandes des plugins activés (appels, erreurs, histogramme des latences)
+	 * @return Statistiques par plugin, dans l'ordre des plugins ; vides si elles sont désactivées à la compilation
+	 */
+	PluginCommandStats getCommandStats();
+
+	/**
+	 * @brief Générer le rapport des statistiques des commandes
+	 * @param[in] prometheus true pour le format texte de Prometheus, false pour du JSON
+	 * @return Rapport
+	 */
+	std::string getCommandStatsReport(bool prometheus = false);
+
+	/**
+	 * @brief Remettre à zéro les statistiques des commandes de tous les plugins activés
+	 */
+	void resetCommandStats();
+
+	/**
+	 * @brief Appliquer un fichier de configuration aux variables des plugins
+	 * Le fichier est projeté en mémoire et analysé en une passe, puis les valeurs de chaque plugin activé sont
+	 * converties dans le type de ses variables et appliquées d'un seul bloc. Celles des plugins différés sont
+	 * appliquées à chacune de leurs activations, après leur init : le fichier analysé est gardé pour eux.
+	 * Les lignes mal formées, les plugins et les variables inconnus et les valeurs qui ne conviennent pas sont
+	 * signalés dans le rapport avec leur numéro de ligne.
+	 * @param[in] file Fichier de configuration (voir ConfigFile pour le format)
+	 * @return Rapport de l'application
+	 */
+	ConfigReport loadConfig(const fs::path& file);
+
+	/**
+	 * @brief Restaurer les variables des plugins depuis un instantané binaire
+	 * Le fichier est projeté en mémoire et vérifié, puis les valeurs sont appliquées aux plugins activés.
+	 * Celles des plugins différés sont appliquées à leur activation, après leur init.
+	 * Une variable renommée, supprimée ou dont le type a changé garde sa valeur et est signalée dans le rapport.
+	 * @param[in] file Fichier de l'instantané
+	 * @return Rapport de la restauration
+	 */
+	SnapshotReport restoreVariables(const fs::path& file);
+
+	/**
+	 * @brief Enregistrer les variables de tous les plugins dans un instantané binaire
+	 * Les plugins différés qui n'ont pas été activés gardent les valeurs de l'instantané restauré.
+	 * @param[in] file Fichier de l'instantané
+	 * @return true si le fichier a été écrit, false sinon
+	 */
+	bool saveVariables(const fs::path& file);
+
+	/**
+	 * @brief Récupérer une référence stable vers un plugin
+	 * @param[in] pluginName Nom du plugin
+	 * @return Référence du plugin, invalide (ok() == false) si le plugin n'est pas chargé
+	 */
+	PluginHandle getHandle(std::string_view pluginName) const;
+
+	/**
+	 * @brief Accéder à un plugin par sa référence
+	 * @param[in] handle Référence du plugin
+	 * @return Plugin, nullptr si la référence n'est plus valide
+	 */
+	const Plugin* getPlugin(PluginHandle handle) const noexcept;
+
 	void setVariable(const std::string& pluginName, const std::string& varName, const VariantType& value);
 	VariantType getVariable(const std::string& pluginName, const std::string& varName);
 
+	void setVariable(PluginHandle handle, const std::string& varName, const VariantType& value);
+	VariantType getVariable(PluginHandle handle, const std::string& varName);
+
+	/**
+	 * @brief Appeler une commande d'un plugin
+	 * @param[in] pluginName Nom du plugin
+	 * @param[in] commandOrAlias Nom de la commande ou alias
+	 * @param[in] args Liste des arguments passés à la commande
+	 * @return Liste des valeurs retournées par la commande
+	 */
+	std::vector<VariantType> callCommand(const std::string& pluginName, const std::string& commandOrAlias, const std::vector<VariantType>& args);
+	std::vector<VariantType> callCommand(PluginHandle handle, const std::string& commandOrAlias, const std::vector<VariantType>& args);
+
+	/**
+	 * @brief Récupérer le bus d'événements partagé avec les plugins
+	 * Les abonnements d'un plugin sont supprimés avant sa destruction (déchargement, rechargement à chaud).
+	 * @return Bus d'événements
+	 */
+	EventBus& getEventBus() noexcept { return _events; }
+
+	/**
+	 * @brief Configurer l'exécuteur des commandes asynchrones, avant son premier usage
+	 * @param[in] nbThreads Nombre de threads de travail, 0 pour le nombre de coeurs
+	 * @param[in] capacity Nombre maximal d'appels en attente : au-delà, les appelants attendent qu'une place se libère
+	 */
+	void setExecutorOptions(size_t nbThreads, size_t capacity) { _executorThreads = nbThreads; _executorCapacity = capacity; }
+
+	/**
+	 * @brief Récupérer l'exécuteur partagé des commandes asynchrones
+	 * Peut être passé à CommandsListener::callCommandAsync pour appeler directement l'instance d'un plugin.
+	 * @return Exécuteur du programme principal
+	 */
+	CommandExecutor& getExecutor();
+
+	/**
+	 * @brief Appeler une commande d'un plugin sur l'exécuteur partagé, sans attendre son résultat
+	 * @param[in] pluginName Nom du plugin
+	 * @param[in] commandOrAlias Nom de la commande ou alias
+	 * @param[in] args Liste des arguments passés à la commande
+	 * @param[in] token Jeton d'annulation optionnel
+	 * @return Future des valeurs retournées par la commande, ou de l'exception qu'elle a levée
+	 */
+	std::future<std::vector<VariantType>> callCommandAsync(const std::string& pluginName, const std::string& commandOrAlias,
+		std::vector<VariantType> args, std::optional<CancellationToken> token = std::nullopt);
+	std::future<std::vector<VariantType>> callCommandAsync(PluginHandle handle, const std::string& commandOrAlias,
+		std::vector<VariantType> args, std::optional<CancellationToken> token = std::nullopt);
+
+	/**
+	 * @brief Appeler plusieurs commandes sur l'exécuteur partagé en une seule mise en file
+	 * Les plugins sont résolus une fois, au moment de la soumission.
+	 * @param[in] calls Appels à effectuer
+	 * @param[in] token Jeton d'annulation optionnel, commun à tout le lot
+	 * @return Futures des appels, dans l'ordre de calls
+	 */
+	std::vector<std::future<std::vector<VariantType>>> callCommandsAsync(std::vector<CommandCall> calls,
+		std::optional<CancellationToken> token = std::nullopt);
+
+	/**
+	 * @brief Attendre la fin de toutes les commandes asynchrones soumises
+	 * Appelé automatiquement avant l'arrêt et le déchargement des plugins.
+	 */
+	void waitAsyncCommands();
+
+	/**
+	 * @brief Valider et résoudre un lot d'appels de commandes
+	 * Les plugins (activés si besoin) et les commandes sont recherchés une seule fois. Sont vérifiés :
+	 * le nombre d'arguments, les branchements (étape précédente, résultat existant) et, pour les commandes
+	 * typées, les types des arguments constants et des résultats branchés.
+	 * @param[in] batch Description du lot
+	 * @return Pipeline prêt à être exécuté
+	 * @throw InvalidPipelineException si une étape est invalide
+	 */
+	CommandPipeline compilePipeline(const CommandBatch& batch);
+
+	/**
+	 * @brief Exécuter un pipeline
+	 * Les plugins du pipeline ne peuvent pas être détruits pendant l'exécution (un rechargement à chaud attend la fin).
+	 * En parallèle, les étapes d'un même niveau sont réparties sur l'exécuteur partagé et le thread appelant ;
+	 * ne pas l'utiliser depuis une commande asynchrone.
+	 * @param[in] pipeline Pipeline compilé par compilePipeline, résultats disponibles avec CommandPipeline::results
+	 * @param[in] parallel true pour exécuter en parallèle les étapes indépendantes
+	 * @throw L'exception de la première étape en échec ; les étapes suivantes ne sont pas exécutées
+	 */
+	void runPipeline(CommandPipeline& pipeline, bool parallel = false);
+
+	/**
+	 * @brief Vérifier une commande et ses arguments une fois, pour l'appeler ensuite sans recherche
+	 * Le plugin est activé si besoin. Sont vérifiés le nombre d'arguments et, pour une commande typée, leurs types.
+	 * @param[in] plugin Plugin de la commande
+	 * @param[in] commandOrAlias Nom de la commande ou alias
+	 * @param[in] args Arguments qui seront passés à chaque appel
+	 * @return Commande résolue
+	 * @throw PluginNotFoundException, CommandNotFoundException, InvalidArgumentsException ou CommandArgumentTypeException
+	 */
+	ResolvedCommand resolveCommand(PluginHandle plugin, const std::string& commandOrAlias, std::span<const VariantType> args);
+
+	/**
+	 * @brief Appeler une commande résolue par resolveCommand, sans recherche par nom ni allocation
+	 * @param[in,out] command Commande résolue, mise à jour si le plugin a été rechargé
+	 * @param[in] args Arguments passés à la commande
+	 * @param[out] results Valeurs retournées par la commande
+	 * @throw PluginNotFoundException si le plugin n'est plus disponible, ou l'exception de la commande
+	 */
+	void callCommand(ResolvedCommand& command, std::span<const VariantType> args, std::vector<VariantType>& results);
+
+	/**
+	 * @brief Appliquer ensemble des modifications de variables de plusieurs plugins
+	 * Les plugins (activés si besoin) et les variables sont recherchés une seule fois, les valeurs converties dans
+	 * le type des variables, puis chaque plugin peut refuser ses modifications (VariablesListener::validateVariables).
+	 * Si tout est accepté, toutes les modifications sont appliquées, sans qu'un lecteur de readVariables ne puisse
+	 * voir un état intermédiaire. Ensuite seulement, les observateurs sont prévenus et chaque plugin reçoit une seule
+	 * notification groupée (VariablesListener::variablesCommitted).
+	 * @param[in,out] transaction Modifications à appliquer
+	 * @return Nombre de variables dont la valeur a changé
+	 * @throw VariablesTransactionException si un plugin ou une variable n'existe pas, si une valeur n'a pas le bon
+	 * type ou si un plugin refuse : aucune variable n'est alors modifiée
+	 */
+	size_t commitVariables(VariablesTransaction& transaction);
+
+	/**
+	 * @brief Ajouter à un plugin une variable calculée à partir de variables de plusieurs plugins
+	 * Les plugins sont activés si besoin. Un plugin différé dont les variables sont utilisées n'est plus déchargé
+	 * pour inactivité. Quand un plugin d'entrée est rechargé, ou le plugin de la variable rechargé ou réactivé,
+	 * la variable est redéfinie sur la nouvelle instance ; si c'est impossible (entrée supprimée ou de type changé),
+	 * une erreur est signalée et la variable garde sa dernière valeur.
+	 * @param[in] pluginName Plugin auquel ajouter la variable
+	 * @param[in] varName Nom de la variable
+	 * @param[in] description Description de la variable
+	 * @param[in] inputs Entrées, "Plugin.variable" ou "variable" pour une variable du même plugin
+	 * @param[in] function Fonction qui calcule la valeur (voir VariablesListener::addDerivedVariable)
+	 * @return true si la variable a été ajoutée
+	 */
+	bool addDerivedVariable(const std::string& pluginName, const std::string& varName, const std::string& description,
+		const std::vector<std::string>& inputs, DerivedFunction function);
+
+	/**
+	 * @brief Lire des variables sans voir de transaction à moitié appliquée
+	 * La fonction est appelée à nouveau si une transaction a été appliquée pendant son exécution : elle ne doit
+	 * faire que des lectures. Les plugins en mode concurrent (VariablesListener::enableConcurrentAccess) sont lus
+	 * sans attendre ; une transaction qui modifie un plugin sans ce mode attend la fin des lectures en cours et
+	 * bloque les suivantes pendant son application. setVariable hors transaction n'est pas concerné.
+	 * @param[in] function Fonction qui lit les variables (avec getVariable par exemple)
+	 * @return Valeur retournée par la fonction lors de l'exécution qui n'a croisé aucune transaction
+	 */
+	template<typename F>
+	auto readVariables(F&& function) {
+		std::shared_lock<std::shared_mutex> lock(_readMutex);
+		while (true) {
+			uint64_t sequence = _commitSequence.load(std::memory_order_acquire);
+			if (sequence & 1) {
+				std::this_thread::yield();
+				continue;
+			}
+			auto result = function();
+			std::atomic_thread_fence(std::memory_order_acquire);
+			if (_commitSequence.load(std::memory_order_relaxed) == sequence) {
+				return result;
+			}
+		}
+	}
+
+	/**
+	 * @brief Parcourir les variables et commandes dont le nom complet ("Plugin.membre") commence par un préfixe
+	 * Les noms viennent d'un index en arbre radix, reconstruit seulement quand un plugin est activé, rechargé ou
+	 * déchargé, ou quand ses listes de variables ou de commandes changent. Les plugins différés pas encore activés
+	 * n'y figurent pas. Aucune copie : le visiteur reçoit des vues valides pendant son appel.
+	 * Le visiteur ne doit pas appeler forEachName ni findNames.
+	 * @param[in] prefix Préfixe, par exemple "Plugin1." ; vide pour tous les noms
+	 * @param[in] visitor Fonction appelée avec chaque NameEntry, dans l'ordre lexicographique
+	 * @param[in] kinds Variables, commandes ou les deux
+	 * @return Nombre de noms parcourus
+	 */
+	template<typename F>
+	size_t forEachName(std::string_view prefix, F&& visitor, NameKind kinds = NameKind::All) {
+		refreshNames();
+		auto guard = _namesRcu.read();
+		return _names.load(std::memory_order_acquire)->forEachPrefix(prefix, kinds, visitor);
+	}
+
+	/**
+	 * @brief Parcourir les variables et commandes dont le nom complet correspond à un motif
+	 * Comme forEachName, avec `*` pour une suite de caractères quelconque et `?` pour un caractère,
+	 * par exemple "Plugin*.level" ou "*.say".
+	 * @param[in] pattern Motif, de NamespaceIndex::MAX_PATTERN caractères au plus
+	 * @param[in] visitor Fonction appelée avec chaque NameEntry, dans l'ordre lexicographique
+	 * @param[in] kinds Variables, commandes ou les deux
+	 * @return Nombre de noms parcourus
+	 * @throw std::invalid_argument si le motif est trop long
+	 */
+	template<typename F>
+	size_t findNames(std::string_view pattern, F&& visitor, NameKind kinds = NameKind::All) {
+		refreshNames();
+		auto guard = _namesRcu.read();
+		return _names.load(std::memory_order_acquire)->forEachMatch(pattern, kinds, visitor);
+	}
+
 	template<typename T>
 	T getValue(const std::string& pluginName, const std::string& varName);
 
-	// Iterator support to iterate over loaded plugins
+	// Iterator support to iterate over loaded plugins (ne pas utiliser pendant un rechargement à chaud)
 	auto begin() { return _plugins.begin(); }
 	auto end() { return _plugins.end(); }
 };
@@ -0,0 +1,341 @@
+#include <cctype>
+#include <charconv>
+#include <cstring>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "ScriptRunner.hpp"
+#include "../../common/src/Logger.hpp"
+
+namespace {
+	bool isSpace(char c) {
+		return c == ' ' || c == '\t' || c == '\r' || c == '\v' || c == '\f';
+	}
+
+	/**
+	 * @brief Extraire le mot suivant d'une ligne, sans copie
+	 * @param[in,out] rest Reste de la ligne, avancé après le mot
+	 * @param[out] token Mot extrait, guillemets compris pour une chaîne
+	 * @return false à la fin de la ligne ou au début d'un commentaire
+	 */
+	bool nextToken(std::string_view& rest, std::string_view& token) {
+		size_t start = 0;
+		while (start < rest.size() && isSpace(rest[start])) {
+			++start;
+		}
+		if (start == rest.size() || rest[start] == '#') {
+			rest = {};
+			return false;
+		}
+		size_t end = start;
+		if (rest[start] == '"') {
+			for (++end; end < rest.size() && rest[end] != '"'; ++end) {
+				if (rest[end] == '\\') {
+					++end;
+				}
+			}
+			if (end >= rest.size()) {
+				throw std::runtime_error("unterminated string");
+			}
+			++end;
+		} else {
+			while (end < rest.size() && !isSpace(rest[end])) {
+				++end;
+			}
+		}
+		token = rest.substr(start, end - start);
+		rest.remove_prefix(end);
+		return true;
+	}
+
+	std::string unquote(std::string_view token) {
+		if (token.size() < 2 || token.front() != '"') {
+			return std::string(token);
+		}
+		std::string value;
+		value.reserve(token.size() - 2);
+		for (size_t i = 1; i + 1 < token.size(); ++i) {
+			if (token[i] == '\\' && i + 2 < token.size()) {
+				++i;
+			}
+			value.push_back(token[i]);
+		}
+		return value;
+	}
+
+	template<typename T>
+	void appendNumber(std::string& buffer, T value) {
+		char digits[32];
+		auto [end, ec] = std::to_chars(digits, digits + sizeof(digits), value);
+		buffer.append(digits, end);
+	}
+}
+
+ScriptRunner::ScriptRunner(PluginsManager& manager, std::ostream& output) : _manager(manager), _output(output) {
+	_buffer.reserve(OUTPUT_BUFFER);
+}
+
+ScriptRunner::~ScriptRunner() {
+	flush();
+}
+
+VariantType ScriptRunner::parseLiteral(std::string_view token) {
+	if (token.empty()) {
+		return std::string();
+	}
+	if (token.front() == '"') {
+		return unquote(token);
+	}
+	if (token == "true" || token == "false") {
+		return token == "true";
+	}
+
+	// Un nombre commence par un chiffre, un signe ou un point suivi d'un chiffre
+	size_t first = (token.front() == '-' || token.front() == '+') ? 1 : 0;
+	if (first < token.size() && (std::isdigit(static_cast<unsigned char>(token[first]))
+		|| (token[first] == '.' && first + 1 < token.size() && std::isdigit(static_cast<unsigned char>(token[first + 1])))))
+	{
+		// from_chars n'accepte pas le signe '+'
+		const char* begin = token.data() + (token.front() == '+' ? 1 : 0);
+		const char* end = token.data() + token.size();
+		int64_t integer;
+		auto [intEnd, intError] = std::from_chars(begin, end, integer);
+		if (intError == std::errc() && intEnd == end) {
+			if (integer >= INT32_MIN && integer <= INT32_MAX) {
+				return static_cast<int32_t>(integer);
+			}
+			return integer;
+		}
+		double real;
+		auto [realEnd, realError] = std::from_chars(begin, end, real);
+		if (realError == std::errc() && realEnd == end) {
+			return real;
+		}
+	}
+	return std::string(token);
+}
+
+ScriptRunner::Line ScriptRunner::resolve(std::string_view text) {
+	Line line;
+	try {
+		std::string_view rest = text;
+		std::string_view target;
+		if (!nextToken(rest, target)) {
+			return line;
+		}
+		size_t dot = target.find('.');
+		if (dot == std::string_view::npos || dot == 0 || dot + 1 == target.size()) {
+			throw std::runtime_error("expected 'Plugin.command' or 'Plugin.variable', got '" + std::string(target) + "'");
+		}
+		std::string_view pluginName = target.substr(0, dot);
+		line.name = std::string(target.substr(dot + 1));
+		line.plugin = _manager.getHandle(pluginName);
+		if (!line.plugin.ok()) {
+			throw std::runtime_error("plugin '" + std::string(pluginName) + "' not found");
+		}
+
+		std::vector<std::string_view> tokens;
+		for (std::string_view token; nextToken(rest, token);) {
+			tokens.push_back(token);
+		}
+
+		if (!tokens.empty() && tokens[0] == "=") {
+			if (tokens.size() != 2) {
+				throw std::runtime_error("expected one value after '='");
+			}
+			// Lève VariableNotFoundException si la variable n'existe pas
+			VariantType current = _manager.getVariable(line.plugin, line.name);
+			line.value = parseLiteral(tokens[1]);
+			if (std::holds_alternative<std::string>(current) && !std::holds_alternative<std::string>(line.value)) {
+				line.value = unquote(tokens[1]);	// Une variable texte reste du texte
+			}
+			line.kind = LineKind::SetVariable;
+			return line;
+		}
+
+		if (tokens.empty()) {
+			try {
+				_manager.getVariable(line.plugin, line.name);
+				line.kind = LineKind::GetVariable;
+				return line;
+			} catch (const VariableNotFoundException&) {
+				// Pas une variable : c'est une commande sans argument
+			}
+		}
+
+		line.args.reserve(tokens.size());
+		for (std::string_view token : tokens) {
+			line.args.push_back(parseLiteral(token));
+		}
+		line.command = _manager.resolveCommand(line.plugin, line.name, line.args);
+		line.kind = LineKind::Call;
+	} catch (const std::exception& e) {
+		line.kind = LineKind::Invalid;
+		line.error = e.what();
+	}
+	return line;
+}
+
+void ScriptRunner::execute(Line& line, std::string_view source, size_t number) {
+	try {
+		switch (line.kind) {
+			case LineKind::Empty:
+				break;
+			case LineKind::Invalid:
+				error(source, number, line.error);
+				break;
+			case LineKind::Call: {
+				_manager.callCommand(line.command, line.args, line.results);
+				const std::vector<VariantType>& results = line.results;
+				for (size_t i = 0; i < results.size(); ++i) {
+					if (i) {
+						_buffer.push_back(' ');
+					}
+					write(results[i]);
+				}
+				if (!results.empty()) {
+					_buffer.push_back('\n');
+				}
+				++_stats.commands;
+				break;
+			}
+			case LineKind::SetVariable:
+				_manager.setVariable(line.plugin, line.name, line.value);
+				++_stats.variables;
+				break;
+			case LineKind::GetVariable:
+				write(_manager.getVariable(line.plugin, line.name));
+				_buffer.push_back('\n');
+				++_stats.variables;
+				break;
+		}
+	} catch (const std::exception& e) {
+		error(source, number, e.what());
+	}
+	if (_buffer.size() >= OUTPUT_BUFFER) {
+		flush();
+	}
+}
+
+void ScriptRunner::runLine(std::string_view text, std::string_view source, size_t number) {
+	++_stats.lines;
+	if (!text.empty() && text.back() == '\r') {
+		text.remove_suffix(1);
+	}
+	// Lignes vides et commentaires : ni analysées ni mémorisées
+	size_t start = 0;
+	while (start < text.size() && isSpace(text[start])) {
+		++start;
+	}
+	if (start == text.size() || text[start] == '#') {
+		return;
+	}
+
+	auto it = _lines.find(text);
+	if (it != _lines.end()) {
+		execute(it->second, source, number);
+		return;
+	}
+	++_stats.resolved;
+	if (_lines.size() < MAX_CACHED_LINES) {
+		it = _lines.emplace(std::string(text), resolve(text)).first;
+		execute(it->second, source, number);
+	} else {
+		Line line = resolve(text);
+		execute(line, source, number);
+	}
+}
+
+void ScriptRunner::runBuffer(std::string_view script, std::string_view source) {
+	size_t number = 0;
+	while (!script.empty()) {
+		const char* newline = static_cast<const char*>(std::memchr(script.data(), '\n', script.size()));
+		size_t length = newline ? static_cast<size_t>(newline - script.data()) : script.size();
+		runLine(script.substr(0, length), source, ++number);
+		script.remove_prefix(newline ? length + 1 : length);
+	}
+	flush();
+}
+
+bool ScriptRunner::runFile(const fs::path& file) {
+	int fd = open(file.c_str(), O_RDONLY | O_CLOEXEC);
+	if (fd < 0) {
+		LOG(Error) << "Cannot open script " << file << ": " << strerror(errno);
+		return false;
+	}
+	struct stat st;
+	if (fstat(fd, &st) != 0) {
+		LOG(Error) << "Cannot read script " << file << ": " << strerror(errno);
+		close(fd);
+		return false;
+	}
+	const size_t size = static_cast<size_t>(st.st_size);
+	if (size == 0) {
+		close(fd);
+		return true;
+	}
+	void* map = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+	close(fd);
+	if (map == MAP_FAILED) {
+		LOG(Error) << "Cannot map script " << file << ": " << strerror(errno);
+		return false;
+	}
+	madvise(map, size, MADV_SEQUENTIAL);
+
+	// Les clés du cache sont des copies : il reste utilisable après la fin de la projection
+	runBuffer(std::string_view(static_cast<const char*>(map), size), file.native());
+	munmap(map, size);
+	return true;
+}
+
+void ScriptRunner::runStream(std::istream& input, bool interactive) {
+	std::string line;
+	size_t number = 0;
+	while (true) {
+		if (interactive) {
+			_output << "> " << std::flush;
+		}
+		if (!std::getline(input, line)) {
+			break;
+		}
+		runLine(line, "<stdin>", ++number);
+		if (interactive) {
+			flush();
+		}
+	}
+	if (interactive) {
+		_output << std::endl;
+	}
+	flush();
+}
+
+void ScriptRunner::flush() {
+	if (!_buffer.empty()) {
+		_output.write(_buffer.data(), static_cast<std::streamsize>(_buffer.size()));
+		_buffer.clear();
+	}
+	_output.flush();
+}
+
+void ScriptRunner::error(std::string_view source, size_t number, const std::string& message) {
+	++_stats.errors;
+	// Les résultats des lignes précédentes sont écrits avant le message d'erreur
+	flush();
+	LOG(Error) << source << ":" << number << ": " << message;
+}
+
+void ScriptRunner::write(const VariantType& value) {
+	std::visit([this](const auto& v) {
+		using T = std::decay_t<decltype(v)>;
+		if constexpr (std::is_same_v<T, std::string>) {
+			_buffer += v;
+		} else if constexpr (std::is_same_v<T, bool>) {
+			_buffer += v ? "true" : "false";
+		} else if constexpr (std::is_arithmetic_v<T>) {
+			appendNumber(_buffer, v);
+		} else {
+			_buffer += VariantToString(v);
+		}
+	}, value);
+}
@@ -0,0 +1,130 @@
+/**
+ * @file ScriptRunner.hpp
+ * @author ClemtoClem
+ * @date 17/10/2026
+ */
+
+#ifndef SCRIPT_RUNNER_HPP
+#define SCRIPT_RUNNER_HPP
+
+#include <filesystem>
+#include <iostream>
+#include <string>
+#include <string_view>
+#include "../../common/src/StringHash.hpp"
+#include "PluginsManager.hpp"
+
+namespace fs = std::filesystem;
+
+/**
+ * @brief Compteurs d'exécution d'un script
+ */
+struct ScriptStats {
+	size_t lines = 0;		///< Lignes lues, vides et commentaires compris
+	size_t commands = 0;	///< Commandes appelées
+	size_t variables = 0;	///< Variables lues ou modifiées
+	size_t errors = 0;		///< Lignes en erreur
+	size_t resolved = 0;	///< Lignes distinctes résolues (plugin, commande, arguments)
+};
+
+/**
+ * @brief Exécution de scripts de commandes et de variables, depuis un fichier ou l'entrée standard
+ *
+ * Une ligne par instruction, les mots séparés par des espaces, `#` commence un commentaire :
+ * - `Plugin.commande arg1 arg2` appelle la commande et écrit ses résultats ;
+ * - `Plugin.variable = valeur` modifie la variable ;
+ * - `Plugin.variable` écrit la valeur de la variable (une variable est prioritaire sur une commande du même nom).
+ *
+ * Les arguments sont des booléens (`true`, `false`), des entiers (int32_t, ou int64_t s'ils ne tiennent pas),
+ * des réels (double), des chaînes entre guillemets (`\"` et `\\` échappés) ou des mots, pris comme chaînes.
+ *
+ * Le fichier est projeté en mémoire et découpé sans copie. Chaque ligne distincte n'est analysée et résolue
+ * qu'une fois (plugin, commande, arguments convertis) : les suivantes appellent directement la commande
+ * résolue (PluginsManager::resolveCommand), sans recherche par nom. Une ligne en erreur est signalée avec son numéro et n'interrompt pas le script.
+ */
+class ScriptRunner {
+public:
+	static constexpr size_t MAX_CACHED_LINES = 65536;	///< Au-delà, les nouvelles lignes sont résolues à chaque exécution
+	static constexpr size_t OUTPUT_BUFFER = 64 * 1024;	///< Taille au-delà de laquelle la sortie est écrite
+
+	/**
+	 * @brief Constructeur de ScriptRunner
+	 * @param[in] manager Gestionnaire dont les plugins sont initialisés
+	 * @param[in] output Flux où sont écrits les résultats et les valeurs lues
+	 */
+	ScriptRunner(PluginsManager& manager, std::ostream& output);
+	~ScriptRunner();
+
+	/**
+	 * @brief Exécuter un fichier de script
+	 * @param[in] file Fichier du script
+	 * @return true si le fichier a été lu, false s'il ne peut pas être ouvert
+	 */
+	bool runFile(const fs::path& file);
+
+	/**
+	 * @brief Exécuter les lignes lues sur un flux jusqu'à sa fin
+	 * @param[in] input Flux d'entrée
+	 * @param[in] interactive Afficher une invite et écrire les résultats après chaque ligne
+	 */
+	void runStream(std::istream& input, bool interactive = false);
+
+	/**
+	 * @brief Exécuter un script déjà en mémoire
+	 * @param[in] script Texte du script, qui doit rester valide pendant l'exécution
+	 * @param[in] source Nom du script dans les messages d'erreur
+	 */
+	void runBuffer(std::string_view script, std::string_view source = "<buffer>");
+
+	/**
+	 * @brief Exécuter une seule ligne
+	 * @param[in] line Ligne, sans retour à la ligne
+	 * @param[in] source Nom du script dans les messages d'erreur
+	 * @param[in] number Numéro de la ligne dans les messages d'erreur
+	 */
+	void runLine(std::string_view line, std::string_view source, size_t number);
+
+	/**
+	 * @brief Écrire les résultats en attente sur le flux de sortie
+	 */
+	void flush();
+
+	const ScriptStats& getStats() const noexcept { return _stats; }
+
+	/**
+	 * @brief Convertir un mot du script en valeur
+	 * @param[in] token Mot, guillemets compris pour une chaîne
+	 * @return Valeur du mot
+	 */
+	static VariantType parseLiteral(std::string_view token);
+
+private:
+	enum class LineKind { Empty, Call, SetVariable, GetVariable, Invalid };
+
+	/**
+	 * @brief Ligne analysée et résolue, réutilisée à chaque nouvelle exécution
+	 */
+	struct Line {
+		LineKind kind = LineKind::Empty;
+		PluginHandle plugin;
+		std::string name;						///< Variable modifiée ou lue
+		VariantType value;						///< Valeur affectée
+		ResolvedCommand command;				///< Commande appelée
+		std::vector<VariantType> args;			///< Arguments convertis
+		std::vector<VariantType> results;		///< Réutilisé d'un appel à l'autre
+		std::string error;						///< Erreur d'analyse ou de résolution
+	};
+
+	PluginsManager& _manager;
+	std::ostream& _output;
+	std::string _buffer;		///< Sortie en attente
+	StringMap<Line> _lines;		///< Texte de la ligne -> ligne résolue
+	ScriptStats _stats;
+
+	Line resolve(std::string_view line);
+	void execute(Line& line, std::string_view source, size_t number);
+	void error(std::string_view source, size_t number, const std::string& message);
+	void write(const VariantType& value);
+};
+
+#endif // SCRIPT_RUNNER_HPP
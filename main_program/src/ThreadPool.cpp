@@ -0,0 +1,185 @@
+#include <algorithm>
+#include "../../common/src/Logger.hpp"
+#include "ThreadPool.hpp"
+
+namespace {
+	thread_local const ThreadPool* t_pool = nullptr;	///< Groupe auquel appartient le thread courant
+	thread_local size_t t_index = 0;					///< Index de la file du thread courant dans ce groupe
+}
+
+ThreadPool::ThreadPool(size_t nbThreads, size_t capacity)
+	: _queued(0), _reserved(0), _pending(0), _nextQueue(0), _stop(false), _capacity(capacity), _waitingForSpace(0) {
+	if (nbThreads == 0) {
+		nbThreads = std::max(1u, std::thread::hardware_concurrency());
+	}
+	for (size_t i = 0; i < nbThreads; ++i) {
+		_queues.push_back(std::make_unique<Queue>());
+	}
+	// La dernière file est réservée au thread qui appelle wait()
+	for (size_t i = 0; i + 1 < nbThreads; ++i) {
+		_threads.emplace_back(&ThreadPool::workerLoop, this, i);
+	}
+}
+
+ThreadPool::~ThreadPool() {
+	wait();
+	{
+		std::lock_guard<std::mutex> lock(_sleepMutex);
+		_stop = true;
+	}
+	_sleepCv.notify_all();
+	for (auto& thread : _threads) {
+		thread.join();
+	}
+}
+
+size_t ThreadPool::currentQueue() const noexcept {
+	return t_pool == this ? t_index : _queues.size() - 1;
+}
+
+bool ThreadPool::reserve(size_t count) noexcept {
+	// Vérification et réservation en une seule opération : deux producteurs ne peuvent pas prendre la même place.
+	// Un lot plus grand que la capacité passe quand les files sont vides.
+	size_t reserved = _reserved.load();
+	while (reserved == 0 || reserved + count <= _capacity) {
+		if (_reserved.compare_exchange_weak(reserved, reserved + count)) {
+			return true;
+		}
+	}
+	return false;
+}
+
+void ThreadPool::waitForSpace(size_t count) {
+	// Sans thread de travail, seul wait() vide les files : attendre bloquerait pour toujours
+	if (_capacity == 0 || t_pool == this || _threads.empty()) {
+		_reserved.fetch_add(count);
+		return;
+	}
+	if (reserve(count)) {
+		return;
+	}
+	std::unique_lock<std::mutex> lock(_sleepMutex);
+	_waitingForSpace.fetch_add(1);
+	_spaceCv.wait(lock, [&]() { return reserve(count); });
+	_waitingForSpace.fetch_sub(1);
+}
+
+void ThreadPool::push(size_t index, Task* tasks, size_t count) {
+	_pending.fetch_add(count);
+	{
+		std::lock_guard<std::mutex> lock(_queues[index]->mutex);
+		for (size_t i = 0; i < count; ++i) {
+			_queues[index]->tasks.push_back(std::move(tasks[i]));
+		}
+	}
+	_queued.fetch_add(count);
+	{
+		std::lock_guard<std::mutex> lock(_sleepMutex);
+	}
+	if (count == 1) {
+		_sleepCv.notify_one();
+	} else {
+		_sleepCv.notify_all();
+	}
+}
+
+void ThreadPool::submit(Task task) {
+	waitForSpace(1);
+	size_t index = t_pool == this ? t_index : _nextQueue.fetch_add(1) % _queues.size();
+	push(index, &task, 1);
+}
+
+bool ThreadPool::trySubmit(Task& task) {
+	if (_capacity != 0 && t_pool != this) {
+		if (!reserve(1)) {
+			return false;
+		}
+	} else {
+		_reserved.fetch_add(1);
+	}
+	size_t index = t_pool == this ? t_index : _nextQueue.fetch_add(1) % _queues.size();
+	push(index, &task, 1);
+	return true;
+}
+
+void ThreadPool::submitBatch(std::vector<Task> tasks) {
+	if (tasks.empty()) {
+		return;
+	}
+	// Le lot va dans une seule file, les autres threads le répartissent entre eux par vol
+	waitForSpace(tasks.size());
+	size_t index = t_pool == this ? t_index : _nextQueue.fetch_add(1) % _queues.size();
+	push(index, tasks.data(), tasks.size());
+}
+
+bool ThreadPool::runOne(size_t self) {
+	Task task;
+	{
+		Queue& own = *_queues[self];
+		std::lock_guard<std::mutex> lock(own.mutex);
+		if (!own.tasks.empty()) {
+			task = std::move(own.tasks.back());
+			own.tasks.pop_back();
+		}
+	}
+	for (size_t k = 1; !task && k < _queues.size(); ++k) {
+		Queue& victim = *_queues[(self + k) % _queues.size()];
+		std::lock_guard<std::mutex> lock(victim.mutex);
+		if (!victim.tasks.empty()) {
+			task = std::move(victim.tasks.front());
+			victim.tasks.pop_front();
+		}
+	}
+	if (!task) {
+		return false;
+	}
+	_queued.fetch_sub(1);
+	_reserved.fetch_sub(1);
+	if (_waitingForSpace.load() > 0) {
+		std::lock_guard<std::mutex> lock(_sleepMutex);
+		_spaceCv.notify_all();
+	}
+
+	try {
+		task();
+	} catch (const std::exception& e) {
+		LOG(Error) << "Uncaught exception in thread pool task: " << e.what();
+	} catch (...) {
+		LOG(Error) << "Uncaught unknown exception in thread pool task";
+	}
+
+	if (_pending.fetch_sub(1) == 1) {
+		std::lock_guard<std::mutex> lock(_sleepMutex);
+		_sleepCv.notify_all();
+	}
+	return true;
+}
+
+void ThreadPool::workerLoop(size_t index) {
+	t_pool = this;
+	t_index = index;
+	while (true) {
+		if (runOne(index)) {
+			continue;
+		}
+		std::unique_lock<std::mutex> lock(_sleepMutex);
+		_sleepCv.wait(lock, [this]() { return _stop || _queued.load() > 0; });
+		if (_stop && _queued.load() == 0) {
+			return;
+		}
+	}
+}
+
+void ThreadPool::wait() {
+	size_t self = currentQueue();
+	while (true) {
+		if (runOne(self)) {
+			continue;
+		}
+		std::unique_lock<std::mutex> lock(_sleepMutex);
+		_sleepCv.wait(lock, [this]() { return _pending.load() == 0 || _queued.load() > 0; });
+		if (_pending.load() == 0) {
+			return;
+		}
+	}
+}
@@ -0,0 +1,105 @@
+/**
+ * @file ThreadPool.hpp
+ * @author ClemtoClem
+ * @date 17/10/2026
+ */
+
+#ifndef THREADPOOL_HPP
+#define THREADPOOL_HPP
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "../../common/src/CommandExecutor.hpp"
+
+/**
+ * @brief Groupe de threads avec vol de tâches
+ * Chaque thread possède sa propre file : il dépile ses tâches par la fin (LIFO, les tâches
+ * qu'il vient de créer sont encore chaudes en cache) et, quand elle est vide, vole les
+ * tâches les plus anciennes des autres files. Le thread qui appelle wait() participe
+ * à l'exécution, un groupe de 1 thread exécute donc tout dans le thread appelant.
+ *
+ * Avec une capacité, les threads extérieurs au groupe qui soumettent des tâches attendent
+ * qu'une place se libère : un producteur trop rapide est freiné au lieu de remplir la mémoire.
+ * Les tâches soumises depuis un thread du groupe ne sont jamais bloquées (elles ne pourraient
+ * pas être exécutées pendant que ce thread attend).
+ */
+class ThreadPool : public CommandExecutor {
+public:
+	using Task = CommandExecutor::Task;
+
+	/**
+	 * @brief Constructeur de ThreadPool
+	 * @param[in] nbThreads Nombre total de threads, thread appelant compris, 0 pour le nombre de coeurs
+	 * @param[in] capacity Nombre maximal de tâches en attente, 0 pour ne pas limiter les files
+	 */
+	explicit ThreadPool(size_t nbThreads = 0, size_t capacity = 0);
+
+	~ThreadPool() override;
+
+	ThreadPool(const ThreadPool&) = delete;
+	ThreadPool& operator=(const ThreadPool&) = delete;
+
+	/**
+	 * @brief Ajouter une tâche
+	 * Depuis un thread du groupe, la tâche est placée dans sa propre file, sinon elles sont réparties à tour de rôle.
+	 * @param[in] task Tâche à exécuter
+	 */
+	void submit(Task task) override;
+
+	/**
+	 * @brief Ajouter une tâche sans attendre
+	 * @param[in] task Tâche à exécuter
+	 * @return true si la tâche a été ajoutée, false si les files sont pleines
+	 */
+	bool trySubmit(Task& task);
+
+	/**
+	 * @brief Ajouter plusieurs tâches en une seule fois : une place réservée, un verrou et un réveil pour tout le lot
+	 * @param[in] tasks Tâches à exécuter
+	 */
+	void submitBatch(std::vector<Task> tasks) override;
+
+	/**
+	 * @brief Attendre la fin de toutes les tâches soumises, en aidant à les exécuter
+	 */
+	void wait();
+
+	/**
+	 * @brief Nombre total de threads, thread appelant compris
+	 */
+	size_t size() const noexcept { return _queues.size(); }
+
+private:
+	struct Queue {
+		std::mutex mutex;
+		std::deque<Task> tasks;
+	};
+
+	std::vector<std::unique_ptr<Queue>> _queues;	///< Une file par thread, la dernière est celle du thread appelant
+	std::vector<std::thread> _threads;
+	std::atomic<size_t> _queued;	///< Tâches présentes dans les files
+	std::atomic<size_t> _reserved;	///< Places prises dans les files, réservées avant l'ajout des tâches (comparé à la capacité)
+	std::atomic<size_t> _pending;	///< Tâches soumises et pas encore terminées
+	std::atomic<size_t> _nextQueue;
+	std::mutex _sleepMutex;
+	std::condition_variable _sleepCv;
+	bool _stop;
+	size_t _capacity;
+	std::atomic<size_t> _waitingForSpace;	///< Producteurs bloqués par la capacité
+	std::condition_variable _spaceCv;
+
+	bool runOne(size_t self);
+	bool reserve(size_t count) noexcept;
+	void waitForSpace(size_t count);
+	void push(size_t index, Task* tasks, size_t count);
+	void workerLoop(size_t index);
+	size_t currentQueue() const noexcept;
+};
+
+#endif // THREADPOOL_HPP
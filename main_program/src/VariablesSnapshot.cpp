@@ -0,0 +1,324 @@
+#include <array>
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "VariablesSnapshot.hpp"
+
+namespace {
+	constexpr uint8_t STRING_TYPE = static_cast<uint8_t>(variantIndex<std::string>);
+	constexpr uint8_t POINTER_TYPE = static_cast<uint8_t>(variantIndex<void*>);
+
+	template<typename T>
+	void append(std::string& data, const T& value) {
+		data.append(reinterpret_cast<const char*>(&value), sizeof(T));
+	}
+
+	void appendString(std::string& data, std::string_view str) {
+		append(data, static_cast<uint32_t>(str.size()));
+		data.append(str);
+	}
+
+	/**
+	 * @brief Lecture bornée d'une zone de la projection
+	 */
+	struct Cursor {
+		const char* position;
+		const char* end;
+
+		template<typename T>
+		bool read(T& value) {
+			if (static_cast<size_t>(end - position) < sizeof(T)) {
+				return false;
+			}
+			std::memcpy(&value, position, sizeof(T));
+			position += sizeof(T);
+			return true;
+		}
+
+		bool readString(std::string_view& str) {
+			uint32_t length = 0;
+			if (!read(length) || static_cast<size_t>(end - position) < length) {
+				return false;
+			}
+			str = std::string_view(position, length);
+			position += length;
+			return true;
+		}
+
+		/**
+		 * @brief Lire une variable
+		 * @param[out] name Nom de la variable
+		 * @param[out] type Position du type dans VariantType
+		 * @param[out] bits Valeur d'un type numérique ou booléen
+		 * @param[out] text Valeur d'une chaîne
+		 */
+		bool readVariable(std::string_view& name, uint8_t& type, uint64_t& bits, std::string_view& text) {
+			if (!readString(name) || !read(type) || type >= std::variant_size_v<VariantType> || type == POINTER_TYPE) {
+				return false;
+			}
+			return type == STRING_TYPE ? readString(text) : read(bits);
+		}
+	};
+
+	/**
+	 * @brief Reconstruire une valeur de type numérique ou booléen à partir de ses 8 octets
+	 */
+	VariantType unpackValue(uint8_t type, uint64_t bits) {
+		static constexpr auto unpackers = []<typename... Ts>(std::variant<Ts...>*) {
+			return std::array<VariantType (*)(uint64_t), sizeof...(Ts)>{
+				[](uint64_t value) -> VariantType {
+					if constexpr (std::is_arithmetic_v<Ts>) {
+						Ts result;
+						std::memcpy(&result, &value, sizeof(Ts));
+						return result;
+					} else {
+						return Ts{};	// Chaînes et pointeurs ne sont pas enregistrés ainsi
+					}
+				}...
+			};
+		}(static_cast<VariantType*>(nullptr));
+		return unpackers[type](bits);
+	}
+}
+
+VariablesSnapshotWriter::VariablesSnapshotWriter() : _nbPlugins(0) {
+	append(_data, VariablesSnapshot::MAGIC);
+	append(_data, VariablesSnapshot::VERSION);
+	append(_data, uint32_t(0));	// Nombre de plugins, écrit par save()
+}
+
+void VariablesSnapshotWriter::addPlugin(std::string_view plugin, const VariablesListener& variables) {
+	const size_t header = beginSection(plugin);
+	uint32_t count = 0;
+	variables.forEachVariable([&](const std::string& name, const VariantType& value) {
+		if (variables.isDerivedVariable(name)) {
+			return;	// Recalculée à partir de ses entrées
+		}
+		count += appendVariable(name, value);
+	});
+	endSection(header, count);
+}
+
+void VariablesSnapshotWriter::addPlugin(std::string_view plugin, const std::vector<std::pair<std::string, VariantType>>& values) {
+	const size_t header = beginSection(plugin);
+	uint32_t count = 0;
+	for (const auto& [name, value] : values) {
+		count += appendVariable(name, value);
+	}
+	endSection(header, count);
+}
+
+size_t VariablesSnapshotWriter::beginSection(std::string_view plugin) {
+	appendString(_data, plugin);
+	const size_t header = _data.size();
+	append(_data, uint32_t(0));	// Nombre de variables et taille de la section, complétés par endSection
+	append(_data, uint32_t(0));
+	return header;
+}
+
+void VariablesSnapshotWriter::endSection(size_t header, uint32_t count) {
+	const uint32_t size = static_cast<uint32_t>(_data.size() - header - 2 * sizeof(uint32_t));
+	std::memcpy(_data.data() + header, &count, sizeof(count));
+	std::memcpy(_data.data() + header + sizeof(count), &size, sizeof(size));
+	_nbPlugins++;
+}
+
+bool VariablesSnapshotWriter::appendVariable(std::string_view name, const VariantType& value) {
+	if (std::holds_alternative<void*>(value)) {
+		return false;	// Une adresse n'a pas de sens d'une exécution à l'autre
+	}
+	appendString(_data, name);
+	append(_data, static_cast<uint8_t>(value.index()));
+	std::visit([&](const auto& v) {
+		using T = std::decay_t<decltype(v)>;
+		if constexpr (std::is_same_v<T, std::string>) {
+			appendString(_data, v);
+		} else if constexpr (std::is_arithmetic_v<T>) {
+			uint64_t bits = 0;
+			std::memcpy(&bits, &v, sizeof(T));
+			append(_data, bits);
+		}
+	}, value);
+	return true;
+}
+
+void VariablesSnapshotWriter::addSection(std::string_view plugin, uint32_t count, std::string_view section) {
+	appendString(_data, plugin);
+	append(_data, count);
+	append(_data, static_cast<uint32_t>(section.size()));
+	_data.append(section);
+	_nbPlugins++;
+}
+
+bool VariablesSnapshotWriter::save(const fs::path& file) {
+	std::memcpy(_data.data() + 2 * sizeof(uint32_t), &_nbPlugins, sizeof(_nbPlugins));
+
+	// Écriture dans un fichier temporaire synchronisé sur le disque, puis renommage et synchronisation du répertoire :
+	// après un arrêt brutal, le fichier est l'ancien instantané ou le nouveau, jamais un instantané tronqué
+	fs::path tmp = file;
+	tmp += ".tmp";
+	int fd = ::open(tmp.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+	if (fd < 0) {
+		return false;
+	}
+	const char* data = _data.data();
+	size_t left = _data.size();
+	while (left > 0) {
+		ssize_t written = ::write(fd, data, left);
+		if (written < 0 && errno == EINTR) {
+			continue;
+		}
+		if (written < 0) {
+			break;
+		}
+		data += written;
+		left -= static_cast<size_t>(written);
+	}
+	bool ok = left == 0 && fsync(fd) == 0;
+	ok = close(fd) == 0 && ok;
+	std::error_code ec;
+	if (!ok) {
+		fs::remove(tmp, ec);
+		return false;
+	}
+	fs::rename(tmp, file, ec);
+	if (ec) {
+		fs::remove(tmp, ec);
+		return false;
+	}
+	fs::path directory = file.parent_path().empty() ? fs::path(".") : file.parent_path();
+	int dir = ::open(directory.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+	if (dir < 0) {
+		return false;
+	}
+	ok = fsync(dir) == 0;
+	close(dir);
+	return ok;
+}
+
+VariablesSnapshot::~VariablesSnapshot() {
+	if (_map) {
+		munmap(_map, _size);
+	}
+}
+
+bool VariablesSnapshot::open(const fs::path& file, std::string& error) {
+	int fd = ::open(file.c_str(), O_RDONLY | O_CLOEXEC);
+	if (fd < 0) {
+		error = std::string("cannot open file: ") + strerror(errno);
+		return false;
+	}
+	struct stat st;
+	if (fstat(fd, &st) != 0 || st.st_size < static_cast<off_t>(3 * sizeof(uint32_t))) {
+		close(fd);
+		error = "not a variables snapshot";
+		return false;
+	}
+	_size = static_cast<size_t>(st.st_size);
+	_map = mmap(nullptr, _size, PROT_READ, MAP_PRIVATE, fd, 0);
+	close(fd);
+	if (_map == MAP_FAILED) {
+		_map = nullptr;
+		error = std::string("cannot map file: ") + strerror(errno);
+		return false;
+	}
+	madvise(_map, _size, MADV_SEQUENTIAL);
+
+	const char* data = static_cast<const char*>(_map);
+	Cursor cursor{ data, data + _size };
+	uint32_t magic = 0, version = 0, nbPlugins = 0;
+	cursor.read(magic);
+	cursor.read(version);
+	cursor.read(nbPlugins);
+	if (magic != MAGIC || version != VERSION) {
+		error = "unsupported snapshot format or version";
+		return false;
+	}
+
+	// Tout le fichier est vérifié ici : restore() n'a plus à traiter de fichier tronqué.
+	// Une section occupe au moins trois entiers (longueur du nom, nombre et taille des variables)
+	if (nbPlugins > static_cast<size_t>(cursor.end - cursor.position) / (3 * sizeof(uint32_t))) {
+		error = "truncated snapshot";
+		return false;
+	}
+	_sections.reserve(nbPlugins);
+	for (uint32_t p = 0; p < nbPlugins; ++p) {
+		std::string_view plugin;
+		uint32_t count = 0, size = 0;
+		if (!cursor.readString(plugin) || !cursor.read(count) || !cursor.read(size) || static_cast<size_t>(cursor.end - cursor.position) < size) {
+			error = "truncated snapshot";
+			return false;
+		}
+		Section section{ count, std::string_view(cursor.position, size) };
+		Cursor variables{ cursor.position, cursor.position + size };
+		for (uint32_t v = 0; v < count; ++v) {
+			std::string_view name, text;
+			uint8_t type = 0;
+			uint64_t bits = 0;
+			if (!variables.readVariable(name, type, bits, text)) {
+				error = "invalid variable in section of plugin '" + std::string(plugin) + "'";
+				return false;
+			}
+		}
+		cursor.position += size;
+		if (_sections.emplace(std::string(plugin), section).second) {
+			_order.emplace_back(plugin);
+		}
+	}
+	return true;
+}
+
+std::vector<std::string> VariablesSnapshot::getPlugins() const {
+	return _order;
+}
+
+size_t VariablesSnapshot::restore(std::string_view plugin, VariablesListener& variables, std::vector<std::string>& mismatches) const {
+	auto it = _sections.find(plugin);
+	if (it == _sections.end()) {
+		return 0;
+	}
+	const Section& section = it->second;
+	Cursor cursor{ section.data.data(), section.data.data() + section.data.size() };
+	size_t restored = 0;
+	VariantType value;
+	for (uint32_t v = 0; v < section.count; ++v) {
+		std::string_view name, text;
+		uint8_t type = 0;
+		uint64_t bits = 0;
+		cursor.readVariable(name, type, bits, text);
+
+		VariableHandle<> handle = variables.getVariableHandle(name);
+		if (!handle.ok()) {
+			mismatches.push_back(std::string(plugin) + "." + std::string(name) + ": not found (renamed or removed)");
+			continue;
+		}
+		if (handle.type() != type) {
+			mismatches.push_back(std::string(plugin) + "." + std::string(name) + ": saved as " + VariantIndexName(type) +
+				", now " + VariantIndexName(handle.type()));
+			continue;
+		}
+		if (type == STRING_TYPE) {
+			value.emplace<std::string>(text);
+		} else {
+			value = unpackValue(type, bits);
+		}
+		if (!handle.set(value)) {
+			mismatches.push_back(std::string(plugin) + "." + std::string(name) + ": cannot be set (derived variable)");
+			continue;
+		}
+		restored++;
+	}
+	return restored;
+}
+
+bool VariablesSnapshot::copySection(std::string_view plugin, VariablesSnapshotWriter& writer) const {
+	auto it = _sections.find(plugin);
+	if (it == _sections.end()) {
+		return false;
+	}
+	writer.addSection(plugin, it->second.count, it->second.data);
+	return true;
+}
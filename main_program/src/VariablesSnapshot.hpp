@@ -0,0 +1,148 @@
+/**
+ * @file VariablesSnapshot.hpp
+ * @author ClemtoClem
+ * @date 17/10/2026
+ */
+
+#ifndef VARIABLES_SNAPSHOT_HPP
+#define VARIABLES_SNAPSHOT_HPP
+
+#include <chrono>
+#include <filesystem>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "../../common/src/StringHash.hpp"
+#include "../../common/src/VariablesListener.hpp"
+
+namespace fs = std::filesystem;
+
+/**
+ * @brief Résultat d'une restauration de variables
+ */
+struct SnapshotReport {
+	size_t plugins = 0;						///< Plugins dont les variables ont été restaurées
+	size_t restored = 0;					///< Variables restaurées
+	size_t pending = 0;						///< Plugins pas encore activés, restaurés à leur activation
+	std::vector<std::string> mismatches;	///< Variables du fichier qui n'ont pas pu être restaurées, avec la raison
+	std::chrono::nanoseconds duration{0};	///< Durée de la lecture et de l'application
+};
+
+/**
+ * @brief Écriture d'un instantané des variables de plusieurs plugins
+ *
+ * Format binaire, dans l'ordre natif des octets comme le cache des manifestes :
+ * en-tête (magic, version, nombre de plugins), puis pour chaque plugin son nom, son nombre de variables et la taille
+ * de sa section, et pour chaque variable son nom, la position de son type dans VariantType et sa valeur
+ * (8 octets pour les nombres, les booléens ; longueur et octets pour les chaînes). Les pointeurs ne sont pas enregistrés.
+ */
+class VariablesSnapshotWriter {
+public:
+	VariablesSnapshotWriter();
+
+	/**
+	 * @brief Ajouter les variables d'un plugin
+	 * @param[in] plugin Nom du plugin
+	 * @param[in] variables Variables du plugin
+	 */
+	void addPlugin(std::string_view plugin, const VariablesListener& variables);
+
+	/**
+	 * @brief Ajouter des valeurs conservées sans instance, par exemple celles d'un plugin déchargé pour inactivité
+	 * @param[in] plugin Nom du plugin
+	 * @param[in] values Nom et valeur de chaque variable, sans variable dérivée
+	 */
+	void addPlugin(std::string_view plugin, const std::vector<std::pair<std::string, VariantType>>& values);
+
+	/**
+	 * @brief Ajouter telle quelle une section lue dans un autre instantané
+	 * @param[in] plugin Nom du plugin
+	 * @param[in] count Nombre de variables de la section
+	 * @param[in] section Octets de la section
+	 */
+	void addSection(std::string_view plugin, uint32_t count, std::string_view section);
+
+	/**
+	 * @brief Écrire l'instantané, dans un fichier temporaire synchronisé sur le disque puis renommé
+	 * @param[in] file Fichier de l'instantané
+	 * @return true si le fichier a été écrit, false sinon
+	 */
+	bool save(const fs::path& file);
+
+	size_t size() const noexcept { return _data.size(); }
+
+private:
+	std::string _data;
+	uint32_t _nbPlugins;
+
+	size_t beginSection(std::string_view plugin);
+	void endSection(size_t header, uint32_t count);
+	bool appendVariable(std::string_view name, const VariantType& value);
+};
+
+/**
+ * @brief Instantané de variables projeté en mémoire, validé à l'ouverture
+ */
+class VariablesSnapshot {
+public:
+	static constexpr uint32_t MAGIC = 0x53564D50;	// "PMVS"
+	static constexpr uint32_t VERSION = 1;
+
+	VariablesSnapshot() = default;
+	~VariablesSnapshot();
+
+	VariablesSnapshot(const VariablesSnapshot&) = delete;
+	VariablesSnapshot& operator=(const VariablesSnapshot&) = delete;
+
+	/**
+	 * @brief Projeter un fichier en mémoire et vérifier son format
+	 * @param[in] file Fichier de l'instantané
+	 * @param[out] error Raison de l'échec
+	 * @return true si l'instantané est utilisable, false si le fichier est absent, tronqué ou d'une autre version
+	 */
+	bool open(const fs::path& file, std::string& error);
+
+	/**
+	 * @brief Savoir si l'instantané contient les variables d'un plugin
+	 * @param[in] plugin Nom du plugin
+	 * @return true si le plugin a une section
+	 */
+	bool contains(std::string_view plugin) const { return _sections.find(plugin) != _sections.end(); }
+
+	/**
+	 * @brief Noms des plugins de l'instantané
+	 * @return Noms, dans l'ordre du fichier
+	 */
+	std::vector<std::string> getPlugins() const;
+
+	/**
+	 * @brief Appliquer les valeurs enregistrées pour un plugin à ses variables
+	 * Une variable absente (renommée ou supprimée) ou dont le type a changé garde sa valeur actuelle et est signalée.
+	 * @param[in] plugin Nom du plugin
+	 * @param[in,out] variables Variables du plugin
+	 * @param[out] mismatches Variables non restaurées, "Plugin.variable: raison"
+	 * @return Nombre de variables restaurées
+	 */
+	size_t restore(std::string_view plugin, VariablesListener& variables, std::vector<std::string>& mismatches) const;
+
+	/**
+	 * @brief Recopier la section d'un plugin dans un nouvel instantané, pour un plugin qui n'a pas été activé
+	 * @param[in] plugin Nom du plugin
+	 * @param[in,out] writer Nouvel instantané
+	 * @return true si le plugin a une section
+	 */
+	bool copySection(std::string_view plugin, VariablesSnapshotWriter& writer) const;
+
+private:
+	struct Section {
+		uint32_t count;				///< Nombre de variables
+		std::string_view data;		///< Octets des variables, dans la projection
+	};
+
+	void* _map = nullptr;
+	size_t _size = 0;
+	StringMap<Section> _sections;
+	std::vector<std::string> _order;
+};
+
+#endif // VARIABLES_SNAPSHOT_HPP
@@ -14,18 +14,57 @@
 #include <iostream>
 #include "../../../common/src/Logger.hpp"
 #include "../../../common/src/PluginInterface.hpp"
+#include "../../../common/src/PluginManifest.hpp"
 
-const PluginInfo informations = {
+extern "C" constinit const PluginManifest plugin_manifest = {
 	.name			= "Plugin1",
 	.author			= "ClemtoClem",
 	.description	= "This is a plugin for testing purpose",
 	.version		= {1, 0, 0},
 	.mainVersion	= {1, 0, 0},
 	.priority		= 0,
-	.type			= PluginType::System
+	.type			= PluginType::System,
+	.dependencies	= {}
 };
 
+const PluginInfo informations = toPluginInfo(plugin_manifest);
+
 class Plugin1 : public PluginInterface {
+private:
+	std::string _message = "Hello World";	///< Valeur initiale de la variable "message", puis copie tenue à jour
+	LogLevel _level = Info;
+
+	static LogLevel toLogLevel(const std::string& level) {
+		if (level == "Debug") {
+			return Debug;
+		} else if (level == "Success") {
+			return Success;
+		} else if (level == "Warning") {
+			return Warning;
+		} else if (level == "Error") {
+			return Error;
+		} else if (level == "Fatal") {
+			return Fatal;
+		}
+		return Info;
+	}
+
+protected:
+	// Une transaction qui donne un niveau inconnu est refusée en entier
+	bool validateVariables(const std::vector<VariableChange>& changes, std::string& reason) override {
+		for (const VariableChange& change : changes) {
+			if (change.name != "level") {
+				continue;
+			}
+			const std::string& level = std::get<std::string>(change.newValue);
+			if (level != "Info" && toLogLevel(level) == Info) {
+				reason = "unknown log level '" + level + "'";
+				return false;
+			}
+		}
+		return true;
+	}
+
 public:
 	Plugin1() : PluginInterface(informations) {}
 
@@ -37,29 +76,30 @@ public:
 		LOG(Info) << "Initializing '" << _info.name << "'";
 
 		// Création des variables
-		addVariable("message", "Message à afficher", "Hello World");
+		addVariable("message", "Message à afficher", _message);
 		addVariable("level", "Niveau de log", "Info");
 
+		// Le message et le niveau sont gardés en mémoire et mis à jour seulement quand les variables changent
+		observeVariable("message", [this](const VariableChange& change) {
+			_message = std::get<std::string>(change.newValue);
+		});
+		observeVariable("level", [this](const VariableChange& change) {
+			_level = toLogLevel(std::get<std::string>(change.newValue));
+		});
+
+		// Message formaté, recalculé seulement quand il est lu après une modification du message ou du niveau
+		addDerivedVariable("formatted", "Message précédé de son niveau", { "level", "message" }, [](const std::vector<VariantType>& inputs) {
+			return VariantType("[" + std::get<std::string>(inputs[0]) + "] " + std::get<std::string>(inputs[1]));
+		});
+
 		// Création des commandes
-		addCommand("say", "Affiche un message", 0, 0, [&](const std::vector<VariantType>& args) {
-			std::string message = std::get<std::string>(getVariable("message"));
-			std::string level = std::get<std::string>(getVariable("level"));
-			if (level == "Debug") {
-				LOG(Debug) << message;
-			} else if (level == "Info") {
-				LOG(Info) << message;
-			} else if (level == "Success") {
-				LOG(Success) << message;
-			} else if (level == "Warning") {
-				LOG(Warning) << message;
-			} else if (level == "Error") {
-				LOG(Error) << message;
-			} else if (level == "Fatal") {
-				LOG(Fatal) << message;
-			} else {
-				LOG(Info) << message;
-			}
-			return std::vector<VariantType>();
+		addCommand<void()>("say", "Affiche un message", [this]() {
+			LOG(_level) << _message;
+		});
+
+		// Les autres plugins peuvent aussi faire afficher un message par un événement
+		subscribe<std::string>(EventBus::getInstance().topic<std::string>("Plugin1.say"), [](const std::string& message) {
+			LOG(Info) << message;
 		});
 
 		return 0;
@@ -14,17 +14,21 @@
 #include <iostream>
 #include "../../../common/src/Logger.hpp"
 #include "../../../common/src/PluginInterface.hpp"
+#include "../../../common/src/PluginManifest.hpp"
 
-const PluginInfo informations = {
+extern "C" constinit const PluginManifest plugin_manifest = {
 	.name			= "Plugin2",
 	.author			= "ClemtoClem",
 	.description	= "This is a plugin for testing purpose",
 	.version		= {1, 0, 0},
 	.mainVersion	= {1, 0, 0},
 	.priority		= 0,
-	.type			= PluginType::Module
+	.type			= PluginType::Module,
+	.dependencies	= {"Plugin1"}
 };
 
+const PluginInfo informations = toPluginInfo(plugin_manifest);
+
 class Plugin2 : public PluginInterface {
 public:
 	Plugin2() : PluginInterface(informations) {}
@@ -36,6 +40,20 @@ public:
 	int init(int argc, char* argv[]) override {
 		LOG(Info) << "Initializing '" << _info.name << "'";
 
+		// Commandes de calcul, utilisables dans un pipeline (PluginsManager::compilePipeline), publiées ensemble
+		beginCommands();
+		addCommand<double(double, double)>("add", "Additionne deux nombres", [](double a, double b) {
+			return a + b;
+		}, {}, ArgumentCoercion::Numeric);
+		addCommand<double(double, double)>("mul", "Multiplie deux nombres", [](double a, double b) {
+			return a * b;
+		}, {}, ArgumentCoercion::Numeric);
+		endCommands();
+
+		// Plugin1 est initialisé avant nous (dépendance) : il est déjà abonné
+		EventBus& events = EventBus::getInstance();
+		events.publish(events.topic<std::string>("Plugin1.say"), std::string("'" + _info.name + "' is ready"));
+
 		return 0;
 	}
 